@@ -0,0 +1,51 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../src/pr5Model.h"
+#include "allocCounter.h"
+
+//heap allocations of the pr5 model in steady state: a probe transact of an extra GENERATE resets the counter
+//after warmupHours of the run and reads it measuredHours later, both from its ADVANCE operands, so only the event loop
+//of one run is counted, without the start and the completion of the run; the transact pool, the chains and the FEC
+//have their working size by then, so with the binary heap FEC every event must go without an allocation.
+//The workers are 4, 4, 4, so the queues are stable and the population does not grow
+//usage: allocCheck [warmupHours] [measuredHours]; the exit code is 1 when the binary heap FEC allocates
+
+int main(int argc, char* argv[]) {
+    unsigned int warmupHours = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    unsigned int measuredHours = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+    const std::pair<FECType, std::string> engines[] = {{FECType::BINARY_HEAP, "binary heap"}, {FECType::LIST, "list"}, \
+        {FECType::CALENDAR_QUEUE, "calendar queue"}, {FECType::LADDER_QUEUE, "ladder queue"}};
+    bool passed = true;
+
+    std::cout << "ENGINE\t\tEVENTS\t\tALLOCATIONS\tPER EVENT" << std::endl;
+    for (const std::pair<FECType, std::string>& engine : engines) {
+        SimCPP sim("three grhoups of workers", engine.first);
+        unsigned long eventsNumb = 0, allocations = 0;
+        BlockProgram program = pr5Program(sim, 4, 4, 4, 0);
+        program.generate(0, warmupHours * 3600. + 1, 1);
+        program.advance([&eventsNumb, measuredHours](SimCPP& sim) {
+            eventsNumb = sim.getEventsNumb();
+            allocationsNumb = 0;
+            return measuredHours * 3600.;
+        });
+        program.advance([&eventsNumb, &allocations](SimCPP& sim) {
+            allocations = allocationsNumb;
+            eventsNumb = sim.getEventsNumb() - eventsNumb;
+            return 0;
+        });
+        program.terminate();
+        sim.load(program);
+        sim.start(warmupHours + measuredHours + 1);
+        sim.run();
+
+        std::cout << engine.second << "\t" << eventsNumb << "\t\t" << allocations << "\t\t" << (double)allocations / eventsNumb << std::endl;
+        if (engine.first == FECType::BINARY_HEAP && allocations != 0) {
+            passed = false;
+        }
+    }
+    if (!passed) {
+        std::cerr << "the binary heap FEC allocates in steady state" << std::endl;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//heap allocations of the program counted by the replaced global operator new; the replacement is a definition,
+//so the header is included by the one translation unit of a bench
+static std::atomic<unsigned long> allocationsNumb(0);
+static std::atomic<unsigned long> allocatedBytes(0);
+
+void* operator new(std::size_t size) {
+    allocationsNumb.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+//every form of delete frees here, the call is not inlined: gcc would take the free of an inlined delete
+//for a mismatch with the new of the standard library
+__attribute__((noinline)) static void release(void* memory) { std::free(memory); }
+
+void operator delete(void* memory) noexcept { release(memory); }
+void operator delete(void* memory, std::size_t) noexcept { release(memory); }
+void operator delete[](void* memory) noexcept { release(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { release(memory); }
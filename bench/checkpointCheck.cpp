@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include "../src/SimCPP.h"
+
+//save and restore in the middle of a run against the uninterrupted run, on every FEC engine with and without
+//the buffered variates: the model saved after half of the run is restored into a fresh model of the same code,
+//which runs the other half. The state at the save has transacts in the FEC, in the delay chain of an overloaded
+//storage (demands of 1 and 3 channels), in a parameter ordered user chain, a QTABLE and a TABLE with quantile
+//sketches, the series of the warm-up detection and the batch means. The statistics, the block counts and the model time
+//of both runs must be the same
+//usage: checkpointCheck [timer transacts per half]; the exit code is 1 at the first difference
+
+struct RunResult {
+    long double modelTime;
+    unsigned long eventsNumb;
+    std::string stats; //reports of the entities, the block counts and the batch means
+};
+
+//defines the model on a fresh SimCPP
+void defineModel(SimCPP& sim, bool buffering) {
+    BlockProgram program;
+    program.storage("channels", 4);
+    program.qtable("WAIT", "waiting", 0, 2, 20);
+    program.table("SERVICE", Expression::parse("P$service"), 0, 1, 10);
+    sim.setVariateBuffering(buffering);
+
+    //small and large demands, the small ones pass the waiting large ones
+    program.generate([](SimCPP& sim){ return sim.exponential(1, 0, 1.2); });
+    program.assign("service", [](SimCPP& sim){ return sim.exponential(2, 0, 1.5); });
+    program.queue("waiting");
+    program.enter("channels", 1);
+    program.depart("waiting");
+    program.tabulate("SERVICE");
+    program.advance(Expression::parse("P$service"));
+    program.leave("channels", 1);
+    program.terminate();
+
+    program.generate([](SimCPP& sim){ return sim.exponential(3, 0, 3); });
+    program.queue("waiting");
+    program.enter("channels", 3);
+    program.depart("waiting");
+    program.advance([](SimCPP& sim){ return sim.exponential(4, 0, 2); });
+    program.leave("channels", 3);
+    program.terminate();
+
+    //jobs wait in the order of their priority for the pickers, some are dropped from the back
+    program.generate([](SimCPP& sim){ return sim.exponential(5, 0, 2); });
+    program.assign("priority", [](SimCPP& sim){ return std::floor(sim.uniform(6, 0, 5)); });
+    program.link("pool", "priority");
+    program.label("TAKEN");
+    program.terminate();
+
+    program.generate([](SimCPP& sim){ return sim.exponential(7, 0, 2.1); });
+    program.test([](SimCPP& sim){ return sim.uniform(8, 0, 1) < 0.9; }, "DROP");
+    program.unlink("pool", "TAKEN", 1);
+    program.terminate();
+    program.label("DROP");
+    program.unlinkBack("pool", "TAKEN", 2);
+    program.terminate();
+
+    program.generate(1000);
+    program.terminate(1);
+
+    sim.load(program);
+    sim.detectWarmup(sim.getQueueId("waiting"), 100, 60);
+    sim.batchMeans(sim.getQueueId("waiting"), 200);
+    sim.batchMeans(sim.getStorageId("channels"), 200);
+    sim.batchMeans(sim.getLinkId("pool"), 200);
+}
+
+RunResult getResult(SimCPP& sim) {
+    std::string stats = Queues::getFinalStatString(sim.getQueueStats()) + '\n' + Storages::getFinalStatString(sim.getStorageStats()) + '\n' \
+        + Links::getFinalStatString(sim.getLinkStats()) + '\n' + Tables::getFinalStatString(sim.getTableStats()) + '\n' \
+        + sim.getMetricsString() + "\nreset at " + std::to_string((double)sim.getResetTime()) + "\nENTRY/CURRENT";
+    //the profile report has the wall time of the runs, the block counts are taken alone
+    for (unsigned int state = 1; sim.getBlockEntries(state) != 0 || sim.getBlockCurrent(state) != 0; state++) {
+        stats += ' ' + std::to_string(sim.getBlockEntries(state)) + '/' + std::to_string(sim.getBlockCurrent(state));
+    }
+    return RunResult {sim.getModelTime(), sim.getEventsNumb(), stats};
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int halfNumb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+    const std::pair<FECType, std::string> engines[] = {{FECType::BINARY_HEAP, "binary heap"}, {FECType::LIST, "list"}, \
+        {FECType::CALENDAR_QUEUE, "calendar queue"}, {FECType::LADDER_QUEUE, "ladder queue"}};
+
+    for (const std::pair<FECType, std::string>& engine : engines) {
+        for (bool buffering : {false, true}) {
+            std::string name = engine.second + (buffering ? ", buffered variates" : "");
+            SimCPP whole("checkpoint check", engine.first);
+            defineModel(whole, buffering);
+            whole.start(2 * halfNumb);
+            whole.run();
+            RunResult expected = getResult(whole);
+
+            SimCPP first("checkpoint check", engine.first);
+            defineModel(first, buffering);
+            first.start(halfNumb);
+            first.run();
+            std::stringstream checkpoint;
+            first.save(checkpoint);
+            const StorageStat& storageStat = first.getStorageStats()[0];
+            unsigned long delayed = storageStat.delay, linked = first.getLinkStats()[0].cont;
+            bool warmingUp = first.getResetTime() == 0;
+
+            SimCPP second("checkpoint check", engine.first);
+            defineModel(second, buffering);
+            second.restore(checkpoint);
+            second.start(halfNumb);
+            second.run();
+            RunResult result = getResult(second);
+
+            if (result.modelTime != expected.modelTime || result.eventsNumb != expected.eventsNumb || result.stats != expected.stats) {
+                std::cout << name << ": the restored run ends at " << (double)result.modelTime << " after " << result.eventsNumb \
+                    << " events, the uninterrupted one at " << (double)expected.modelTime << " after " << expected.eventsNumb << " events" \
+                    << "\nrestored:\n" << result.stats << "\nuninterrupted:\n" << expected.stats << std::endl;
+                return 1;
+            }
+            std::cout << name << ": the same at model time " << (double)result.modelTime << ", saved with " << delayed << " transacts delayed, " \
+                << linked << " linked" << (warmingUp ? ", in the warm-up" : "") << std::endl;
+        }
+    }
+    return 0;
+}
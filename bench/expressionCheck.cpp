@@ -0,0 +1,117 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../src/SimCPP.h"
+
+//expression parser and compiler: precedence and associativity of the operators, constant folding, inlining of V$
+//variables of the parse call, SimCPP variables referred to by handle, and numbers that must be refused
+//usage: expressionCheck; the exit code is 1 when an expression is wrong
+
+struct CodeCase {
+    std::string text;
+    std::vector<ExprOp> code; //after folding
+};
+
+bool failed = false;
+
+void report(const std::string& text, const std::string& message) {
+    std::cout << '\"' << text << "\": " << message << std::endl;
+    failed = true;
+}
+
+//constant text, folded into one CONST
+void checkValue(const std::string& text, long double expected, const std::unordered_map<std::string, long double>& constants = {}) {
+    Expression expression = Expression::parse(text, constants);
+    if (!expression.isConstant()) {
+        report(text, "is not folded into a constant");
+    }
+    else if (expression.getConstant() != expected) {
+        report(text, "gives " + std::to_string((double)expression.getConstant()) + " instead of " + std::to_string((double)expected));
+    }
+}
+
+void checkCode(const CodeCase& codeCase, const std::unordered_map<std::string, Expression>& variables) {
+    Expression expression = Expression::parse(codeCase.text, {}, variables);
+    const std::vector<Expression::Instruction>& code = expression.getCode();
+    bool same = code.size() == codeCase.code.size();
+    for (unsigned int i = 0; same && i < code.size(); i++) {
+        same = code[i].op == codeCase.code[i];
+    }
+    if (!same) {
+        report(codeCase.text, "is compiled into " + std::to_string(code.size()) + " other instructions");
+    }
+}
+
+void checkRefused(const std::string& text) {
+    try {
+        Expression::parse(text);
+        report(text, "is accepted");
+    }
+    catch (const std::logic_error&) {
+    }
+}
+
+int main() {
+    //precedence from OR up to the power, associativity of each level
+    checkValue("2+3#4", 14);
+    checkValue("(2+3)#4", 20);
+    checkValue("2#3+4", 10);
+    checkValue("10-4-3", 3);
+    checkValue("8/2/2", 2);
+    checkValue("7\\2", 3);
+    checkValue("7@4", 3);
+    checkValue("2^3^2", 512); //right associative, (2^3)^2 is 64
+    checkValue("2#3^2", 18);
+    checkValue("-3+5", 2);
+    checkValue("2-(-3)", 5);
+    checkValue("2+3'G'4", 1);
+    checkValue("1+1'E'2", 1);
+    checkValue("5<=4+1", 1);
+    checkValue("3<>3", 0);
+    checkValue("1'E'1'AND'0'OR'1", 1);
+    checkValue("1'OR'0'AND'0", 1); //AND binds tighter
+    checkValue("0&1|1", 1);
+    checkValue("K#2+K", 12, {{"K", 4}});
+    checkValue("1.25#4", 5);
+    checkValue(".5+5.", 5.5);
+
+    //constant parts are folded inside other expressions, V$ of the parse call copies the code of the variable
+    std::unordered_map<std::string, Expression> variables {{"twice", Expression::parse("P$a#2")}};
+    const std::vector<CodeCase> codeCases {
+        {"P$a+2#3", {ExprOp::PARAM, ExprOp::CONST, ExprOp::ADD}},
+        {"(1+2)#Q$w-4/2", {ExprOp::CONST, ExprOp::QUEUE_Q, ExprOp::MUL, ExprOp::CONST, ExprOp::SUB}},
+        {"R$s^2^0.5", {ExprOp::STORAGE_R, ExprOp::CONST, ExprOp::POW}},
+        {"V$twice+1", {ExprOp::PARAM, ExprOp::CONST, ExprOp::MUL, ExprOp::CONST, ExprOp::ADD}},
+        {"V$other+1", {ExprOp::VARIABLE, ExprOp::CONST, ExprOp::ADD}},
+        {"-Q$w", {ExprOp::QUEUE_Q, ExprOp::NEG}}
+    };
+    for (const CodeCase& codeCase : codeCases) {
+        checkCode(codeCase, variables);
+    }
+
+    //bound to a model: SNAs read the entities, V$ of a SimCPP variable is evaluated by handle
+    SimCPP sim("expression check");
+    sim.getQueueId("w");
+    sim.variable("v", "3#4+Q$w", VariableType::FVARIABLE);
+    Expression bound = Expression::parse("Q$w#2+V$v^2/12");
+    sim.bind(bound);
+    if (sim.evaluate(bound) != 12) {
+        report("Q$w#2+V$v^2/12", "gives " + std::to_string((double)sim.evaluate(bound)) + " instead of 12");
+    }
+
+    //a number is the whole run of digits and points
+    checkRefused("1.2.3");
+    checkRefused(".");
+    checkRefused("2+..5");
+    checkRefused("3.#.");
+    checkRefused("2+");
+    checkRefused("(2+3");
+    checkRefused("2 3");
+
+    if (failed) {
+        return 1;
+    }
+    std::cout << "the expressions are parsed and folded as expected" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../src/SimCPP.h"
+
+//pr5 model with arrivals and worker capacities scaled up so that about
+//"inFlight" transacts are advancing in the FEC at the same time
+
+#define METKA1 5
+#define METKA2 8
+#define METKA3 14
+#define METKA4 20
+#define METKA5 24
+#define METKA6 27
+#define METKA7 33
+
+struct BenchResult {
+    double eventsPerSec;
+    unsigned long maxFECSize;
+};
+
+BenchResult runScaledPr5(FECType engine, unsigned long inFlight, unsigned long measuredEvents) {
+    long double scale = inFlight / 4.;
+    long double R1 = 6 / scale;
+    unsigned int capacity = (unsigned int)std::ceil(5 * scale);
+    unsigned long events = 0;
+    unsigned long maxFECSize = 0;
+    std::chrono::steady_clock::time_point startTime;
+
+    SimCPP sim("scaled pr5", engine);
+    sim.storage("workers_1",capacity);
+    sim.storage("workers_2",capacity);
+    sim.storage("workers_3",capacity);
+    sim.start(1);
+    sim.initGenerate(1,R1);
+
+    //about 8 block executions per transact, warm-up lets the population settle twice
+    while (sim.isRunning() && events < 16 * inFlight + measuredEvents) {
+        if (events == 16 * inFlight) {
+            startTime = std::chrono::steady_clock::now();
+        }
+        switch(sim.sysEvent()) {
+            case 1: sim.generate(sim.exponential(R1)); break;
+
+            case 2: sim.queue("W1_QUEUE"); break;
+            case 3: sim.test(sim.getLinkParam("q_workers_1","CH") != 0, METKA1); break;
+            case 4: sim.link("q_workers_1", "M1"); break;
+
+            case 5: sim.test(sim.getStorageParam("workers_1","R") == 0, METKA2); break;
+            case 6: sim.test( ((sim.getStorageParam("workers_3","R") != 0) && \
+                (sim.getLinkParam("q_workers_1","CH")) >= sim.getLinkParam("q_workers_2","CH")) != true, METKA3); break;
+            case 7: sim.link("q_workers_1", "M1"); break;
+
+            case 8: sim.enter("workers_1"); break;
+            case 9: sim.depart("W1_QUEUE"); break;
+            case 10:sim.advance(sim.exponential(26)); break;
+            case 11:sim.leave("workers_1"); break;
+            case 12:sim.unlink("q_workers_1", METKA1, 1); break;
+            case 13:sim.transfer(METKA4); break;
+
+            case 14:sim.enter("workers_3"); break;
+            case 15:sim.depart("W1_QUEUE"); break;
+            case 16:sim.advance(sim.exponential(30)); break;
+            case 17:sim.leave("workers_3"); break;
+            case 18:sim.unlink("q_workers_1", METKA1, 1); break;
+            case 19:sim.unlink("q_workers_2", METKA5, 1); break;
+
+            case 20:sim.queue("W2_QUEUE"); break;
+            case 21:sim.assign("time", sim.getModelTime()); break;
+            case 22:sim.test(sim.getLinkParam("q_workers_2","CH") != 0, METKA5); break;
+            case 23:sim.link("q_workers_2", "time"); break;
+
+            case 24: sim.test(sim.getStorageParam("workers_2","R") == 0, METKA6); break;
+            case 25: sim.test( ((sim.getStorageParam("workers_3","R") != 0) && \
+                (sim.getLinkParam("q_workers_2","CH")) >= sim.getLinkParam("q_workers_1","CH")) != true, METKA7); break;
+            case 26: sim.link("q_workers_2", "time"); break;
+
+            case 27: sim.enter("workers_2"); break;
+            case 28: sim.depart("W2_QUEUE"); break;
+            case 29:sim.advance(sim.exponential(24)); break;
+            case 30:sim.leave("workers_2"); break;
+            case 31:sim.unlink("q_workers_2", METKA5, 1); break;
+            case 32:sim.terminate(); break;
+
+            case 33:sim.enter("workers_3"); break;
+            case 34:sim.depart("W2_QUEUE"); break;
+            case 35:sim.advance(sim.exponential(27)); break;
+            case 36:sim.leave("workers_3"); break;
+            case 37:sim.unlink("q_workers_1", METKA1, 1); break;
+            case 38:sim.unlink("q_workers_2", METKA5, 1); break;
+            case 39:sim.terminate(); break;
+
+            default: break;
+        }
+        events++;
+        if (sim.getFECSize() > maxFECSize) {
+            maxFECSize = sim.getFECSize();
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return BenchResult {measuredEvents / seconds, maxFECSize};
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long maxInFlight = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    unsigned long measuredEvents = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+    const std::pair<FECType, std::string> engines[] = {{FECType::LIST, "list"}, {FECType::BINARY_HEAP, "binary heap"}, \
+        {FECType::CALENDAR_QUEUE, "calendar queue"}, {FECType::LADDER_QUEUE, "ladder queue"}};
+
+    std::cout << "ENGINE\t\tIN FLIGHT\tMAX FEC\t\tEVENTS/SEC" << std::endl;
+    for (unsigned long inFlight = 1000; inFlight <= maxInFlight; inFlight *= 10) {
+        for (const std::pair<FECType, std::string>& engine : engines) {
+            if (engine.first == FECType::LIST && inFlight > 10000) {
+                continue; //linear insertion is hopeless there
+            }
+            BenchResult result = runScaledPr5(engine.first, inFlight, measuredEvents);
+            std::cout << engine.second << "\t" << inFlight << "\t\t" << result.maxFECSize << "\t\t" << (unsigned long)result.eventsPerSec << std::endl;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/SimCPP.h"
+
+//event order of every FEC engine against the list FEC: transacts advance in a loop by delays of very different
+//scales (a third of them whole, so many events tie); the chains fill and drain by turns of 2000 events: every
+//advance makes three more transacts at random times while the population grows, four of five transacts
+//terminate while it shrinks. Every event is recorded as (model time, transact number) and the sequences
+//of all engines must be equal
+//usage: fecCheck [runs] [events per run]; the exit code is 1 at the first difference
+
+std::vector<std::pair<long double,long double>> runOrder(FECType engine, uint64_t seed, unsigned long eventsNumb) {
+    std::vector<std::pair<long double,long double>> order;
+    unsigned long born = 0;
+    SimCPP sim("fec check", engine);
+    ParamId number = sim.getParamId("number");
+    Expression numberOf = Expression::parse("P$number");
+    sim.bind(numberOf);
+    sim.rmult(seed);
+    sim.start(1);
+    sim.initGenerate(1, 0);
+
+    //delay of a random scale
+    auto getDelay = [&sim]() {
+        long double kind = sim.uniform(1, 0, 1), delay;
+        if (kind < 0.3) delay = sim.uniform(2, 0, 1e-3);
+        else if (kind < 0.6) delay = sim.uniform(2, 0, 10);
+        else if (kind < 0.9) delay = sim.uniform(2, 0, 1000);
+        else delay = sim.uniform(2, 0, 1e5);
+        return sim.uniform(3, 0, 1) < 0.3 ? std::floor(delay) : delay;
+    };
+    while (sim.isRunning() && order.size() < eventsNumb) {
+        bool growing = order.size() / 2000 % 2 == 0;
+        switch (sim.sysEvent()) {
+            case 1:
+                sim.assign(number, born++);
+                order.emplace_back(sim.getModelTime(), sim.evaluate(numberOf));
+                break;
+            case 2:
+                order.emplace_back(sim.getModelTime(), sim.evaluate(numberOf));
+                for (unsigned int i = 0; growing && i < 3; i++) {
+                    sim.initGenerate(1, sim.getModelTime() + getDelay());
+                }
+                sim.advance(getDelay());
+                break;
+            case 3:
+                if (!growing && sim.getFECSize() > 10 && sim.uniform(4, 0, 1) < 0.8) {
+                    sim.terminate();
+                }
+                else {
+                    sim.transfer(2);
+                }
+                break;
+            default: break;
+        }
+    }
+    return order;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int runsNumb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300;
+    unsigned long eventsNumb = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+    const std::pair<FECType, std::string> engines[] = {{FECType::BINARY_HEAP, "binary heap"}, \
+        {FECType::CALENDAR_QUEUE, "calendar queue"}, {FECType::LADDER_QUEUE, "ladder queue"}};
+
+    for (unsigned int run = 1; run <= runsNumb; run++) {
+        std::vector<std::pair<long double,long double>> expected = runOrder(FECType::LIST, run, eventsNumb);
+        for (const std::pair<FECType, std::string>& engine : engines) {
+            std::vector<std::pair<long double,long double>> order = runOrder(engine.first, run, eventsNumb);
+            for (unsigned long i = 0; i < expected.size(); i++) {
+                if (i >= order.size() || order[i] != expected[i]) {
+                    std::cout << engine.second << ", run " << run << ": event " << i << " is ";
+                    if (i < order.size()) {
+                        std::cout << "transact " << (unsigned long)order[i].second << " at " << (double)order[i].first;
+                    }
+                    else {
+                        std::cout << "missing";
+                    }
+                    std::cout << ", the list FEC has transact " << (unsigned long)expected[i].second << " at " << (double)expected[i].first << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    std::cout << "all engines give the list FEC order in " << runsNumb << " runs" << std::endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <string>
+#include <vector>
+#include "../src/SimCPP.h"
+
+//skip list index of a parameter ordered user chain against a plain ordered list kept beside the model: transacts
+//LINK by a parameter with many ties, unlinkers release them from the head, from the back (UNLINK BACK), by the value
+//of the ordering parameter and by the value of another one. The chain grows and drains by turns of 2000 time units,
+//so the index gets all its levels. Every LINK and UNLINK is done on the list too, the transacts released by the model
+//must come in the order of the list, and the last unlinker releases the rest
+//usage: linkCheck [runs] [model time per run]; the exit code is 1 at the first difference
+
+struct Linked {
+    long double key;
+    unsigned long number;
+    unsigned long group;
+};
+
+//the released transacts of the model and the list
+struct RunResult {
+    std::vector<unsigned long> released, expected;
+    unsigned long entries, expectedEntries;
+    unsigned long maxSize;
+};
+
+RunResult runModel(uint64_t seed, long double runTime) {
+    RunResult result {{}, {}, 0, 0, 0};
+    std::list<Linked> ordered;
+    unsigned long born = 0;
+    SimCPP sim("link check");
+    LinkId chain = sim.getLinkId("chain");
+    ParamId key = sim.getParamId("key"), number = sim.getParamId("number"), group = sim.getParamId("group");
+    Expression keyOf = Expression::parse("P$key"), numberOf = Expression::parse("P$number"), groupOf = Expression::parse("P$group");
+    sim.bind(keyOf);
+    sim.bind(numberOf);
+    sim.bind(groupOf);
+    sim.rmult(seed);
+    sim.start(1);
+    sim.initGenerate(1, 0);
+    sim.initGenerate(10, 0);
+    sim.initGenerate(20, runTime);
+
+    //the released transacts of the list, the ones the model must release in this order
+    auto release = [&ordered, &result](std::list<Linked>::iterator linked) {
+        result.expected.push_back(linked->number);
+        return ordered.erase(linked);
+    };
+
+    while (sim.isRunning()) {
+        switch (sim.sysEvent()) {
+            case 1: sim.generate(sim.exponential(1, 0, 1)); break;
+            case 2: sim.assign(number, born++); break;
+            case 3: sim.assign(key, std::floor(sim.uniform(2, 0, 200))); break;
+            case 4: sim.assign(group, (unsigned long)sim.evaluate(numberOf) % 3); break;
+            case 5: {
+                Linked linked {sim.evaluate(keyOf), (unsigned long)sim.evaluate(numberOf), (unsigned long)sim.evaluate(groupOf)};
+                std::list<Linked>::iterator after = ordered.begin();
+                while (after != ordered.end() && after->key <= linked.key) {
+                    after++;
+                }
+                ordered.insert(after, linked);
+                result.expectedEntries++;
+                result.maxSize = std::max(result.maxSize, (unsigned long)ordered.size());
+                sim.link(chain, key);
+                break;
+            }
+            case 6:
+                result.released.push_back((unsigned long)sim.evaluate(numberOf));
+                sim.transfer(7);
+                break;
+            case 7: sim.terminate(0); break;
+
+            //unlinkers, more often while the chain drains
+            case 10: sim.generate(sim.exponential(3, 0, std::fmod(sim.getModelTime(), 4000) < 2000 ? 4 : 0.6)); break;
+            case 11: {
+                double kind = sim.uniform(4, 0, 1);
+                unsigned int count = 1 + (unsigned int)std::floor(sim.uniform(5, 0, 4));
+                if (kind < 0.3) {
+                    for (unsigned int i = 0; i < count && !ordered.empty(); i++) {
+                        release(ordered.begin());
+                    }
+                    sim.unlink(chain, 6, count);
+                }
+                else if (kind < 0.55) {
+                    for (unsigned int i = 0; i < count && !ordered.empty(); i++) {
+                        release(std::prev(ordered.end()));
+                    }
+                    sim.unlink(chain, 6, count, UnlinkFrom::BACK);
+                }
+                else {
+                    //by the ordering parameter, count or all of them, or by the group
+                    bool byKey = kind < 0.85;
+                    long double value = byKey ? std::floor(sim.uniform(6, 0, 200)) : std::floor(sim.uniform(6, 0, 3));
+                    if (byKey && sim.uniform(7, 0, 1) < 0.2) {
+                        count = std::numeric_limits<unsigned int>::max();
+                    }
+                    unsigned int releasedNumb = 0;
+                    for (std::list<Linked>::iterator linked = ordered.begin(); linked != ordered.end() && releasedNumb < count; ) {
+                        if ((byKey ? linked->key : linked->group) == value) {
+                            linked = release(linked);
+                            releasedNumb++;
+                        }
+                        else {
+                            linked++;
+                        }
+                    }
+                    sim.unlink(chain, 6, count, UnlinkFrom::PARAM, byKey ? key : group, value);
+                }
+                break;
+            }
+            case 12: sim.terminate(0); break;
+
+            //the rest is released before the end of the run
+            case 20:
+                while (!ordered.empty()) {
+                    release(ordered.begin());
+                }
+                sim.unlink(chain, 6, std::numeric_limits<unsigned int>::max());
+                break;
+            case 21: sim.advance(0); break;
+            case 22: sim.terminate(1); break;
+            default: break;
+        }
+    }
+    result.entries = sim.getLinkStats()[0].entries;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int runsNumb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+    long double runTime = argc > 2 ? std::strtold(argv[2], nullptr) : 20000;
+    unsigned long releasedNumb = 0, maxSize = 0;
+
+    for (unsigned int run = 1; run <= runsNumb; run++) {
+        RunResult result = runModel(run, runTime);
+        if (result.entries != result.expectedEntries) {
+            std::cout << "run " << run << ": the chain has " << result.entries << " entries, the list " << result.expectedEntries << std::endl;
+            return 1;
+        }
+        for (unsigned long i = 0; i < std::max(result.released.size(), result.expected.size()); i++) {
+            if (i >= result.released.size() || i >= result.expected.size() || result.released[i] != result.expected[i]) {
+                std::cout << "run " << run << ": release " << i + 1 << " of " << result.expected.size() << " is transact " \
+                    << (i < result.released.size() ? std::to_string(result.released[i]) : "none") << ", the list releases " \
+                    << (i < result.expected.size() ? std::to_string(result.expected[i]) : "none") << std::endl;
+                return 1;
+            }
+        }
+        releasedNumb += result.released.size();
+        maxSize = std::max(maxSize, result.maxSize);
+    }
+    std::cout << "the indexed chain releases " << releasedNumb << " transacts of " << runsNumb << " runs in the order of the list, " \
+        << "up to " << maxSize << " in the chain" << std::endl;
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/pr5Model.h"
+#include "allocCounter.h"
+
+//synthetic block programs scaled by their parameters and the pr5 model, one JSON line per model on stdout:
+//events (block executions) per second, peak resident memory and heap allocations of the runs, building included;
+//every model runs in its own process, so the peak memory is of that model only, the seeds are fixed,
+//so the events and the allocations are the same from run to run and any change of them is a change of the engine
+//usage: modelBench [maxPending] [measuredEvents] [baseline.json]
+//deep FEC models are run for 10^5, 10^6, ... pending transacts up to maxPending, 10^7 needs about 5 GB
+//with a baseline (an earlier output) the models are compared on stderr and the exit code is 1 when a model
+//is slower than TOLERANCE or allocates more
+
+#define TOLERANCE 0.1
+
+struct BenchModel {
+    std::string name;
+    std::string params; //JSON object
+    std::function<void(SimCPP&)> run; //builds and runs the model on a fresh SimCPP
+    unsigned int runsNumb; //with the seeds 12345, 12346, ...
+};
+
+//K stages of c servers in series, Poisson arrivals with mean 1 and a load of 0.9 at every stage
+BenchModel mmcNetwork(unsigned int stagesNumb, unsigned int serversNumb, unsigned long measuredEvents) {
+    long double endTime = measuredEvents / (5. * stagesNumb + 2);
+    return BenchModel {"mmc_network_k" + std::to_string(stagesNumb) + "_c" + std::to_string(serversNumb), \
+        "{\"stages\": " + std::to_string(stagesNumb) + ", \"servers\": " + std::to_string(serversNumb) + "}", \
+        [stagesNumb, serversNumb, endTime](SimCPP& sim) {
+            BlockProgram program;
+            double service = 0.9 * serversNumb;
+            program.generate([](SimCPP& sim){ return sim.exponential(1, 0, 1); });
+            for (unsigned int stage = 1; stage <= stagesNumb; stage++) {
+                std::string name = "stage_" + std::to_string(stage);
+                program.storage(name, serversNumb);
+                program.queue(name);
+                program.enter(name);
+                program.depart(name);
+                program.advance([stage, service](SimCPP& sim){ return sim.exponential(stage + 1, 0, service); });
+                program.leave(name);
+            }
+            program.terminate();
+            program.generate(0, endTime, 1);
+            program.terminate(1);
+            sim.load(program);
+            sim.start(1);
+            sim.run();
+        }, 1};
+}
+
+//one server pool with a FIFO user chain in front of it as at pr5, every arrival that finds no free server
+//is linked and every departure unlinks one, a load of 0.95
+BenchModel linkTraffic(unsigned int serversNumb, unsigned long measuredEvents) {
+    long double endTime = measuredEvents / 9.;
+    return BenchModel {"link_unlink_c" + std::to_string(serversNumb), "{\"servers\": " + std::to_string(serversNumb) + "}", \
+        [serversNumb, endTime](SimCPP& sim) {
+            BlockProgram program;
+            double service = 0.95 * serversNumb;
+            program.storage("servers", serversNumb);
+            program.generate([](SimCPP& sim){ return sim.exponential(1, 0, 1); });
+            program.queue("waiting");
+            program.test(Expression::parse("R$servers'E'0"), "SERVE");
+            program.link("chain", "FIFO");
+            program.label("SERVE");
+            program.enter("servers");
+            program.depart("waiting");
+            program.advance([service](SimCPP& sim){ return sim.exponential(2, 0, service); });
+            program.leave("servers");
+            program.unlink("chain", "SERVE", 1);
+            program.terminate();
+            program.generate(0, endTime, 1);
+            program.terminate(1);
+            sim.load(program);
+            sim.start(1);
+            sim.run();
+        }, 1};
+}
+
+//closed population of N transacts cycling through c servers without think time, all but c wait at ENTER
+BenchModel blockedEnter(unsigned long population, unsigned int serversNumb, unsigned long measuredEvents) {
+    long double endTime = measuredEvents / (4. * serversNumb);
+    return BenchModel {"blocked_enter_n" + std::to_string(population), \
+        "{\"population\": " + std::to_string(population) + ", \"servers\": " + std::to_string(serversNumb) + "}", \
+        [population, serversNumb, endTime](SimCPP& sim) {
+            BlockProgram program;
+            program.storage("servers", serversNumb);
+            program.generate(0, 0, population);
+            program.label("CYCLE");
+            program.enter("servers");
+            program.advance([](SimCPP& sim){ return sim.exponential(1, 0, 1); });
+            program.leave("servers");
+            program.transfer("CYCLE");
+            program.generate(0, endTime, 1);
+            program.terminate(1);
+            sim.load(program);
+            sim.start(1);
+            sim.run();
+        }, 1};
+}
+
+//closed population of N transacts, each one always pending in the FEC
+BenchModel deepFEC(unsigned long pending, unsigned long measuredEvents) {
+    long double endTime = measuredEvents / (2. * pending);
+    return BenchModel {"deep_fec_n" + std::to_string(pending), "{\"pending\": " + std::to_string(pending) + "}", \
+        [pending, endTime](SimCPP& sim) {
+            BlockProgram program;
+            program.generate(0, 0, pending);
+            program.label("CYCLE");
+            program.advance([](SimCPP& sim){ return sim.exponential(1, 0, 1); });
+            program.transfer("CYCLE");
+            program.generate(0, endTime, 1);
+            program.terminate(1);
+            sim.load(program);
+            sim.start(1);
+            sim.run();
+        }, 1};
+}
+
+//runs the model in a child process and gives its JSON line, empty if the child has failed
+std::string runModel(const BenchModel& model) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+        return "";
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        std::string line;
+        try {
+            unsigned long events = 0, allocations = allocationsNumb, bytes = allocatedBytes;
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            for (unsigned int run = 0; run < model.runsNumb; run++) {
+                SimCPP sim(model.name);
+                sim.rmult(12345 + run);
+                model.run(sim);
+                events += sim.getEventsNumb();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            allocations = allocationsNumb - allocations;
+            bytes = allocatedBytes - bytes;
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+
+            char values[512];
+            std::snprintf(values, sizeof(values), "\"runs\": %u, \"events\": %lu, \"seconds\": %.6f, \"events_per_sec\": %.0f, "
+                "\"peak_rss_kb\": %ld, \"allocations\": %lu, \"allocated_bytes\": %lu", model.runsNumb, events, seconds, \
+                seconds > 0 ? events / seconds : 0., usage.ru_maxrss, allocations, bytes);
+            line = "{\"name\": \"" + model.name + "\", \"params\": " + model.params + ", " + values + "}";
+        }
+        catch (const std::exception& error) {
+            std::cerr << model.name << ": " << error.what() << std::endl;
+        }
+        if (write(channel[1], line.data(), line.size()) != (ssize_t)line.size()) {
+            _exit(1);
+        }
+        _exit(line.empty() ? 1 : 0);
+    }
+
+    close(channel[1]);
+    std::string line;
+    char buffer[512];
+    ssize_t size;
+    while ((size = read(channel[0], buffer, sizeof(buffer))) > 0) {
+        line.append(buffer, size);
+    }
+    close(channel[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? line : "";
+}
+
+//the number after "key": in a JSON line of this bench
+double getNumber(const std::string& line, const std::string& key) {
+    std::string::size_type position = line.find("\"" + key + "\": ");
+    return position == std::string::npos ? -1 : std::strtod(line.c_str() + position + key.size() + 4, nullptr);
+}
+
+std::string getName(const std::string& line) {
+    std::string::size_type position = line.find("\"name\": \"");
+    return position == std::string::npos ? "" : line.substr(position + 9, line.find('"', position + 9) - position - 9);
+}
+
+//false if any model is slower than TOLERANCE or allocates more than at the baseline
+bool compare(const std::vector<std::string>& lines, const std::string& baselineName) {
+    std::ifstream baseline(baselineName);
+    std::vector<std::string> baselineLines;
+    std::string line;
+    if (!baseline) {
+        std::cerr << "Cannot open the baseline \"" << baselineName << '\"' << std::endl;
+        return false;
+    }
+    while (std::getline(baseline, line)) {
+        if (!getName(line).empty()) {
+            baselineLines.push_back(line);
+        }
+    }
+
+    bool passed = true;
+    std::cerr << "MODEL\t\t\tEVENTS/SEC\tBASELINE\tRATIO\tALLOCATIONS\tBASELINE" << std::endl;
+    for (const std::string& current : lines) {
+        std::string name = getName(current);
+        std::vector<std::string>::iterator it = std::find_if(baselineLines.begin(), baselineLines.end(), \
+            [&name](const std::string& baselineLine){ return getName(baselineLine) == name; });
+        if (it == baselineLines.end()) {
+            std::cerr << name << "\tnot in the baseline" << std::endl;
+            continue;
+        }
+        double ratio = getNumber(current, "events_per_sec") / getNumber(*it, "events_per_sec");
+        bool slower = ratio < 1 - TOLERANCE;
+        bool moreAllocations = getNumber(current, "allocations") > getNumber(*it, "allocations");
+        std::cerr << name << "\t" << (unsigned long)getNumber(current, "events_per_sec") << "\t\t" << (unsigned long)getNumber(*it, "events_per_sec") \
+            << "\t\t" << ratio << "\t" << (unsigned long)getNumber(current, "allocations") << "\t\t" << (unsigned long)getNumber(*it, "allocations") \
+            << (slower ? "\tSLOWER" : "") << (moreAllocations ? "\tMORE ALLOCATIONS" : "") << std::endl;
+        passed = passed && !slower && !moreAllocations;
+    }
+    return passed;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long maxPending = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    unsigned long measuredEvents = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+
+    std::vector<BenchModel> models;
+    models.push_back(mmcNetwork(1, 1, measuredEvents));
+    models.push_back(mmcNetwork(5, 4, measuredEvents));
+    models.push_back(mmcNetwork(20, 16, measuredEvents));
+    models.push_back(linkTraffic(1, measuredEvents));
+    models.push_back(linkTraffic(16, measuredEvents));
+    models.push_back(blockedEnter(1000, 10, measuredEvents));
+    models.push_back(blockedEnter(100000, 10, measuredEvents));
+    for (unsigned long pending = 100000; pending <= maxPending; pending *= 10) {
+        models.push_back(deepFEC(pending, measuredEvents + pending));
+    }
+    //the timer of pr5 ends a run at 3600 after about 14000 events
+    models.push_back(BenchModel {"pr5", "{\"workers\": [3, 3, 3]}", [](SimCPP& sim){ pr5Model(sim); }, \
+        (unsigned int)std::max(1ul, measuredEvents / 14000)});
+
+    std::vector<std::string> lines;
+    for (const BenchModel& model : models) {
+        std::string line = runModel(model);
+        if (line.empty()) {
+            std::cerr << model.name << " has failed" << std::endl;
+            return 1;
+        }
+        std::cout << line << std::endl;
+        lines.push_back(line);
+    }
+    return argc > 3 && !compare(lines, argv[3]) ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "../src/pr5Model.h"
+#include "../src/Replications.h"
+
+//replications of the pr5 model per second for 1, 2, 4, ... threads up to the hardware threads,
+//estimates must not depend on the number of threads
+
+int main(int argc, char* argv[]) {
+    unsigned int numbOfRuns = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    unsigned int maxThreads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+    double baseRunsPerSec = 0, baseAveCont = 0;
+
+    std::cout << "THREADS\tRUNS/SEC\tSPEEDUP\tW1_QUEUE AVE.CONT.\tIDENTICAL" << std::endl;
+    for (unsigned int threadsNumb = 1; threadsNumb <= maxThreads; threadsNumb *= 2) {
+        Replications replications("pr5", [](SimCPP& sim){ pr5Model(sim); }, threadsNumb);
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        replications.run(numbOfRuns);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        double aveCont = replications.getQueueEstimates()[0].aveCont.getMean();
+        if (threadsNumb == 1) {
+            baseRunsPerSec = numbOfRuns / seconds;
+            baseAveCont = aveCont;
+        }
+        std::cout << threadsNumb << "\t" << (unsigned long)(numbOfRuns / seconds) << "\t\t" << numbOfRuns / seconds / baseRunsPerSec \
+            << "\t" << aveCont << "\t\t" << (aveCont == baseAveCont ? "yes" : "NO") << std::endl;
+    }
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include "../src/SimCPP.h"
+
+//samples per second of every distribution with and without variate buffering,
+//both runs must produce the same sums for the same seed, the best of RUNS runs is reported
+
+#define RUNS 3
+
+struct BenchResult {
+    double samplesPerSec;
+    double sum;
+};
+
+BenchResult runDistribution(const std::function<double(SimCPP&)>& sample, bool buffering, unsigned long samples) {
+    BenchResult best {0, 0};
+    for (unsigned int run = 0; run < RUNS; run++) {
+        SimCPP sim("rng bench");
+        double sum = 0;
+        sim.setVariateBuffering(buffering);
+        sim.rmult(12345);
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < samples; i++) {
+            sum += sample(sim);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (samples / seconds > best.samplesPerSec) {
+            best = BenchResult {samples / seconds, sum};
+        }
+    }
+    return best;
+}
+
+//the generator alone, one uniform per call against blocks of UNIFORM_BLOCK
+BenchResult runGenerator(bool blocks, unsigned long samples) {
+    BenchResult best {0, 0};
+    double uniforms[UNIFORM_BLOCK];
+    for (unsigned int run = 0; run < RUNS; run++) {
+        PCG32 generator(12345, 1);
+        double sum = 0;
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < samples; i += UNIFORM_BLOCK) {
+            if (blocks) {
+                generator.fillUniforms(uniforms, UNIFORM_BLOCK);
+            }
+            else {
+                for (unsigned int j = 0; j < UNIFORM_BLOCK; j++) {
+                    uniforms[j] = generator.nextUniform();
+                }
+            }
+            for (unsigned int j = 0; j < UNIFORM_BLOCK; j++) {
+                sum += uniforms[j];
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (samples / seconds > best.samplesPerSec) {
+            best = BenchResult {samples / seconds, sum};
+        }
+    }
+    return best;
+}
+
+void printRow(const std::string& name, const BenchResult& scalar, const BenchResult& buffered) {
+    std::cout << name << "\t" << (unsigned long)scalar.samplesPerSec << "\t" << (unsigned long)buffered.samplesPerSec << "\t" \
+        << buffered.samplesPerSec / scalar.samplesPerSec << "\t" << (scalar.sum == buffered.sum ? "yes" : "NO") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    EmpiricalFunction function(FunctionType::CONTINUOUS, {{0., 1.}, {0.5, 3.}, {1., 10.}});
+    const std::pair<std::string, std::function<double(SimCPP&)>> distributions[] = {
+        {"uniform", [](SimCPP& sim){ return sim.uniform(1, 0, 1); }},
+        {"exponential", [](SimCPP& sim){ return sim.exponential(1, 0, 1); }},
+        {"normal", [](SimCPP& sim){ return sim.normal(1, 0, 1); }},
+        {"erlang(3)", [](SimCPP& sim){ return sim.erlang(1, 0, 1, 3); }},
+        {"weibull", [](SimCPP& sim){ return sim.weibull(1, 0, 1, 2); }},
+        {"triangular", [](SimCPP& sim){ return sim.triangular(1, 0, 2, 1); }},
+        {"empirical", [&function](SimCPP& sim){ return sim.empirical(1, function); }},
+        {"exp/normal mix", [](SimCPP& sim){ return sim.exponential(1, 0, 1) + sim.normal(1, 0, 1); }}};
+
+    std::cout << "DISTRIBUTION\tSCALAR/SEC\tBUFFERED/SEC\tSPEEDUP\tIDENTICAL" << std::endl;
+    printRow("pcg32 block", runGenerator(false, samples), runGenerator(true, samples));
+    for (const std::pair<std::string, std::function<double(SimCPP&)>>& distribution : distributions) {
+        printRow(distribution.first, runDistribution(distribution.second, false, samples), runDistribution(distribution.second, true, samples));
+    }
+}
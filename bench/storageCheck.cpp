@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include "../src/SimCPP.h"
+
+//storage delay chains against the rescan of the blocked transacts they replaced: an overloaded storage of 4 channels
+//gets demands of 1 to 3 channels, so the waiting transacts pile up and small demands pass larger ones.
+//The reference run does not block at ENTER: a transact that does not fit links to a FIFO user chain and every LEAVE
+//unlinks them all to try ENTER again in their order, as the blocked transacts in the CEC did on every scan.
+//The queue and storage statistics and the waiting transacts at the end must be the same; a refused transact stays
+//in the QUEUE block until it gets its channels, so ENTRY of the ENTER block is the storage entries and its CURRENT is 0
+//usage: storageCheck [runs] [model time per run]; the exit code is 1 at the first difference
+
+struct RunResult {
+    long double modelTime;
+    QueueStat queue;
+    StorageStat storage;
+    unsigned long waitingNumb;
+    unsigned long queueCurrent, enterEntries, enterCurrent; //block counts
+    double seconds;
+};
+
+RunResult runModel(bool rescan, uint64_t seed, long double runTime) {
+    SimCPP sim("storage check");
+    StorageId storage = sim.storage("channels", 4);
+    QueueId queue = sim.getQueueId("waiting");
+    LinkId delayed = sim.getLinkId("delayed");
+    ParamId demand = sim.getParamId("demand");
+    Expression demandOf = Expression::parse("P$demand");
+    sim.bind(demandOf);
+    sim.rmult(seed);
+    sim.start(1);
+    sim.initGenerate(1, 0);
+    sim.initGenerate(10, runTime); //the run ends between events, not at a LEAVE
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    while (sim.isRunning()) {
+        switch (sim.sysEvent()) {
+            case 1: sim.generate(sim.exponential(1, 0, 0.8)); break;
+            case 2: sim.assign(demand, std::floor(sim.uniform(2, 1, 4))); break;
+            case 3: sim.queue(queue); break;
+            case 4:
+                if (rescan && sim.getStorageParam(storage, SNA::R) < (unsigned int)sim.evaluate(demandOf)) {
+                    sim.link(delayed, LinkOrder::FIFO); //ENTER is tried again after the next LEAVE
+                }
+                else {
+                    sim.enter(storage, (unsigned int)sim.evaluate(demandOf));
+                }
+                break;
+            case 5: sim.depart(queue); break;
+            case 6: sim.advance(sim.exponential(3, 0, 1.9)); break;
+            case 7: sim.leave(storage, (unsigned int)sim.evaluate(demandOf)); break;
+            case 8: sim.unlink(delayed, 4, std::numeric_limits<unsigned int>::max()); break;
+            case 9: sim.terminate(0); break;
+            case 10: sim.terminate(1); break;
+            default: break;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    const StorageStat& storageStat = sim.getStorageStats()[0];
+    unsigned long waitingNumb = rescan ? sim.getLinkStats()[0].cont : storageStat.delay;
+    return RunResult {sim.getModelTime(), sim.getQueueStats()[0], storageStat, waitingNumb, sim.getBlockCurrent(3), sim.getBlockEntries(4), \
+        sim.getBlockCurrent(4), seconds};
+}
+
+//NaN statistics ("------") are equal to each other
+bool isSame(long double first, long double second) {
+    return first == second || (std::isnan(first) && std::isnan(second));
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int runsNumb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+    long double runTime = argc > 2 ? std::strtold(argv[2], nullptr) : 10000;
+    double seconds[2] = {0, 0};
+
+    for (unsigned int run = 1; run <= runsNumb; run++) {
+        RunResult expected = runModel(true, run, runTime), result = runModel(false, run, runTime);
+        seconds[0] += expected.seconds;
+        seconds[1] += result.seconds;
+        bool same = isSame(expected.modelTime, result.modelTime) && expected.waitingNumb == result.waitingNumb \
+            && expected.queue.maxCont == result.queue.maxCont && expected.queue.cont == result.queue.cont \
+            && expected.queue.entries == result.queue.entries && expected.queue.zeroEntries == result.queue.zeroEntries \
+            && isSame(expected.queue.aveCont, result.queue.aveCont) && isSame(expected.queue.aveTime, result.queue.aveTime) \
+            && isSame(expected.queue.aveTimeNonZero, result.queue.aveTimeNonZero) \
+            && expected.storage.available == result.storage.available && expected.storage.maxCont == result.storage.maxCont \
+            && expected.storage.entries == result.storage.entries && isSame(expected.storage.aveCont, result.storage.aveCont) \
+            && isSame(expected.storage.util, result.storage.util);
+        if (!same) {
+            std::cout << "run " << run << ": the delay chain gives model time " << (double)result.modelTime << ", " << result.waitingNumb \
+                << " waiting, " << result.storage.entries << " entries; the rescan gives " << (double)expected.modelTime << ", " \
+                << expected.waitingNumb << " waiting, " << expected.storage.entries << " entries" << std::endl;
+            return 1;
+        }
+        if (result.queueCurrent != result.waitingNumb || result.enterEntries != result.storage.entries || result.enterCurrent != 0) {
+            std::cout << "run " << run << ": " << result.waitingNumb << " waiting, " << result.storage.entries << " entries, but the blocks have " \
+                << result.queueCurrent << " at QUEUE, " << result.enterEntries << " entries and " << result.enterCurrent << " current at ENTER" << std::endl;
+            return 1;
+        }
+        if (run == runsNumb) {
+            std::cout << "last run: " << result.waitingNumb << " transacts waiting at model time " << (double)result.modelTime << std::endl;
+        }
+    }
+    std::cout << "the delay chains give the statistics of the rescan in " << runsNumb << " runs, " << seconds[1] << " s against " \
+        << seconds[0] << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "SymbolTable.h"
+#include "Expression.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class SimCPP;
+
+//operand of a block: a constant, an expression or a function, the last two are evaluated each time a transact enters the block
+class Operand {
+    friend class SimCPP;
+    private:
+        long double _value;
+        std::function<long double(SimCPP&)> _compute;
+        Expression _expression; //bound by SimCPP::load
+    public:
+        Operand(long double value = 0): _value(value) {}
+        Operand(const Expression& expression): _value(0), _expression(expression) {}
+        template <class Function, class = typename std::enable_if<!std::is_arithmetic<Function>::value>::type>
+        Operand(Function compute): _value(0), _compute(compute) {}
+
+        bool isConstant() const { return !_compute && _expression.empty(); }
+};
+
+enum class BlockType { GENERATE, TERMINATE, ADVANCE, TEST, TRANSFER, ASSIGN, ENTER, LEAVE, QUEUE, DEPART, LINK, UNLINK, TABULATE };
+
+struct Block;
+using BlockHandler = void (SimCPP::*)(Block&); //runs a transact through a block of the type
+
+//one block of a program, names and labels are resolved into handles and block numbers by SimCPP::load
+struct Block {
+    BlockType type;
+    std::string label; //of the block, may be empty
+    std::string entity; //storage, queue, user chain, table or parameter name
+    std::string target; //label of the TEST false exit, TRANSFER and UNLINK destination
+    std::string discipline; //of LINK: FIFO, LIFO or a parameter name, of UNLINK: empty, BACK or a parameter name
+    Operand A, B; //GENERATE interval and offset, ADVANCE delay, ASSIGN value, TEST condition (not 0 is true), UNLINK parameter value,
+                  //TABULATE value (the table argument, set by SimCPP::load)
+    bool hasOffset; //GENERATE B is given, otherwise the first transact comes after an interval
+    unsigned int count; //TERMINATE decrement, ENTER/LEAVE channels, UNLINK transacts, GENERATE limit (0 is unlimited), TABULATE weight
+
+    //resolved
+    unsigned int handle = 0; //of the entity
+    unsigned int targetBlock = 0;
+    LinkOrder order = LinkOrder::FIFO;
+    UnlinkFrom unlinkFrom = UnlinkFrom::HEAD;
+    unsigned int paramHandle = 0; //of the LINK and UNLINK parameter
+    unsigned long generatedNumb = 0; //transacts made by a GENERATE block
+    BlockHandler handler = nullptr;
+};
+
+//GPSS TABLE (argument) or QTABLE (queue name), declared by SimCPP::load
+struct TableDefinition {
+    std::string name;
+    Operand argument; //of TABLE, tabulated by TABULATE
+    std::string queueName; //of QTABLE
+    long double upperLimit;
+    long double width;
+    unsigned int classesNumb;
+    double sketchAccuracy; //0 is no quantile sketch
+};
+
+//model definition as a block vector with symbolic labels, GPSS style:
+//    program.label("METKA1");
+//    program.test([](SimCPP& sim){ return ...; }, "METKA2");
+//blocks are numbered from 1 in the order of adding, SimCPP::load compiles the program for one model and SimCPP::run interprets it
+class BlockProgram {
+    private:
+        std::vector<Block> _blocks;
+        std::vector<std::pair<std::string,unsigned int>> _storages; //name and capacity
+        std::vector<TableDefinition> _tables;
+        std::unordered_map<std::string, unsigned int> _labels; //label -> block number
+        std::string _nextLabel;
+
+        unsigned int add(Block block);
+    public:
+        void storage(const std::string& storageName, unsigned int capacity); //declared by SimCPP::load
+        void table(const std::string& tableName, const Operand& argument, long double upperLimit, long double width, unsigned int classesNumb, \
+            double sketchAccuracy = 0.01);
+        void qtable(const std::string& tableName, const std::string& queueName, long double upperLimit, long double width, unsigned int classesNumb, \
+            double sketchAccuracy = 0.01);
+        void label(const std::string& label); //of the next block
+
+        unsigned int generate(const Operand& interval);
+        unsigned int generate(const Operand& interval, const Operand& offset, unsigned int limit = 0);
+        unsigned int terminate(unsigned int decrement = 0);
+        unsigned int advance(const Operand& delay);
+        unsigned int test(const Operand& condition, const std::string& falseLabel);
+        unsigned int transfer(const std::string& label);
+        unsigned int assign(const std::string& paramName, const Operand& value);
+        unsigned int enter(const std::string& storageName, unsigned int numbOfChannels = 1);
+        unsigned int leave(const std::string& storageName, unsigned int numbOfChannels = 1);
+        unsigned int queue(const std::string& queueName);
+        unsigned int depart(const std::string& queueName);
+        unsigned int link(const std::string& linkName, const std::string& discipline); //FIFO, LIFO or a parameter name
+        unsigned int unlink(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans);
+        unsigned int tabulate(const std::string& tableName, unsigned int weight = 1); //the argument of the table
+        unsigned int unlinkBack(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans);
+        //the transacts with the parameter equal to value
+        unsigned int unlink(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans, const std::string& paramName, \
+            const Operand& value);
+
+        const std::vector<Block>& getBlocks() const { return _blocks; }
+        const std::vector<std::pair<std::string,unsigned int>>& getStorages() const { return _storages; }
+        const std::vector<TableDefinition>& getTables() const { return _tables; }
+        const TableDefinition& getTable(const std::string& tableName) const; //throws for undefined tables
+        unsigned int getBlockNumb(const std::string& label) const; //throws for unknown labels
+        std::string getAsString() const; //listing, one block per line
+
+        static std::string getBlockName(BlockType type);
+};
+
+//-----
+
+unsigned int BlockProgram::add(Block block) {
+    block.label = _nextLabel;
+    block.handle = block.targetBlock = block.paramHandle = 0;
+    block.order = LinkOrder::FIFO;
+    block.unlinkFrom = UnlinkFrom::HEAD;
+    block.generatedNumb = 0;
+    _blocks.push_back(block);
+    _nextLabel.clear();
+    return _blocks.size();
+}
+
+void BlockProgram::storage(const std::string& storageName, unsigned int capacity) {
+    if (std::find_if(_storages.begin(), _storages.end(), [&storageName](const std::pair<std::string,unsigned int>& storage) \
+        { return storage.first == storageName; }) != _storages.end()) {
+        throw std::logic_error("You cannot create storages with the same names (" + storageName + ')');
+    }
+    _storages.emplace_back(storageName, capacity);
+}
+
+void BlockProgram::table(const std::string& tableName, const Operand& argument, long double upperLimit, long double width, \
+    unsigned int classesNumb, double sketchAccuracy) {
+    if (std::find_if(_tables.begin(), _tables.end(), [&tableName](const TableDefinition& table){ return table.name == tableName; }) != _tables.end()) {
+        throw std::logic_error("You cannot create tables with the same names (" + tableName + ')');
+    }
+    _tables.push_back(TableDefinition {tableName, argument, "", upperLimit, width, classesNumb, sketchAccuracy});
+}
+
+void BlockProgram::qtable(const std::string& tableName, const std::string& queueName, long double upperLimit, long double width, \
+    unsigned int classesNumb, double sketchAccuracy) {
+    this->table(tableName, Operand(), upperLimit, width, classesNumb, sketchAccuracy);
+    _tables.back().queueName = queueName;
+}
+
+const TableDefinition& BlockProgram::getTable(const std::string& tableName) const {
+    std::vector<TableDefinition>::const_iterator tableIt = std::find_if(_tables.begin(), _tables.end(), \
+        [&tableName](const TableDefinition& table){ return table.name == tableName; });
+    if (tableIt == _tables.end()) {
+        throw std::logic_error("Undefined table \"" + tableName + '\"');
+    }
+    return *tableIt;
+}
+
+void BlockProgram::label(const std::string& label) {
+    if (_labels.find(label) != _labels.end() || !_nextLabel.empty()) {
+        throw std::logic_error("Block label \"" + label + "\" is defined twice or the block already has a label");
+    }
+    _labels[label] = _blocks.size() + 1;
+    _nextLabel = label;
+}
+
+unsigned int BlockProgram::getBlockNumb(const std::string& label) const {
+    std::unordered_map<std::string, unsigned int>::const_iterator labelIt = _labels.find(label);
+    if (labelIt == _labels.end() || labelIt->second > _blocks.size()) {
+        throw std::logic_error("Undefined block label \"" + label + '\"');
+    }
+    return labelIt->second;
+}
+
+unsigned int BlockProgram::generate(const Operand& interval) {
+    return this->add(Block {BlockType::GENERATE, "", "", "", "", interval, Operand(), false, 0});
+}
+
+unsigned int BlockProgram::generate(const Operand& interval, const Operand& offset, unsigned int limit) {
+    return this->add(Block {BlockType::GENERATE, "", "", "", "", interval, offset, true, limit});
+}
+
+unsigned int BlockProgram::terminate(unsigned int decrement) {
+    return this->add(Block {BlockType::TERMINATE, "", "", "", "", Operand(), Operand(), false, decrement});
+}
+
+unsigned int BlockProgram::advance(const Operand& delay) {
+    return this->add(Block {BlockType::ADVANCE, "", "", "", "", delay, Operand(), false, 0});
+}
+
+unsigned int BlockProgram::test(const Operand& condition, const std::string& falseLabel) {
+    return this->add(Block {BlockType::TEST, "", "", falseLabel, "", condition, Operand(), false, 0});
+}
+
+unsigned int BlockProgram::transfer(const std::string& label) {
+    return this->add(Block {BlockType::TRANSFER, "", "", label, "", Operand(), Operand(), false, 0});
+}
+
+unsigned int BlockProgram::assign(const std::string& paramName, const Operand& value) {
+    return this->add(Block {BlockType::ASSIGN, "", paramName, "", "", value, Operand(), false, 0});
+}
+
+unsigned int BlockProgram::enter(const std::string& storageName, unsigned int numbOfChannels) {
+    return this->add(Block {BlockType::ENTER, "", storageName, "", "", Operand(), Operand(), false, numbOfChannels});
+}
+
+unsigned int BlockProgram::leave(const std::string& storageName, unsigned int numbOfChannels) {
+    return this->add(Block {BlockType::LEAVE, "", storageName, "", "", Operand(), Operand(), false, numbOfChannels});
+}
+
+unsigned int BlockProgram::queue(const std::string& queueName) {
+    return this->add(Block {BlockType::QUEUE, "", queueName, "", "", Operand(), Operand(), false, 0});
+}
+
+unsigned int BlockProgram::depart(const std::string& queueName) {
+    return this->add(Block {BlockType::DEPART, "", queueName, "", "", Operand(), Operand(), false, 0});
+}
+
+unsigned int BlockProgram::link(const std::string& linkName, const std::string& discipline) {
+    return this->add(Block {BlockType::LINK, "", linkName, "", discipline, Operand(), Operand(), false, 0});
+}
+
+unsigned int BlockProgram::unlink(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans) {
+    return this->add(Block {BlockType::UNLINK, "", linkName, label, "", Operand(), Operand(), false, numbReleasedTrans});
+}
+
+unsigned int BlockProgram::tabulate(const std::string& tableName, unsigned int weight) {
+    return this->add(Block {BlockType::TABULATE, "", tableName, "", "", Operand(), Operand(), false, weight});
+}
+
+unsigned int BlockProgram::unlinkBack(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans) {
+    return this->add(Block {BlockType::UNLINK, "", linkName, label, "BACK", Operand(), Operand(), false, numbReleasedTrans});
+}
+
+unsigned int BlockProgram::unlink(const std::string& linkName, const std::string& label, unsigned int numbReleasedTrans, \
+    const std::string& paramName, const Operand& value) {
+    return this->add(Block {BlockType::UNLINK, "", linkName, label, paramName, value, Operand(), false, numbReleasedTrans});
+}
+
+std::string BlockProgram::getBlockName(BlockType type) {
+    switch (type) {
+        case BlockType::GENERATE: return "GENERATE";
+        case BlockType::TERMINATE: return "TERMINATE";
+        case BlockType::ADVANCE: return "ADVANCE";
+        case BlockType::TEST: return "TEST";
+        case BlockType::TRANSFER: return "TRANSFER";
+        case BlockType::ASSIGN: return "ASSIGN";
+        case BlockType::ENTER: return "ENTER";
+        case BlockType::LEAVE: return "LEAVE";
+        case BlockType::QUEUE: return "QUEUE";
+        case BlockType::DEPART: return "DEPART";
+        case BlockType::LINK: return "LINK";
+        case BlockType::UNLINK: return "UNLINK";
+        case BlockType::TABULATE: return "TABULATE";
+    }
+    return "UNKNOWN";
+}
+
+std::string BlockProgram::getAsString() const {
+    std::string listing;
+    for (unsigned int i = 0; i < _blocks.size(); i++) {
+        const Block& block = _blocks[i];
+        std::string operands = block.entity;
+        if (!block.discipline.empty()) {
+            operands += ',' + block.discipline;
+        }
+        if (!block.target.empty()) {
+            operands += (operands.empty() ? "" : ",") + block.target;
+        }
+        if (block.count != 0) {
+            operands += (operands.empty() ? "" : ",") + std::to_string(block.count);
+        }
+        listing += std::to_string(i + 1) + '\t' + block.label + '\t' + getBlockName(block.type) + '\t' + operands + '\n';
+    }
+    return listing;
+}
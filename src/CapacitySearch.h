@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Replications.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//DOMINATED points are decided by a decided point without runs of their own
+enum class Feasibility { UNKNOWN, FEASIBLE, INFEASIBLE, DOMINATED };
+
+//one capacity per searched storage, estimates are over the replications made at the point
+struct DesignPoint {
+    std::vector<unsigned int> capacities;
+    double cost;
+    Feasibility feasibility;
+    unsigned int runsNumb;
+    std::vector<QueueEstimates> queueEstimates;
+    std::vector<StorageEstimates> storageEstimates;
+};
+
+//cheapest storage capacities whose queues keep AVE.CONT. at or below a bound,
+//assuming that adding capacity never increases queue content:
+//- design points of the grid are tried in the order of cost, a batch of the cheapest undecided points in parallel
+//- a point gets replications until the confidence intervals of AVE.CONT. decide it or maxRuns is reached
+//- a feasible point makes every point above it feasible, an infeasible one makes every point below it infeasible
+//the confidence level is the one of every single interval: there is no correction for testing several queues,
+//many points and repeated looks at the same point, so a search makes some wrong decision more often than 1 - confidence;
+//for a bound on that chance pass a stricter level, e.g. 1 - (1 - confidence) / tests (Bonferroni)
+class CapacitySearch {
+    private:
+        const std::string _modelName;
+        const std::function<void(SimCPP&, const std::vector<unsigned int>&)> _model; //runs one replication with the given capacities
+        std::vector<std::pair<unsigned int,unsigned int>> _ranges; //min and max capacity per storage
+        std::vector<double> _costs; //of one channel per storage
+        std::vector<std::string> _queueNames; //constrained queues, all when empty
+        double _maxAveCont;
+        double _confidence;
+        unsigned int _initialRuns, _runsStep, _maxRuns;
+        unsigned int _threadsNumb;
+        uint64_t _baseSeed;
+        std::vector<DesignPoint> _points; //ordered by cost
+
+        void evaluate(DesignPoint& point); //sequential replications of one point
+        Feasibility decide(const std::vector<QueueEstimates>& queueEstimates, bool lastRuns);
+        static bool dominates(const DesignPoint& upper, const DesignPoint& lower); //no capacity of upper is below the one of lower
+    public:
+        //0 threads is one per hardware thread
+        CapacitySearch(const std::string& modelName, const std::function<void(SimCPP&, const std::vector<unsigned int>&)>& model, \
+            const std::vector<std::pair<unsigned int,unsigned int>>& ranges, unsigned int threadsNumb = 0);
+
+        void setCosts(const std::vector<double>& costs); //nonnegative, one per searched storage
+        //an unknown queue name throws at the first evaluation
+        void setConstraint(double maxAveCont, const std::vector<std::string>& queueNames = {}) { _maxAveCont = maxAveCont; _queueNames = queueNames; }
+        void setConfidence(double confidence) { _confidence = confidence; } //of each interval, without a multiple testing correction
+        void setRuns(unsigned int initialRuns, unsigned int runsStep, unsigned int maxRuns);
+        void setBaseSeed(uint64_t baseSeed) { _baseSeed = baseSeed; } //every point uses the same seeds (common random numbers)
+
+        DesignPoint search(); //throws if no point of the grid is feasible
+        const std::vector<DesignPoint>& getPoints() { return _points; }
+        unsigned int getEvaluatedNumb();
+        unsigned long getRunsNumb();
+        static std::string getDesignPointString(const DesignPoint& point, double confidence = 0.95);
+};
+
+//-----
+
+CapacitySearch::CapacitySearch(const std::string& modelName, const std::function<void(SimCPP&, const std::vector<unsigned int>&)>& model, \
+    const std::vector<std::pair<unsigned int,unsigned int>>& ranges, unsigned int threadsNumb): _modelName(modelName), _model(model), _ranges(ranges), \
+    _costs(ranges.size(), 1.), _maxAveCont(2.), _confidence(0.95), _initialRuns(10), _runsStep(10), _maxRuns(100), _threadsNumb(threadsNumb), _baseSeed(0) {
+    if (_threadsNumb == 0) {
+        _threadsNumb = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::for_each(_ranges.begin(), _ranges.end(), [](const std::pair<unsigned int,unsigned int>& range) {
+        if (range.first == 0 || range.first > range.second) {
+            throw std::logic_error("Capacity range must be a nonempty range of positive capacities");
+        }
+    });
+}
+
+void CapacitySearch::setCosts(const std::vector<double>& costs) {
+    if (costs.size() != _ranges.size()) {
+        throw std::logic_error("Capacity search needs one cost per searched storage");
+    }
+    //the pruning takes the points above a feasible one for costlier, a negative cost would make them cheaper
+    std::for_each(costs.begin(), costs.end(), [](double cost) {
+        if (!(cost >= 0) || std::isinf(cost)) {
+            throw std::logic_error("Cost of a channel must be a finite nonnegative number, it is " + std::to_string(cost));
+        }
+    });
+    _costs = costs;
+}
+
+void CapacitySearch::setRuns(unsigned int initialRuns, unsigned int runsStep, unsigned int maxRuns) {
+    if (initialRuns < 2 || runsStep == 0 || maxRuns < initialRuns) {
+        throw std::logic_error("Capacity search needs at least 2 initial runs, a positive step and maxRuns not below initialRuns");
+    }
+    _initialRuns = initialRuns;
+    _runsStep = runsStep;
+    _maxRuns = maxRuns;
+}
+
+bool CapacitySearch::dominates(const DesignPoint& upper, const DesignPoint& lower) {
+    for (unsigned int i = 0; i < upper.capacities.size(); i++) {
+        if (upper.capacities[i] < lower.capacities[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Feasibility CapacitySearch::decide(const std::vector<QueueEstimates>& queueEstimates, bool lastRuns) {
+    bool allBelow = true;
+    //a misspelt name would leave its queue unconstrained
+    std::for_each(_queueNames.begin(), _queueNames.end(), [&queueEstimates](const std::string& queueName) {
+        if (std::none_of(queueEstimates.begin(), queueEstimates.end(), [&queueName](const QueueEstimates& estimate){ return estimate.name == queueName; })) {
+            throw std::logic_error("Constrained queue \"" + queueName + "\" is not a queue of the model");
+        }
+    });
+    for (const QueueEstimates& estimate : queueEstimates) {
+        if (!_queueNames.empty() && std::find(_queueNames.begin(), _queueNames.end(), estimate.name) == _queueNames.end()) {
+            continue;
+        }
+        double mean = estimate.aveCont.getMean(), halfWidth = estimate.aveCont.getHalfWidth(_confidence);
+        if (lastRuns) {
+            allBelow = allBelow && mean <= _maxAveCont; //undecided at maxRuns, the mean decides
+        }
+        else if (mean - halfWidth > _maxAveCont) {
+            return Feasibility::INFEASIBLE;
+        }
+        else {
+            allBelow = allBelow && mean + halfWidth <= _maxAveCont;
+        }
+    }
+    if (allBelow) {
+        return Feasibility::FEASIBLE;
+    }
+    return lastRuns ? Feasibility::INFEASIBLE : Feasibility::UNKNOWN;
+}
+
+void CapacitySearch::evaluate(DesignPoint& point) {
+    const std::vector<unsigned int> capacities = point.capacities;
+    Replications replications(_modelName, [this, capacities](SimCPP& sim){ _model(sim, capacities); }, 1);
+
+    replications.run(_initialRuns, _baseSeed);
+    point.feasibility = this->decide(replications.getQueueEstimates(), _initialRuns >= _maxRuns);
+    while (point.feasibility == Feasibility::UNKNOWN) {
+        unsigned int runsNumb = std::min(_runsStep, _maxRuns - (unsigned int)replications.getRuns().size());
+        replications.run(runsNumb, _baseSeed);
+        point.feasibility = this->decide(replications.getQueueEstimates(), replications.getRuns().size() >= _maxRuns);
+    }
+
+    point.runsNumb = replications.getRuns().size();
+    point.queueEstimates = replications.getQueueEstimates();
+    point.storageEstimates = replications.getStorageEstimates();
+}
+
+DesignPoint CapacitySearch::search() {
+    std::vector<unsigned int> capacities;
+    std::vector<DesignPoint>::iterator firstUndecided;
+
+    //grid in the order of cost, ties in the order of capacities
+    _points.clear();
+    std::for_each(_ranges.begin(), _ranges.end(), [&capacities](const std::pair<unsigned int,unsigned int>& range){ capacities.push_back(range.first); });
+    while (true) {
+        double cost = 0;
+        for (unsigned int i = 0; i < capacities.size(); i++) {
+            cost += _costs[i] * capacities[i];
+        }
+        _points.push_back(DesignPoint {capacities, cost, Feasibility::UNKNOWN, 0, {}, {}});
+
+        unsigned int i = 0;
+        while (i < capacities.size() && capacities[i] == _ranges[i].second) {
+            capacities[i] = _ranges[i].first;
+            i++;
+        }
+        if (i == capacities.size()) {
+            break;
+        }
+        capacities[i]++;
+    }
+    std::stable_sort(_points.begin(), _points.end(), [](const DesignPoint& first, const DesignPoint& second){ return first.cost < second.cost; });
+
+    while (true) {
+        //the cheapest point not known to be infeasible is the answer once it is feasible
+        firstUndecided = std::find_if(_points.begin(), _points.end(), [](const DesignPoint& point) \
+            { return point.feasibility != Feasibility::INFEASIBLE && point.feasibility != Feasibility::DOMINATED; });
+        if (firstUndecided == _points.end()) {
+            throw std::logic_error("No feasible capacities in the searched ranges");
+        }
+        if (firstUndecided->feasibility == Feasibility::FEASIBLE) {
+            return *firstUndecided;
+        }
+
+        std::vector<DesignPoint*> batch;
+        for (std::vector<DesignPoint>::iterator pointIt = firstUndecided; pointIt != _points.end() && batch.size() < _threadsNumb; pointIt++) {
+            if (pointIt->feasibility == Feasibility::UNKNOWN) {
+                batch.push_back(&*pointIt);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(batch.size());
+        for (unsigned int i = 1; i < batch.size(); i++) {
+            threads.emplace_back([this, &batch, &errors, i]() {
+                try { this->evaluate(*batch[i]); } catch (...) { errors[i] = std::current_exception(); }
+            });
+        }
+        try { this->evaluate(*batch[0]); } catch (...) { errors[0] = std::current_exception(); }
+        std::for_each(threads.begin(), threads.end(), [](std::thread& thread){ thread.join(); });
+        std::for_each(errors.begin(), errors.end(), [](std::exception_ptr& error){ if (error) { std::rethrow_exception(error); } });
+
+        //monotone pruning, a dominated feasible point is only costlier
+        std::for_each(batch.begin(), batch.end(), [this](DesignPoint* decided) {
+            std::for_each(_points.begin(), _points.end(), [decided](DesignPoint& point) {
+                if (point.feasibility != Feasibility::UNKNOWN) {
+                    return;
+                }
+                if (decided->feasibility == Feasibility::FEASIBLE && dominates(point, *decided)) {
+                    point.feasibility = Feasibility::DOMINATED;
+                }
+                else if (decided->feasibility == Feasibility::INFEASIBLE && dominates(*decided, point)) {
+                    point.feasibility = Feasibility::DOMINATED;
+                }
+            });
+        });
+    }
+}
+
+unsigned int CapacitySearch::getEvaluatedNumb() {
+    return std::count_if(_points.begin(), _points.end(), [](const DesignPoint& point){ return point.runsNumb > 0; });
+}
+
+unsigned long CapacitySearch::getRunsNumb() {
+    unsigned long runsNumb = 0;
+    std::for_each(_points.begin(), _points.end(), [&runsNumb](const DesignPoint& point){ runsNumb += point.runsNumb; });
+    return runsNumb;
+}
+
+std::string CapacitySearch::getDesignPointString(const DesignPoint& point, double confidence) {
+    std::string message = "capacities:";
+    std::for_each(point.capacities.begin(), point.capacities.end(), [&message](unsigned int capacity){ message += ' ' + std::to_string(capacity); });
+    message += "; cost: " + std::to_string(point.cost) + "; runs: " + std::to_string(point.runsNumb);
+
+    message += "\nQUEUE\t\tAVE.CONT.";
+    std::for_each(point.queueEstimates.begin(), point.queueEstimates.end(), [&message, confidence](const QueueEstimates& estimate) \
+        { message += '\n' + estimate.name + '\t' + estimate.aveCont.getString(confidence); });
+    message += "\nSTORAGE\t\tUTIL.";
+    std::for_each(point.storageEstimates.begin(), point.storageEstimates.end(), [&message, confidence](const StorageEstimates& estimate) \
+        { message += '\n' + estimate.name + '\t' + estimate.util.getString(confidence); });
+    return message;
+}
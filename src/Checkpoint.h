@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//binary snapshot of a model state, SimCPP::save writes it and SimCPP::restore reads it back:
+//every entity writes its own state and reads it in the same order; values are written as they are in memory,
+//so a snapshot is read by a build for the same platform. A string is its length and characters,
+//a vector is its size and elements
+
+#define CHECKPOINT_MAGIC "SIMCPPCK"
+#define CHECKPOINT_VERSION 2 //of the SimCPP state layout
+
+class CheckpointWriter {
+    private:
+        std::ostream& _stream;
+    public:
+        CheckpointWriter(std::ostream& stream): _stream(stream) {}
+
+        template <class T>
+        void write(const T& value);
+        void write(const std::string& value);
+        template <class T>
+        void write(const std::vector<T>& values);
+};
+
+class CheckpointReader {
+    private:
+        std::istream& _stream;
+
+        void check(); //throws if the stream has ended
+    public:
+        CheckpointReader(std::istream& stream): _stream(stream) {}
+
+        template <class T>
+        void read(T& value);
+        void read(std::string& value);
+        template <class T>
+        void read(std::vector<T>& values);
+        template <class T>
+        T get() { T value; this->read(value); return value; }
+};
+
+//-----
+
+template <class T>
+void CheckpointWriter::write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are written as they are");
+    _stream.write((const char*)&value, sizeof(T));
+}
+
+void CheckpointWriter::write(const std::string& value) {
+    uint64_t size = value.size();
+    this->write(size);
+    _stream.write(value.data(), size);
+}
+
+template <class T>
+void CheckpointWriter::write(const std::vector<T>& values) {
+    uint64_t size = values.size();
+    this->write(size);
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        _stream.write((const char*)values.data(), size * sizeof(T));
+    }
+    else {
+        for (const T& value : values) {
+            this->write(value);
+        }
+    }
+}
+
+void CheckpointReader::check() {
+    if (!_stream) {
+        throw std::logic_error("Checkpoint is truncated or cannot be read");
+    }
+}
+
+template <class T>
+void CheckpointReader::read(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are read as they are");
+    _stream.read((char*)&value, sizeof(T));
+    this->check();
+}
+
+void CheckpointReader::read(std::string& value) {
+    uint64_t size = this->get<uint64_t>();
+    value.assign(size, ' ');
+    _stream.read(&value[0], size);
+    this->check();
+}
+
+template <class T>
+void CheckpointReader::read(std::vector<T>& values) {
+    uint64_t size = this->get<uint64_t>();
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        values.resize(size);
+        _stream.read((char*)values.data(), size * sizeof(T));
+        this->check();
+    }
+    else {
+        values.clear();
+        for (uint64_t i = 0; i < size; i++) {
+            values.push_back(this->get<T>());
+        }
+    }
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "RandomStreams.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+//running mean and variance of independent observations (Welford), estimators of parallel runs are merged (Chan et al.)
+class Estimator {
+    private:
+        unsigned long _numb;
+        double _mean;
+        double _sumSqDev; //sum of squared deviations from the mean
+    public:
+        Estimator(): _numb(0), _mean(0), _sumSqDev(0) {}
+
+        void add(double value);
+        void add(double value, unsigned long count); //count observations of the value at once
+        void merge(const Estimator& estimator);
+
+        unsigned long getNumb() const { return _numb; }
+        double getMean() const { return _numb > 0 ? _mean : NAN; }
+        double getVariance() const { return _numb > 1 ? _sumSqDev / (_numb - 1) : NAN; } //sample variance
+        double getStdDev() const { return std::sqrt(this->getVariance()); }
+        double getHalfWidth(double confidence = 0.95) const; //of the Student-t confidence interval of the mean, infinite below 2 observations
+        std::string getString(double confidence = 0.95) const; //"mean +- half width"
+
+        static double studentQuantile(double probability, unsigned long degrees); //P(T <= t) = probability
+};
+
+//nonoverlapping batch means of a stationary series, the means of large enough batches are taken as independent:
+//at most 2 * batchesNumb batches are kept, when they are full the adjacent pairs are merged and the batch size doubles,
+//so the memory is fixed and for any run length the estimate is over batchesNumb or more batches
+class BatchMeans {
+    private:
+        unsigned int _batchesNumb;
+        std::vector<double> _batchMeans; //of the full batches
+        unsigned long _batchSize; //observations per batch
+        double _batchSum; //of the open batch
+        unsigned long _batchNumb;
+    public:
+        BatchMeans(unsigned int batchesNumb = 10);
+
+        void add(double observation);
+        unsigned long getNumb() const { return _batchMeans.size() * _batchSize; } //observations in the full batches
+        unsigned int getBatchesNumb() const { return _batchMeans.size(); }
+        unsigned long getBatchSize() const { return _batchSize; }
+        unsigned int getMinBatchesNumb() const { return _batchesNumb; }
+        double getMean() const;
+        double getHalfWidth(double confidence = 0.95) const; //infinite below batchesNumb batches
+        double getRelativeHalfWidth(double confidence = 0.95) const { return this->getHalfWidth(confidence) / std::fabs(this->getMean()); }
+        double getLag1Correlation() const; //of the batch means, near 0 when they are independent
+        std::string getString(double confidence = 0.95) const; //"mean +- half width"
+
+        void save(CheckpointWriter& writer) const;
+        void restore(CheckpointReader& reader);
+};
+
+//MSER-5 warm-up truncation: observations are averaged in batches of 5, the truncation point
+//minimizes the marginal standard error of the mean of the remaining batches
+class MSER5 {
+    private:
+        static const unsigned int BATCH_SIZE = 5;
+
+        std::vector<double> _batchMeans;
+        double _batchSum;
+        unsigned int _batchNumb; //observations in the open batch
+    public:
+        MSER5(): _batchSum(0), _batchNumb(0) {}
+
+        void add(double observation);
+        unsigned long getNumb() { return _batchMeans.size() * BATCH_SIZE + _batchNumb; }
+        //observations to delete, -1 while the minimum is in the second half of the series (warm-up not over yet)
+        long getTruncation(unsigned int minBatches = 20);
+
+        void save(CheckpointWriter& writer) const;
+        void restore(CheckpointReader& reader);
+};
+
+//-----
+
+void Estimator::add(double value) {
+    double delta = value - _mean;
+    _numb++;
+    _mean += delta / _numb;
+    _sumSqDev += delta * (value - _mean);
+}
+
+void Estimator::add(double value, unsigned long count) {
+    if (count == 0) {
+        return;
+    }
+    unsigned long numb = _numb + count;
+    double delta = value - _mean;
+    _sumSqDev += delta * delta * _numb * count / numb;
+    _mean += delta * count / numb;
+    _numb = numb;
+}
+
+void Estimator::merge(const Estimator& estimator) {
+    if (estimator._numb == 0) {
+        return;
+    }
+    unsigned long numb = _numb + estimator._numb;
+    double delta = estimator._mean - _mean;
+    _sumSqDev += estimator._sumSqDev + delta * delta * _numb * estimator._numb / numb;
+    _mean += delta * estimator._numb / numb;
+    _numb = numb;
+}
+
+double Estimator::getHalfWidth(double confidence) const {
+    if (_numb < 2) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return studentQuantile(0.5 + confidence / 2, _numb - 1) * this->getStdDev() / std::sqrt((double)_numb);
+}
+
+std::string Estimator::getString(double confidence) const {
+    return std::to_string(this->getMean()) + " +- " + std::to_string(this->getHalfWidth(confidence));
+}
+
+double Estimator::studentQuantile(double probability, unsigned long degrees) {
+    //G.W. Hill, "Algorithm 396: Student's t-quantiles", P is the two tailed probability
+    if (probability <= 0 || probability >= 1 || degrees == 0) {
+        throw std::logic_error("Student quantile is defined for probabilities in (0;1) and positive degrees of freedom");
+    }
+    if (probability < 0.5) {
+        return -studentQuantile(1 - probability, degrees);
+    }
+    double P = 2 * (1 - probability), n = degrees;
+    double a, b, c, d, x, y;
+
+    if (degrees == 1) {
+        return std::cos(P * M_PI_2) / std::sin(P * M_PI_2);
+    }
+    if (degrees == 2) {
+        return std::sqrt(2 / (P * (2 - P)) - 2);
+    }
+
+    a = 1 / (n - 0.5);
+    b = 48 / (a * a);
+    c = ((20700 * a / b - 98) * a - 16) * a + 96.36;
+    d = ((94.5 / (b + c) - 3) / b + 1) * std::sqrt(a * M_PI_2) * n;
+    x = d * P;
+    y = std::pow(x, 2 / n);
+
+    if (y > 0.05 + a) {
+        //asymptotic inverse expansion about the normal
+        x = RandomStreams::stdNormal(1 - P / 2);
+        y = x * x;
+        if (n < 5) {
+            c += 0.3 * (n - 4.5) * (x + 0.6);
+        }
+        c = (((0.05 * d * x - 5) * x - 7) * x - 2) * x + b + c;
+        y = (((((0.4 * y + 6.3) * y + 36) * y + 94.5) / c - y - 3) / b + 1) * x;
+        y = a * y * y;
+        y = y > 0.002 ? std::exp(y) - 1 : 0.5 * y * y + y;
+    }
+    else {
+        y = ((1 / (((n + 6) / (n * y) - 0.089 * d - 0.822) * (n + 2) * 3) + 0.5 / (n + 4)) * y - 1) * (n + 1) / (n + 2) + 1 / y;
+    }
+    return std::sqrt(n * y);
+}
+
+BatchMeans::BatchMeans(unsigned int batchesNumb): _batchesNumb(batchesNumb), _batchSize(1), _batchSum(0), _batchNumb(0) {
+    if (batchesNumb < 2) {
+        throw std::logic_error("Batch means need at least two batches");
+    }
+    _batchMeans.reserve(2 * batchesNumb);
+}
+
+void BatchMeans::add(double observation) {
+    _batchSum += observation;
+    if (++_batchNumb < _batchSize) {
+        return;
+    }
+    _batchMeans.push_back(_batchSum / _batchSize);
+    _batchSum = 0;
+    _batchNumb = 0;
+    if (_batchMeans.size() == 2 * _batchesNumb) {
+        for (unsigned int i = 0; i < _batchesNumb; i++) {
+            _batchMeans[i] = (_batchMeans[2 * i] + _batchMeans[2 * i + 1]) / 2;
+        }
+        _batchMeans.resize(_batchesNumb);
+        _batchSize *= 2;
+    }
+}
+
+double BatchMeans::getMean() const {
+    Estimator estimator;
+    std::for_each(_batchMeans.begin(), _batchMeans.end(), [&estimator](double batchMean){ estimator.add(batchMean); });
+    return estimator.getMean();
+}
+
+double BatchMeans::getHalfWidth(double confidence) const {
+    if (_batchMeans.size() < _batchesNumb) {
+        return std::numeric_limits<double>::infinity();
+    }
+    Estimator estimator;
+    std::for_each(_batchMeans.begin(), _batchMeans.end(), [&estimator](double batchMean){ estimator.add(batchMean); });
+    return estimator.getHalfWidth(confidence);
+}
+
+double BatchMeans::getLag1Correlation() const {
+    unsigned long numb = _batchMeans.size();
+    if (numb < 3) {
+        return NAN;
+    }
+    double mean = this->getMean(), covariance = 0, variance = 0;
+    for (unsigned long i = 0; i < numb; i++) {
+        variance += (_batchMeans[i] - mean) * (_batchMeans[i] - mean);
+        covariance += i > 0 ? (_batchMeans[i] - mean) * (_batchMeans[i - 1] - mean) : 0;
+    }
+    return variance > 0 ? covariance / variance : NAN;
+}
+
+std::string BatchMeans::getString(double confidence) const {
+    return std::to_string(this->getMean()) + " +- " + std::to_string(this->getHalfWidth(confidence));
+}
+
+void BatchMeans::save(CheckpointWriter& writer) const {
+    writer.write(_batchesNumb);
+    writer.write(_batchMeans);
+    writer.write(_batchSize);
+    writer.write(_batchSum);
+    writer.write(_batchNumb);
+}
+
+void BatchMeans::restore(CheckpointReader& reader) {
+    reader.read(_batchesNumb);
+    reader.read(_batchMeans);
+    reader.read(_batchSize);
+    reader.read(_batchSum);
+    reader.read(_batchNumb);
+    _batchMeans.reserve(2 * _batchesNumb);
+}
+
+void MSER5::add(double observation) {
+    _batchSum += observation;
+    if (++_batchNumb == BATCH_SIZE) {
+        _batchMeans.push_back(_batchSum / BATCH_SIZE);
+        _batchSum = 0;
+        _batchNumb = 0;
+    }
+}
+
+long MSER5::getTruncation(unsigned int minBatches) {
+    unsigned long numb = _batchMeans.size();
+    if (numb < minBatches) {
+        return -1;
+    }
+
+    //suffix sums give MSER(d) = sum (Y_i - mean_d)^2 / (n - d)^2 over i >= d in O(1) per d
+    double sum = 0, sumSq = 0, bestMSER = std::numeric_limits<double>::infinity();
+    unsigned long best = 0;
+    std::vector<double> MSERs(numb);
+    for (unsigned long i = numb; i-- > 0;) {
+        sum += _batchMeans[i];
+        sumSq += _batchMeans[i] * _batchMeans[i];
+        unsigned long rest = numb - i;
+        MSERs[i] = (sumSq - sum * sum / rest) / ((double)rest * rest);
+    }
+    for (unsigned long d = 0; d <= numb / 2; d++) {
+        if (MSERs[d] < bestMSER) {
+            bestMSER = MSERs[d];
+            best = d;
+        }
+    }
+    //the last few batches always look stable, they are not trusted
+    for (unsigned long d = numb / 2 + 1; d + 5 <= numb; d++) {
+        if (MSERs[d] < bestMSER) {
+            return -1;
+        }
+    }
+    return best * BATCH_SIZE;
+}
+
+void MSER5::save(CheckpointWriter& writer) const {
+    writer.write(_batchMeans);
+    writer.write(_batchSum);
+    writer.write(_batchNumb);
+}
+
+void MSER5::restore(CheckpointReader& reader) {
+    reader.read(_batchMeans);
+    reader.read(_batchSum);
+    reader.read(_batchNumb);
+}
@@ -2,58 +2,85 @@
 
 #include "Transact.h"
 #include <algorithm>
+#include <iterator>
 #include <string>
-#include <list>
 
+//intrusive doubly linked chain, links live in the transacts so moving between chains never allocates
 class EventChain {
     friend class SimCPP;
     friend class Links;
+    friend class Storages;
 
     private:
-        std::list<Transact*> _evChain;
+        Transact* _head;
+        Transact* _tail;
+        unsigned int _size;
         const std::string _name;
-        bool _resetEvChain;
 
-        EventChain(const std::string name): _name(name) {_resetEvChain = false;}
+        EventChain(const std::string name): _head(nullptr), _tail(nullptr), _size(0), _name(name) {}
     public:
-        ~EventChain() {std::for_each(_evChain.begin(),_evChain.end(),[](Transact* transact){delete transact;});}
+        class iterator {
+            friend class EventChain;
+            private:
+                Transact* _transact;
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Transact*;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Transact**;
+                using reference = Transact*;
 
-        using iterator = std::list<Transact*>::iterator;
-        using const_iterator = std::list<Transact*>::const_iterator;
+                iterator(Transact* transact = nullptr): _transact(transact) {}
+                Transact* operator*() const { return _transact; }
+                iterator& operator++() { _transact = _transact->_chainNext; return *this; }
+                iterator operator++(int) { iterator prevIt = *this; _transact = _transact->_chainNext; return prevIt; }
+                bool operator==(const iterator& other) const { return _transact == other._transact; }
+                bool operator!=(const iterator& other) const { return _transact != other._transact; }
+        };
+        using const_iterator = iterator;
         
-        iterator begin() { return _evChain.begin(); }
-        iterator end() { return _evChain.end(); }
-        const_iterator cbegin() const { return _evChain.cbegin(); }
-        const_iterator cend() const { return _evChain.cend(); }
+        iterator begin() { return iterator(_head); }
+        iterator end() { return iterator(nullptr); }
+        const_iterator cbegin() const { return iterator(_head); }
+        const_iterator cend() const { return iterator(nullptr); }
 
         const std::string getName() { return _name; }
-        unsigned int size() { return _evChain.size(); }
-        bool needReset() { return _resetEvChain; }
-        void setReset(bool reset = true) { _resetEvChain = reset; }
-        EventChain::iterator emplace(EventChain::iterator evChainIt, Transact* transact) { return _evChain.emplace(evChainIt, transact); }
-        void eraseTrans(Transact* transact) { _evChain.erase(std::find(_evChain.begin(),_evChain.end(),transact)); }
-        void erase(EventChain::iterator evChainIt) { _evChain.erase(evChainIt); }
+        unsigned int size() { return _size; }
+        EventChain::iterator emplace(EventChain::iterator evChainIt, Transact* transact); //before evChainIt
+        void eraseTrans(Transact* transact);
+        void erase(EventChain::iterator evChainIt) { this->eraseTrans(*evChainIt); }
 
         //void clear();
-        EventChain::iterator skipBlocked(EventChain::iterator evChainIt); //if we cant move trans we skip it
         const std::string getAsString();
 };
 
 //-----
 
+EventChain::iterator EventChain::emplace(EventChain::iterator evChainIt, Transact* transact) {
+    Transact* next = *evChainIt;
+    Transact* prev = (next == nullptr) ? _tail : next->_chainPrev;
+
+    transact->_chainPrev = prev;
+    transact->_chainNext = next;
+    (prev == nullptr ? _head : prev->_chainNext) = transact;
+    (next == nullptr ? _tail : next->_chainPrev) = transact;
+    _size++;
+    return iterator(transact);
+}
+
+void EventChain::eraseTrans(Transact* transact) {
+    (transact->_chainPrev == nullptr ? _head : transact->_chainPrev->_chainNext) = transact->_chainNext;
+    (transact->_chainNext == nullptr ? _tail : transact->_chainNext->_chainPrev) = transact->_chainPrev;
+    transact->_chainPrev = transact->_chainNext = nullptr;
+    _size--;
+}
+
 const std::string EventChain::getAsString() {
     std::string evS {_name + ":   "};
-    std::list<Transact*>::iterator evIt = _evChain.begin();
-    while(evIt != _evChain.end()) {
+    EventChain::iterator evIt = this->begin();
+    while(evIt != this->end()) {
         evS += (*evIt)->getAsString() + ' ';
         evIt++;
     }
     return evS;
 }
-
-EventChain::iterator EventChain::skipBlocked(EventChain::iterator evChainIt) {
-    while((evChainIt != this->end()) && (*evChainIt)->isBlocked()) {
-        evChainIt++;
-    }
-    return evChainIt;
-}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//kinds of binary trace records, the numbers are part of the file format
+enum class TraceEvent : uint8_t {
+    NAME = 0, //entity name, the characters follow in value records
+    START = 1, RESET = 2, END = 3, PROMOTION = 4, //model events, PROMOTION moves a transact from FEC to CEC
+    INIT_GENERATE = 10, GENERATE = 11, TERMINATE = 12, ADVANCE = 13, TEST = 14, TRANSFER = 15, ASSIGN = 16,
+    ENTER = 17, LEAVE = 18, QUEUE = 19, DEPART = 20, LINK = 21, UNLINK = 22, UNLINKED = 23,
+    CHAIN_INSERT = 30, CHAIN_REMOVE = 31, //chain deltas, the chain is kind (FEC, CEC, LINK or DELAY) and entity
+    SNAPSHOT = 32, SNAPSHOT_END = 33 //all chains are cleared and refilled by the CHAIN_INSERT records in between
+};
+
+//entity kinds of handles in the records, DELAY is the delay chain of a storage
+enum class TraceEntity : uint8_t { NONE = 0, MODEL = 1, STORAGE = 2, QUEUE = 3, LINK = 4, PARAM = 5, FEC = 6, CEC = 7, DELAY = 8 };
+
+//fixed size record, meaning of value per event:
+//GENERATE birth time, INIT_GENERATE birth time, ADVANCE delay, TEST/TRANSFER/UNLINKED next block, ASSIGN parameter value,
+//ENTER/LEAVE channels (ENTER 0 is blocked), LINK order (FIFO 0, LIFO 1, 2 + parameter handle), UNLINK released transacts,
+//TERMINATE counter decrement, START counter, NAME length of the name,
+//CHAIN_INSERT event time for FEC and ID of the preceding transact for other chains (0 is the head)
+struct TraceRecord {
+    double modelTime;
+    double value;
+    uint64_t transactID;
+    uint32_t block;
+    uint16_t entity; //handle of the entity of the block
+    uint8_t type; //TraceEvent
+    uint8_t kind; //TraceEntity of NAME and chain records
+};
+
+static_assert(sizeof(TraceRecord) == 32, "Trace records must stay 32 bytes long");
+
+//binary event trace: the simulation thread puts records into a lock-free single producer ring,
+//a writer thread drains it to the file, a full ring makes the simulation wait, records are never lost
+class EventTrace {
+    private:
+        static constexpr char MAGIC[8] = {'S','I','M','C','P','P','T','R'};
+        static const uint32_t VERSION = 1;
+
+        std::ofstream _file;
+        std::vector<TraceRecord> _ring;
+        size_t _mask; //ring size - 1, the size is a power of 2
+        alignas(64) std::atomic<size_t> _head; //next record to write, simulation thread
+        alignas(64) std::atomic<size_t> _tail; //next record to drain, writer thread
+        std::atomic<bool> _closing;
+        std::thread _writer;
+        unsigned long _stallsNumb; //producer waits on a full ring
+
+        void push(const TraceRecord& record);
+        void drain();
+    public:
+        EventTrace(const std::string& fileName, unsigned int ringSize = 1 << 16);
+        ~EventTrace() { this->close(); }
+
+        void record(TraceEvent type, uint64_t transactID, unsigned int block, long double modelTime, unsigned int entity = 0, double value = 0);
+        void name(TraceEntity kind, unsigned int entity, const std::string& name);
+        void chain(TraceEvent type, TraceEntity chain, unsigned int chainId, uint64_t transactID, long double modelTime, double value = 0);
+        void close(); //drains the ring and closes the file, idempotent
+        unsigned long getRecordsNumb() { return _head.load(std::memory_order_relaxed); }
+        unsigned long getStallsNumb() { return _stallsNumb; }
+
+        static bool readHeader(std::ifstream& file); //for decoders, false if the file is not a trace
+        static std::string getEventName(TraceEvent type);
+};
+
+//-----
+
+constexpr char EventTrace::MAGIC[8];
+
+EventTrace::EventTrace(const std::string& fileName, unsigned int ringSize): _head(0), _tail(0), _closing(false), _stallsNumb(0) {
+    if (ringSize == 0 || (ringSize & (ringSize - 1)) != 0) {
+        throw std::logic_error("Trace ring size must be a power of 2");
+    }
+    _file.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!_file) {
+        throw std::logic_error("Cannot open the trace file \"" + fileName + '\"');
+    }
+    uint32_t version = VERSION, recordSize = sizeof(TraceRecord);
+    _file.write(MAGIC, sizeof(MAGIC));
+    _file.write((const char*)&version, sizeof(version));
+    _file.write((const char*)&recordSize, sizeof(recordSize));
+
+    _ring.resize(ringSize);
+    _mask = ringSize - 1;
+    _writer = std::thread([this](){ this->drain(); });
+}
+
+void EventTrace::push(const TraceRecord& record) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) > _mask) {
+        _stallsNumb++;
+        while (head - _tail.load(std::memory_order_acquire) > _mask) {
+            std::this_thread::yield();
+        }
+    }
+    _ring[head & _mask] = record;
+    _head.store(head + 1, std::memory_order_release);
+}
+
+void EventTrace::drain() {
+    while (true) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (_closing.load(std::memory_order_acquire) && _head.load(std::memory_order_acquire) == tail) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        //the ready part up to the end of the ring in one write
+        size_t numb = std::min(head - tail, _ring.size() - (tail & _mask));
+        _file.write((const char*)&_ring[tail & _mask], numb * sizeof(TraceRecord));
+        _tail.store(tail + numb, std::memory_order_release);
+    }
+    _file.flush();
+}
+
+void EventTrace::record(TraceEvent type, uint64_t transactID, unsigned int block, long double modelTime, unsigned int entity, double value) {
+    this->push(TraceRecord {(double)modelTime, value, transactID, block, (uint16_t)entity, (uint8_t)type, (uint8_t)TraceEntity::NONE});
+}
+
+void EventTrace::chain(TraceEvent type, TraceEntity chain, unsigned int chainId, uint64_t transactID, long double modelTime, double value) {
+    this->push(TraceRecord {(double)modelTime, value, transactID, 0, (uint16_t)chainId, (uint8_t)type, (uint8_t)chain});
+}
+
+void EventTrace::name(TraceEntity kind, unsigned int entity, const std::string& name) {
+    TraceRecord chars;
+    this->push(TraceRecord {0, (double)name.size(), 0, 0, (uint16_t)entity, (uint8_t)TraceEvent::NAME, (uint8_t)kind});
+    for (size_t pos = 0; pos < name.size(); pos += sizeof(TraceRecord)) {
+        std::memset(&chars, 0, sizeof(chars));
+        std::memcpy(&chars, name.data() + pos, std::min(sizeof(TraceRecord), name.size() - pos));
+        this->push(chars);
+    }
+}
+
+void EventTrace::close() {
+    if (_writer.joinable()) {
+        _closing.store(true, std::memory_order_release);
+        _writer.join();
+        _file.close();
+    }
+}
+
+bool EventTrace::readHeader(std::ifstream& file) {
+    char magic[sizeof(MAGIC)];
+    uint32_t version, recordSize;
+    file.read(magic, sizeof(magic));
+    file.read((char*)&version, sizeof(version));
+    file.read((char*)&recordSize, sizeof(recordSize));
+    return file && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION && recordSize == sizeof(TraceRecord);
+}
+
+std::string EventTrace::getEventName(TraceEvent type) {
+    switch (type) {
+        case TraceEvent::NAME: return "NAME";
+        case TraceEvent::START: return "START";
+        case TraceEvent::RESET: return "RESET";
+        case TraceEvent::END: return "END";
+        case TraceEvent::PROMOTION: return "PROMOTION";
+        case TraceEvent::INIT_GENERATE: return "INIT_GENERATE";
+        case TraceEvent::GENERATE: return "GENERATE";
+        case TraceEvent::TERMINATE: return "TERMINATE";
+        case TraceEvent::ADVANCE: return "ADVANCE";
+        case TraceEvent::TEST: return "TEST";
+        case TraceEvent::TRANSFER: return "TRANSFER";
+        case TraceEvent::ASSIGN: return "ASSIGN";
+        case TraceEvent::ENTER: return "ENTER";
+        case TraceEvent::LEAVE: return "LEAVE";
+        case TraceEvent::QUEUE: return "QUEUE";
+        case TraceEvent::DEPART: return "DEPART";
+        case TraceEvent::LINK: return "LINK";
+        case TraceEvent::UNLINK: return "UNLINK";
+        case TraceEvent::UNLINKED: return "UNLINKED";
+        case TraceEvent::CHAIN_INSERT: return "CHAIN_INSERT";
+        case TraceEvent::CHAIN_REMOVE: return "CHAIN_REMOVE";
+        case TraceEvent::SNAPSHOT: return "SNAPSHOT";
+        case TraceEvent::SNAPSHOT_END: return "SNAPSHOT_END";
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//instructions of compiled expressions, operands are taken from the stack
+enum class ExprOp : uint8_t {
+    CONST, AC1, C1, STORAGE_R, LINK_CH, QUEUE_Q, PARAM, VARIABLE, //push a value
+    NEG, TRUNC, //unary
+    ADD, SUB, MUL, DIV, IDIV, MOD, POW, E, NE, L, LE, G, GE, AND, OR, //binary, relations give 1 or 0
+    EXPONENTIAL, UNIFORM, NORMAL, TRIANGULAR, WEIBULL //random variates, the stream number is the first argument
+};
+
+//GPSS VARIABLE truncates the result to an integer, FVARIABLE does not, BVARIABLE gives 1 or 0
+enum class VariableType { VARIABLE, FVARIABLE, BVARIABLE };
+
+//GPSS World expression compiled once into postfix code, SNAs refer to entity names until SimCPP::bind
+//puts the entity handles and objects into the instructions, SimCPP::evaluate runs the code without any string handling
+class Expression {
+    friend class SimCPP;
+    public:
+        static const unsigned int MAX_DEPTH = 32; //of the evaluation stack
+
+        struct Instruction {
+            ExprOp op;
+            unsigned int handle; //entity of SNAs, index of _names before binding
+            long double value; //of CONST
+            const void* entity; //storage, user chain, queue or variable the instruction reads, set by binding
+        };
+    private:
+        std::vector<Instruction> _code;
+        std::vector<std::string> _names;
+        unsigned int _depth;
+        bool _bound;
+
+        class Parser;
+
+        void emit(ExprOp op, unsigned int handle = 0, long double value = 0); //folds constant arithmetic
+        void emitName(ExprOp op, const std::string& name);
+        void append(const Expression& expression);
+        void finish(); //computes the stack depth
+    public:
+        Expression(): _depth(0), _bound(false) {}
+        Expression(long double value): _depth(0), _bound(false) { this->emit(ExprOp::CONST, 0, value); this->finish(); }
+
+        //names without $ are EQU constants, V$, BV$ and FV$ copy the code of the given variables,
+        //other variables are SimCPP ones, referred to by handle
+        static Expression parse(const std::string& text, const std::unordered_map<std::string, long double>& constants = {}, \
+            const std::unordered_map<std::string, Expression>& variables = {});
+        static Expression parseVariable(const std::string& text, VariableType type, const std::unordered_map<std::string, long double>& constants = {}, \
+            const std::unordered_map<std::string, Expression>& variables = {});
+        static Expression combine(const Expression& first, ExprOp op, const Expression& second); //first op second
+        static Expression apply(ExprOp op, const Expression& expression); //unary op
+
+        bool empty() const { return _code.empty(); }
+        bool isBound() const { return _bound; }
+        bool isConstant() const { return _code.size() == 1 && _code[0].op == ExprOp::CONST; }
+        long double getConstant() const;
+        const std::vector<Instruction>& getCode() const { return _code; }
+        unsigned int getDepth() const { return _depth; }
+
+        static unsigned int getArgsNumb(ExprOp op);
+        static bool hasName(ExprOp op) { return op >= ExprOp::STORAGE_R && op <= ExprOp::VARIABLE; }
+        static long double calculate(ExprOp op, long double first, long double second); //binary operations
+};
+
+class Expression::Parser {
+    private:
+        enum class TokenType { NUMBER, NAME, OPERATOR, LEFT, RIGHT, COMMA, END };
+        struct Token {
+            TokenType type;
+            std::string text; //names as written, operators in upper case
+            long double value;
+        };
+
+        const std::string& _text;
+        const std::unordered_map<std::string, long double>& _constants;
+        const std::unordered_map<std::string, Expression>& _variables;
+        std::vector<Token> _tokens;
+        unsigned int _pos;
+        Expression& _expression;
+
+        void tokenize();
+        const Token& peek() { return _tokens[_pos]; }
+        bool isOperator(const std::string& text) { return this->peek().type == TokenType::OPERATOR && this->peek().text == text; }
+        void expect(TokenType type, const std::string& what);
+        [[noreturn]] void fail(const std::string& message);
+
+        void parseOr();
+        void parseAnd();
+        void parseRelation();
+        void parseSum();
+        void parseProduct();
+        void parsePower();
+        void parseUnary();
+        void parsePrimary();
+        void parseName(const std::string& name);
+    public:
+        Parser(const std::string& text, const std::unordered_map<std::string, long double>& constants, \
+            const std::unordered_map<std::string, Expression>& variables, Expression& expression): \
+            _text(text), _constants(constants), _variables(variables), _pos(0), _expression(expression) {}
+
+        void parse();
+};
+
+//-----
+
+unsigned int Expression::getArgsNumb(ExprOp op) {
+    switch (op) {
+        case ExprOp::CONST: case ExprOp::AC1: case ExprOp::C1: case ExprOp::STORAGE_R: case ExprOp::LINK_CH: case ExprOp::QUEUE_Q: case ExprOp::PARAM:
+        case ExprOp::VARIABLE:
+            return 0;
+        case ExprOp::NEG: case ExprOp::TRUNC:
+            return 1;
+        case ExprOp::EXPONENTIAL: case ExprOp::UNIFORM: case ExprOp::NORMAL:
+            return 3;
+        case ExprOp::TRIANGULAR: case ExprOp::WEIBULL:
+            return 4;
+        default:
+            return 2;
+    }
+}
+
+long double Expression::calculate(ExprOp op, long double first, long double second) {
+    switch (op) {
+        case ExprOp::ADD: return first + second;
+        case ExprOp::SUB: return first - second;
+        case ExprOp::MUL: return first * second;
+        case ExprOp::DIV: case ExprOp::IDIV: case ExprOp::MOD:
+            if (second == 0) {
+                throw std::logic_error("Division by zero in an expression");
+            }
+            return op == ExprOp::DIV ? first / second : (op == ExprOp::IDIV ? std::trunc(first / second) : std::fmod(first, second));
+        case ExprOp::POW: return std::pow(first, second);
+        case ExprOp::E: return first == second;
+        case ExprOp::NE: return first != second;
+        case ExprOp::L: return first < second;
+        case ExprOp::LE: return first <= second;
+        case ExprOp::G: return first > second;
+        case ExprOp::GE: return first >= second;
+        case ExprOp::AND: return first != 0 && second != 0;
+        case ExprOp::OR: return first != 0 || second != 0;
+        default: throw std::logic_error("Not a binary expression operation");
+    }
+}
+
+void Expression::emit(ExprOp op, unsigned int handle, long double value) {
+    unsigned int size = _code.size();
+
+    //arithmetic of constants is done once here, random variates are not constant;
+    //an operand ending with CONST is that single CONST
+    if (op == ExprOp::NEG && size >= 1 && _code[size - 1].op == ExprOp::CONST) {
+        _code[size - 1].value = -_code[size - 1].value;
+        return;
+    }
+    if (op == ExprOp::TRUNC && size >= 1 && _code[size - 1].op == ExprOp::CONST) {
+        _code[size - 1].value = std::trunc(_code[size - 1].value);
+        return;
+    }
+    if (getArgsNumb(op) == 2 && size >= 2 && _code[size - 2].op == ExprOp::CONST && _code[size - 1].op == ExprOp::CONST) {
+        _code[size - 2].value = calculate(op, _code[size - 2].value, _code[size - 1].value);
+        _code.pop_back();
+        return;
+    }
+    _code.push_back(Instruction {op, handle, value, nullptr});
+}
+
+void Expression::emitName(ExprOp op, const std::string& name) {
+    _names.push_back(name);
+    this->emit(op, _names.size() - 1);
+}
+
+void Expression::append(const Expression& expression) {
+    if (expression._bound) {
+        throw std::logic_error("A bound expression cannot be a part of another one");
+    }
+    unsigned int namesNumb = _names.size();
+    _names.insert(_names.end(), expression._names.begin(), expression._names.end());
+    std::for_each(expression._code.begin(), expression._code.end(), [this, namesNumb](const Instruction& instruction) \
+        { _code.push_back(Instruction {instruction.op, hasName(instruction.op) ? instruction.handle + namesNumb : instruction.handle, instruction.value, nullptr}); });
+}
+
+void Expression::finish() {
+    unsigned int size = 0;
+    _depth = 0;
+    std::for_each(_code.begin(), _code.end(), [this, &size](const Instruction& instruction) {
+        size = size - getArgsNumb(instruction.op) + 1;
+        _depth = std::max(_depth, size);
+    });
+    if (_depth > MAX_DEPTH) {
+        throw std::logic_error("Expression needs more than " + std::to_string(MAX_DEPTH) + " stack places");
+    }
+}
+
+long double Expression::getConstant() const {
+    if (!this->isConstant()) {
+        throw std::logic_error("Expression is not a constant");
+    }
+    return _code[0].value;
+}
+
+Expression Expression::parse(const std::string& text, const std::unordered_map<std::string, long double>& constants, \
+    const std::unordered_map<std::string, Expression>& variables) {
+    Expression expression;
+    Parser(text, constants, variables, expression).parse();
+    expression.finish();
+    return expression;
+}
+
+Expression Expression::parseVariable(const std::string& text, VariableType type, const std::unordered_map<std::string, long double>& constants, \
+    const std::unordered_map<std::string, Expression>& variables) {
+    Expression expression = parse(text, constants, variables);
+    if (type == VariableType::VARIABLE) {
+        return apply(ExprOp::TRUNC, expression);
+    }
+    if (type == VariableType::BVARIABLE) {
+        return combine(expression, ExprOp::NE, Expression(0));
+    }
+    return expression;
+}
+
+Expression Expression::combine(const Expression& first, ExprOp op, const Expression& second) {
+    Expression expression;
+    if (getArgsNumb(op) != 2) {
+        throw std::logic_error("Expressions are combined with a binary operation");
+    }
+    expression.append(first);
+    expression.append(second);
+    expression.emit(op);
+    expression.finish();
+    return expression;
+}
+
+Expression Expression::apply(ExprOp op, const Expression& operand) {
+    Expression expression;
+    if (getArgsNumb(op) != 1) {
+        throw std::logic_error("Not a unary expression operation");
+    }
+    expression.append(operand);
+    expression.emit(op);
+    expression.finish();
+    return expression;
+}
+
+//-----
+
+void Expression::Parser::fail(const std::string& message) {
+    throw std::logic_error("Expression \"" + _text + "\": " + message);
+}
+
+void Expression::Parser::tokenize() {
+    unsigned int pos = 0;
+    while (pos < _text.size()) {
+        char symbol = _text[pos];
+        if (std::isspace((unsigned char)symbol)) {
+            pos++;
+        }
+        else if (std::isdigit((unsigned char)symbol) || symbol == '.') {
+            unsigned int end = pos;
+            while (end < _text.size() && (std::isdigit((unsigned char)_text[end]) || _text[end] == '.')) {
+                end++;
+            }
+            //the whole run of digits and points is one number, "1.2.3" or a lone "." is not
+            std::string number = _text.substr(pos, end - pos);
+            std::size_t numberEnd = 0;
+            long double value = 0;
+            try {
+                value = std::stold(number, &numberEnd);
+            }
+            catch (const std::exception&) {
+                numberEnd = 0;
+            }
+            if (numberEnd != number.size()) {
+                this->fail("malformed number \"" + number + '\"');
+            }
+            _tokens.push_back(Token {TokenType::NUMBER, number, value});
+            pos = end;
+        }
+        else if (std::isalpha((unsigned char)symbol) || symbol == '_') {
+            unsigned int end = pos;
+            while (end < _text.size() && (std::isalnum((unsigned char)_text[end]) || _text[end] == '_' || _text[end] == '.' || _text[end] == '$')) {
+                end++;
+            }
+            _tokens.push_back(Token {TokenType::NAME, _text.substr(pos, end - pos), 0});
+            pos = end;
+        }
+        else if (symbol == '\'') {
+            //'NE', 'AND' and the like
+            std::string::size_type end = _text.find('\'', pos + 1);
+            if (end == std::string::npos) {
+                this->fail("unclosed quote");
+            }
+            std::string op = _text.substr(pos + 1, end - pos - 1);
+            std::for_each(op.begin(), op.end(), [](char& letter){ letter = std::toupper((unsigned char)letter); });
+            _tokens.push_back(Token {TokenType::OPERATOR, op, 0});
+            pos = end + 1;
+        }
+        else if (symbol == '<' || symbol == '>') {
+            std::string op = symbol == '<' ? "L" : "G";
+            if (pos + 1 < _text.size() && _text[pos + 1] == '=') {
+                op += 'E';
+                pos++;
+            }
+            else if (symbol == '<' && pos + 1 < _text.size() && _text[pos + 1] == '>') {
+                op = "NE";
+                pos++;
+            }
+            _tokens.push_back(Token {TokenType::OPERATOR, op, 0});
+            pos++;
+        }
+        else {
+            switch (symbol) {
+                case '(': _tokens.push_back(Token {TokenType::LEFT, "(", 0}); break;
+                case ')': _tokens.push_back(Token {TokenType::RIGHT, ")", 0}); break;
+                case ',': _tokens.push_back(Token {TokenType::COMMA, ",", 0}); break;
+                case '=': _tokens.push_back(Token {TokenType::OPERATOR, "E", 0}); break;
+                case '&': _tokens.push_back(Token {TokenType::OPERATOR, "AND", 0}); break;
+                case '|': _tokens.push_back(Token {TokenType::OPERATOR, "OR", 0}); break;
+                case '*': _tokens.push_back(Token {TokenType::OPERATOR, "#", 0}); break;
+                case '+': case '-': case '#': case '/': case '\\': case '@': case '^':
+                    _tokens.push_back(Token {TokenType::OPERATOR, std::string(1, symbol), 0});
+                    break;
+                default:
+                    this->fail(std::string("unexpected symbol '") + symbol + '\'');
+            }
+            pos++;
+        }
+    }
+    _tokens.push_back(Token {TokenType::END, "", 0});
+}
+
+void Expression::Parser::expect(TokenType type, const std::string& what) {
+    if (this->peek().type != type) {
+        this->fail(what + " is expected");
+    }
+    _pos++;
+}
+
+void Expression::Parser::parse() {
+    this->tokenize();
+    this->parseOr();
+    if (this->peek().type != TokenType::END) {
+        this->fail("unexpected \"" + this->peek().text + '\"');
+    }
+}
+
+void Expression::Parser::parseOr() {
+    this->parseAnd();
+    while (this->isOperator("OR")) {
+        _pos++;
+        this->parseAnd();
+        _expression.emit(ExprOp::OR);
+    }
+}
+
+void Expression::Parser::parseAnd() {
+    this->parseRelation();
+    while (this->isOperator("AND")) {
+        _pos++;
+        this->parseRelation();
+        _expression.emit(ExprOp::AND);
+    }
+}
+
+void Expression::Parser::parseRelation() {
+    static const std::unordered_map<std::string, ExprOp> relations {{"E", ExprOp::E}, {"NE", ExprOp::NE}, {"L", ExprOp::L}, \
+        {"LE", ExprOp::LE}, {"G", ExprOp::G}, {"GE", ExprOp::GE}};
+    this->parseSum();
+    while (this->peek().type == TokenType::OPERATOR && relations.find(this->peek().text) != relations.end()) {
+        ExprOp op = relations.at(_tokens[_pos++].text);
+        this->parseSum();
+        _expression.emit(op);
+    }
+}
+
+void Expression::Parser::parseSum() {
+    this->parseProduct();
+    while (this->isOperator("+") || this->isOperator("-")) {
+        ExprOp op = _tokens[_pos++].text == "+" ? ExprOp::ADD : ExprOp::SUB;
+        this->parseProduct();
+        _expression.emit(op);
+    }
+}
+
+void Expression::Parser::parseProduct() {
+    static const std::unordered_map<std::string, ExprOp> products {{"#", ExprOp::MUL}, {"/", ExprOp::DIV}, {"\\", ExprOp::IDIV}, {"@", ExprOp::MOD}};
+    this->parsePower();
+    while (this->peek().type == TokenType::OPERATOR && products.find(this->peek().text) != products.end()) {
+        ExprOp op = products.at(_tokens[_pos++].text);
+        this->parsePower();
+        _expression.emit(op);
+    }
+}
+
+void Expression::Parser::parsePower() {
+    this->parseUnary();
+    if (this->isOperator("^")) {
+        _pos++;
+        this->parsePower(); //right associative
+        _expression.emit(ExprOp::POW);
+    }
+}
+
+void Expression::Parser::parseUnary() {
+    if (this->isOperator("-")) {
+        _pos++;
+        this->parseUnary();
+        _expression.emit(ExprOp::NEG);
+    }
+    else if (this->isOperator("+")) {
+        _pos++;
+        this->parseUnary();
+    }
+    else {
+        this->parsePrimary();
+    }
+}
+
+void Expression::Parser::parsePrimary() {
+    const Token token = this->peek();
+    _pos++;
+    switch (token.type) {
+        case TokenType::NUMBER:
+            _expression.emit(ExprOp::CONST, 0, token.value);
+            break;
+        case TokenType::LEFT:
+            this->parseOr();
+            this->expect(TokenType::RIGHT, "\")\"");
+            break;
+        case TokenType::NAME:
+            this->parseName(token.text);
+            break;
+        default:
+            this->fail("an operand is expected instead of \"" + token.text + '\"');
+    }
+}
+
+void Expression::Parser::parseName(const std::string& name) {
+    static const std::unordered_map<std::string, ExprOp> functions {{"EXPONENTIAL", ExprOp::EXPONENTIAL}, {"UNIFORM", ExprOp::UNIFORM}, \
+        {"NORMAL", ExprOp::NORMAL}, {"TRIANGULAR", ExprOp::TRIANGULAR}, {"WEIBULL", ExprOp::WEIBULL}};
+    static const std::unordered_map<std::string, ExprOp> SNAs {{"R", ExprOp::STORAGE_R}, {"CH", ExprOp::LINK_CH}, {"Q", ExprOp::QUEUE_Q}, {"P", ExprOp::PARAM}};
+    std::string upperName = name;
+    std::for_each(upperName.begin(), upperName.end(), [](char& letter){ letter = std::toupper((unsigned char)letter); });
+    std::string::size_type dollar = name.find('$');
+
+    if (this->peek().type == TokenType::LEFT) {
+        if (functions.find(upperName) == functions.end()) {
+            this->fail("unknown library function \"" + name + '\"');
+        }
+        ExprOp op = functions.at(upperName);
+        _pos++;
+        for (unsigned int i = 0; i < getArgsNumb(op); i++) {
+            if (i > 0) {
+                this->expect(TokenType::COMMA, "\",\" of " + upperName);
+            }
+            this->parseOr();
+        }
+        this->expect(TokenType::RIGHT, "\")\" of " + upperName);
+        _expression.emit(op);
+    }
+    else if (dollar != std::string::npos) {
+        std::string SNA = upperName.substr(0, dollar), entity = name.substr(dollar + 1);
+        if (SNA == "V" || SNA == "BV" || SNA == "FV") {
+            if (_variables.find(entity) != _variables.end()) {
+                _expression.append(_variables.at(entity));
+            }
+            else {
+                _expression.emitName(ExprOp::VARIABLE, entity);
+            }
+        }
+        else if (SNAs.find(SNA) != SNAs.end() && !entity.empty()) {
+            _expression.emitName(SNAs.at(SNA), entity);
+        }
+        else {
+            this->fail("unsupported SNA \"" + name + '\"');
+        }
+    }
+    else if (upperName == "AC1") {
+        _expression.emit(ExprOp::AC1);
+    }
+    else if (upperName == "C1") {
+        _expression.emit(ExprOp::C1);
+    }
+    else if (upperName == "M1") {
+        //transit time, parameter M1 is the mark time
+        _expression.emit(ExprOp::AC1);
+        _expression.emitName(ExprOp::PARAM, "M1");
+        _expression.emit(ExprOp::SUB);
+    }
+    else if (_constants.find(name) != _constants.end()) {
+        _expression.emit(ExprOp::CONST, 0, _constants.at(name));
+    }
+    else {
+        this->fail("unknown name \"" + name + '\"');
+    }
+}
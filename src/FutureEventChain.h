@@ -0,0 +1,411 @@
+#pragma once
+
+#include "Transact.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <list>
+
+//FEC engines, selectable per SimCPP instance
+enum class FECType { LIST, BINARY_HEAP, CALENDAR_QUEUE, LADDER_QUEUE };
+
+class FutureEventChain {
+    friend class SimCPP;
+
+    protected:
+        struct Entry {
+            long double time;
+            unsigned long long seq; //insertion number, GPSS FIFO order on equal time
+            Transact* transact;
+            bool operator<(const Entry& other) const { return time < other.time || (time == other.time && seq < other.seq); }
+            bool operator>(const Entry& other) const { return other < *this; }
+        };
+
+        const std::string _name;
+        unsigned long long _seqNumb;
+
+        FutureEventChain(const std::string name): _name(name), _seqNumb(0) {}
+        Entry makeEntry(Transact* transact) { return Entry {transact->getTime(), _seqNumb++, transact}; }
+        virtual void collect(std::vector<Entry>& entries) = 0; //all entries in any order
+    public:
+        virtual ~FutureEventChain() {}
+        static FutureEventChain* create(FECType type, const std::string name = "FEC");
+
+        virtual void push(Transact* transact) = 0;
+        virtual Transact* top() = 0; //transact with the least time, FIFO among equals
+        virtual void pop() = 0;
+        virtual unsigned long size() = 0;
+
+        bool empty() { return this->size() == 0; }
+        const std::string getName() { return _name; }
+        std::vector<Transact*> getOrdered();
+        const std::string getAsString();
+};
+
+//the original linear-scan chain, O(n) insertion
+class ListFEC: public FutureEventChain {
+    private:
+        std::list<Entry> _chain;
+    protected:
+        void collect(std::vector<Entry>& entries) override { entries.insert(entries.end(), _chain.begin(), _chain.end()); }
+    public:
+        ListFEC(const std::string name): FutureEventChain(name) {}
+
+        void push(Transact* transact) override;
+        Transact* top() override { return _chain.front().transact; }
+        void pop() override { _chain.pop_front(); }
+        unsigned long size() override { return _chain.size(); }
+};
+
+class BinaryHeapFEC: public FutureEventChain {
+    private:
+        std::vector<Entry> _heap;
+    protected:
+        void collect(std::vector<Entry>& entries) override { entries.insert(entries.end(), _heap.begin(), _heap.end()); }
+    public:
+        BinaryHeapFEC(const std::string name): FutureEventChain(name) {}
+
+        void push(Transact* transact) override;
+        Transact* top() override { return _heap.front().transact; }
+        void pop() override;
+        unsigned long size() override { return _heap.size(); }
+};
+
+//R. Brown calendar queue, O(1) average with bucket width re-estimation on resize
+class CalendarQueueFEC: public FutureEventChain {
+    private:
+        std::vector<std::vector<Entry>> _buckets; //every bucket sorted descending, minimum at back
+        long double _width;
+        long long _currYearBucket; //virtual number of current bucket = floor(time / _width)
+        unsigned long _size;
+
+        long long virtualBucket(long double time) { return (long long)std::min<long double>(std::floor(time / _width), 4e18); } //far events share the last year
+        std::vector<Entry>& bucketOf(long long virtualBucket) { return _buckets[(unsigned long)(virtualBucket % (long long)_buckets.size())]; }
+        void insert(const Entry& entry);
+        void resize(unsigned long bucketsNumb);
+        long long locateMin();
+    protected:
+        void collect(std::vector<Entry>& entries) override;
+    public:
+        CalendarQueueFEC(const std::string name): FutureEventChain(name), _buckets(2), _width(1.0), _currYearBucket(0), _size(0) {}
+
+        void push(Transact* transact) override;
+        Transact* top() override;
+        void pop() override;
+        unsigned long size() override { return _size; }
+};
+
+//W.T. Tang, R.S.M. Goh, I.L.J. Thng ladder queue: unsorted top, ladder of bucket rungs, sorted bottom;
+//an event goes to the first rung from the top whose bucket of the event is not drained yet, the bucket number
+//does not decrease with time (out of range times are in the first or the last bucket), so everything below
+//a rung is earlier than the rest of it whatever the rounding of the bucket bounds is
+class LadderQueueFEC: public FutureEventChain {
+    private:
+        static const unsigned int THRES = 50; //max bucket size sorted directly into bottom
+        static const unsigned int MAX_RUNGS = 8; //deeper buckets are sorted into bottom whatever their size
+
+        struct Rung {
+            long double start;
+            long double width; //positive
+            unsigned long curr; //first not drained bucket
+            unsigned long count;
+            std::vector<std::vector<Entry>> buckets;
+            unsigned long bucketOf(long double time);
+        };
+
+        std::vector<Entry> _top;
+        long double _topMin, _topMax, _topStart;
+        std::vector<Rung> _rungs;
+        std::vector<Entry> _bottom; //sorted descending, minimum at back
+        unsigned long _size;
+
+        bool spawnRung(std::vector<Entry>& entries); //false if the times are too close for buckets, entries are left then
+        void insertToRung(Rung& rung, const Entry& entry);
+        void insertToBottom(const Entry& entry);
+        void refillBottom();
+    protected:
+        void collect(std::vector<Entry>& entries) override;
+    public:
+        LadderQueueFEC(const std::string name): FutureEventChain(name), _topMin(0), _topMax(0), _topStart(0), _size(0) {}
+
+        void push(Transact* transact) override;
+        Transact* top() override;
+        void pop() override;
+        unsigned long size() override { return _size; }
+};
+
+//-----
+
+FutureEventChain* FutureEventChain::create(FECType type, const std::string name) {
+    switch (type) {
+        case FECType::LIST: return new ListFEC(name);
+        case FECType::BINARY_HEAP: return new BinaryHeapFEC(name);
+        case FECType::CALENDAR_QUEUE: return new CalendarQueueFEC(name);
+        case FECType::LADDER_QUEUE: return new LadderQueueFEC(name);
+    }
+    throw std::logic_error("Unknown future event chain type");
+}
+
+std::vector<Transact*> FutureEventChain::getOrdered() {
+    std::vector<Entry> entries;
+    std::vector<Transact*> ordered;
+    this->collect(entries);
+    std::sort(entries.begin(), entries.end());
+    std::for_each(entries.begin(), entries.end(), [ &ordered ](const Entry& entry){ ordered.push_back(entry.transact); });
+    return ordered;
+}
+
+const std::string FutureEventChain::getAsString() {
+    std::string evS {_name + ":   "};
+    std::vector<Transact*> ordered = this->getOrdered();
+    std::for_each(ordered.begin(), ordered.end(), [ &evS ](Transact* transact){ evS += transact->getAsString() + ' '; });
+    return evS;
+}
+
+//-----
+
+void ListFEC::push(Transact* transact) {
+    Entry entry = this->makeEntry(transact);
+    _chain.emplace(std::find_if(_chain.begin(), _chain.end(), [ &entry ](const Entry& chainEntry){ return entry < chainEntry; }), entry);
+}
+
+//-----
+
+void BinaryHeapFEC::push(Transact* transact) {
+    _heap.push_back(this->makeEntry(transact));
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+}
+
+void BinaryHeapFEC::pop() {
+    std::pop_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+    _heap.pop_back();
+}
+
+//-----
+
+void CalendarQueueFEC::insert(const Entry& entry) {
+    std::vector<Entry>& bucket = this->bucketOf(this->virtualBucket(entry.time));
+    bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), entry, std::greater<Entry>()), entry);
+    _size++;
+}
+
+void CalendarQueueFEC::push(Transact* transact) {
+    Entry entry = this->makeEntry(transact);
+    if (_size == 0 || this->virtualBucket(entry.time) < _currYearBucket) {
+        _currYearBucket = this->virtualBucket(entry.time);
+    }
+    this->insert(entry);
+    if (_size > 2 * _buckets.size()) {
+        this->resize(2 * _buckets.size());
+    }
+}
+
+long long CalendarQueueFEC::locateMin() {
+    //scan one year of buckets, then fall back to direct search of the minimum
+    for (unsigned long i = 0; i < _buckets.size(); i++) {
+        std::vector<Entry>& bucket = this->bucketOf(_currYearBucket);
+        if (!bucket.empty() && this->virtualBucket(bucket.back().time) <= _currYearBucket) {
+            return _currYearBucket;
+        }
+        _currYearBucket++;
+    }
+
+    const Entry* minEntry = nullptr;
+    std::for_each(_buckets.begin(), _buckets.end(), [ &minEntry ](std::vector<Entry>& bucket) \
+        { if (!bucket.empty() && (minEntry == nullptr || bucket.back() < *minEntry)) minEntry = &bucket.back(); });
+    _currYearBucket = this->virtualBucket(minEntry->time);
+    return _currYearBucket;
+}
+
+Transact* CalendarQueueFEC::top() {
+    if (_size == 0) {
+        throw std::logic_error("Future event chain \"" + _name + "\" is empty");
+    }
+    return this->bucketOf(this->locateMin()).back().transact;
+}
+
+void CalendarQueueFEC::pop() {
+    if (_size == 0) {
+        throw std::logic_error("Future event chain \"" + _name + "\" is empty");
+    }
+    this->bucketOf(this->locateMin()).pop_back();
+    _size--;
+    if (_buckets.size() > 2 && _size < _buckets.size() / 2) {
+        this->resize(_buckets.size() / 2);
+    }
+}
+
+void CalendarQueueFEC::resize(unsigned long bucketsNumb) {
+    std::vector<Entry> entries;
+    std::vector<long double> separations;
+    long double avSeparation = 0;
+    unsigned long sampleSize;
+
+    this->collect(entries);
+
+    //new bucket width is three average separations of the nearest events (large gaps dropped)
+    sampleSize = std::min<unsigned long>(entries.size(), 25);
+    std::partial_sort(entries.begin(), entries.begin() + sampleSize, entries.end());
+    for (unsigned long i = 1; i < sampleSize; i++) {
+        separations.push_back(entries[i].time - entries[i-1].time);
+        avSeparation += separations.back();
+    }
+    if (!separations.empty()) {
+        avSeparation /= separations.size();
+        long double cutSum = 0;
+        unsigned long cutNumb = 0;
+        std::for_each(separations.begin(), separations.end(), [ avSeparation,&cutSum,&cutNumb ](long double separation) \
+            { if (separation <= 2 * avSeparation) { cutSum += separation; cutNumb++; } });
+        if (cutNumb != 0 && cutSum > 0) {
+            _width = 3 * cutSum / cutNumb;
+        }
+    }
+
+    _buckets.assign(bucketsNumb, std::vector<Entry>());
+    _size = 0;
+    _currYearBucket = entries.empty() ? 0 : this->virtualBucket(entries.front().time);
+    std::for_each(entries.begin(), entries.end(), [ this ](const Entry& entry){ this->insert(entry); });
+}
+
+void CalendarQueueFEC::collect(std::vector<Entry>& entries) {
+    std::for_each(_buckets.begin(), _buckets.end(), [ &entries ](std::vector<Entry>& bucket) \
+        { entries.insert(entries.end(), bucket.begin(), bucket.end()); });
+}
+
+//-----
+
+void LadderQueueFEC::push(Transact* transact) {
+    Entry entry = this->makeEntry(transact);
+    _size++;
+
+    if (entry.time >= _topStart) {
+        if (_top.empty()) {
+            _topMin = _topMax = entry.time;
+        }
+        _topMin = std::min(_topMin, entry.time);
+        _topMax = std::max(_topMax, entry.time);
+        _top.push_back(entry);
+        return;
+    }
+
+    for (unsigned long i = 0; i < _rungs.size(); i++) {
+        if (_rungs[i].bucketOf(entry.time) >= _rungs[i].curr) {
+            this->insertToRung(_rungs[i], entry);
+            return;
+        }
+    }
+    this->insertToBottom(entry);
+}
+
+unsigned long LadderQueueFEC::Rung::bucketOf(long double time) {
+    long double position = std::floor((time - start) / width);
+    if (position <= 0) {
+        return 0;
+    }
+    return position >= buckets.size() - 1 ? buckets.size() - 1 : (unsigned long)position;
+}
+
+void LadderQueueFEC::insertToRung(Rung& rung, const Entry& entry) {
+    rung.buckets[rung.bucketOf(entry.time)].push_back(entry);
+    rung.count++;
+}
+
+void LadderQueueFEC::insertToBottom(const Entry& entry) {
+    _bottom.insert(std::upper_bound(_bottom.begin(), _bottom.end(), entry, std::greater<Entry>()), entry);
+
+    //an overgrown bottom is converted into the deepest rung
+    if (_bottom.size() > 4 * THRES && _rungs.size() < MAX_RUNGS) {
+        this->spawnRung(_bottom);
+    }
+}
+
+bool LadderQueueFEC::spawnRung(std::vector<Entry>& entries) {
+    long double minTime = entries.front().time, maxTime = minTime;
+    std::for_each(entries.begin(), entries.end(), [&minTime, &maxTime](const Entry& entry) \
+        { minTime = std::min(minTime, entry.time); maxTime = std::max(maxTime, entry.time); });
+    long double width = (maxTime - minTime) / entries.size();
+    if (!(width > 0) || minTime + width == minTime) {
+        return false;
+    }
+
+    Rung rung;
+    rung.start = minTime;
+    rung.width = width;
+    rung.curr = 0;
+    rung.count = 0;
+    rung.buckets.resize(entries.size() + 1);
+    _rungs.push_back(rung);
+    std::for_each(entries.begin(), entries.end(), [ this ](const Entry& entry){ this->insertToRung(_rungs.back(), entry); });
+    entries.clear();
+    return true;
+}
+
+void LadderQueueFEC::refillBottom() {
+    while (_bottom.empty()) {
+        //top is moved to the first rung when the ladder is empty
+        if (_rungs.empty()) {
+            if (_top.empty()) {
+                return;
+            }
+            _topStart = _topMax;
+            std::vector<Entry> entries;
+            entries.swap(_top);
+            if (!this->spawnRung(entries)) {
+                _bottom.swap(entries);
+                std::sort(_bottom.begin(), _bottom.end(), std::greater<Entry>());
+                return;
+            }
+        }
+
+        Rung& rung = _rungs.back();
+        while (rung.curr < rung.buckets.size() && rung.buckets[rung.curr].empty()) {
+            rung.curr++;
+        }
+        if (rung.count == 0 || rung.curr == rung.buckets.size()) {
+            _rungs.pop_back();
+            continue;
+        }
+
+        std::vector<Entry> bucket;
+        bucket.swap(rung.buckets[rung.curr]);
+        rung.count -= bucket.size();
+        rung.curr++;
+        //an exhausted rung is dropped at once, it would only take a place of the ladder
+        if (rung.count == 0) {
+            _rungs.pop_back();
+        }
+
+        if (bucket.size() > THRES && _rungs.size() < MAX_RUNGS && this->spawnRung(bucket)) {
+            continue;
+        }
+        _bottom.swap(bucket);
+        std::sort(_bottom.begin(), _bottom.end(), std::greater<Entry>());
+    }
+}
+
+Transact* LadderQueueFEC::top() {
+    if (_size == 0) {
+        throw std::logic_error("Future event chain \"" + _name + "\" is empty");
+    }
+    if (_bottom.empty()) {
+        this->refillBottom();
+    }
+    return _bottom.back().transact;
+}
+
+void LadderQueueFEC::pop() {
+    this->top();
+    _bottom.pop_back();
+    _size--;
+}
+
+void LadderQueueFEC::collect(std::vector<Entry>& entries) {
+    entries.insert(entries.end(), _top.begin(), _top.end());
+    std::for_each(_rungs.begin(), _rungs.end(), [ &entries ](Rung& rung) \
+        { std::for_each(rung.buckets.begin(), rung.buckets.end(), [ &entries ](std::vector<Entry>& bucket) \
+            { entries.insert(entries.end(), bucket.begin(), bucket.end()); }); });
+    entries.insert(entries.end(), _bottom.begin(), _bottom.end());
+}
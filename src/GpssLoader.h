@@ -0,0 +1,344 @@
+#pragma once
+
+#include "BlockProgram.h"
+#include "Expression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//plain-text GPSS World models compiled into a BlockProgram, the subset SimCPP supports:
+//    EQU, STORAGE, VARIABLE, FVARIABLE, BVARIABLE, TABLE, QTABLE, START and the blocks of BlockProgram,
+//    operands are expressions over R$, CH$, Q$, P$, V$, FV$, BV$, AC1, C1, M1 and EXPONENTIAL, UNIFORM, NORMAL, TRIANGULAR, WEIBULL;
+//    tables get the quantile sketch of BlockProgram::table
+//a label starts in the first column, ';' starts a comment, so does the text after the operands
+class GpssLoader {
+    private:
+        BlockProgram _program;
+        std::unordered_map<std::string, long double> _constants; //EQU
+        std::unordered_map<std::string, Expression> _variables; //their code is copied into the referring expressions
+        unsigned int _startCount;
+        unsigned int _lineNumb;
+
+        void parseLine(const std::string& line);
+        void parseStatement(const std::string& label, const std::string& keyword, const std::string& relation, const std::vector<std::string>& operands);
+        Expression getExpression(const std::vector<std::string>& operands, unsigned int i, const std::string& defaultText = "");
+        //a time operand (GENERATE, ADVANCE), a constant one must be finite and nonnegative, the others are checked as they are computed
+        Expression getTime(const std::vector<std::string>& operands, unsigned int i, const std::string& defaultText = "");
+        unsigned int getConstant(const std::vector<std::string>& operands, unsigned int i, unsigned int defaultValue);
+        long double getNumber(const std::vector<std::string>& operands, unsigned int i); //a constant of any sign
+        std::string getName(const std::vector<std::string>& operands, unsigned int i, const std::string& what);
+        [[noreturn]] void fail(const std::string& message);
+
+        static std::vector<std::string> splitFields(const std::string& line); //by blanks outside parentheses and quotes
+        static std::vector<std::string> splitOperands(const std::string& field); //by commas outside parentheses
+        static std::string toUpper(std::string text);
+    public:
+        GpssLoader(): _startCount(0), _lineNumb(0) {}
+
+        void load(std::istream& source); //statements are added to the program
+        void loadFile(const std::string& fileName);
+        const BlockProgram& getProgram() const { return _program; }
+        unsigned int getStartCount() const { return _startCount; } //A of the last START, 0 without one
+};
+
+//-----
+
+std::string GpssLoader::toUpper(std::string text) {
+    std::for_each(text.begin(), text.end(), [](char& letter){ letter = std::toupper((unsigned char)letter); });
+    return text;
+}
+
+void GpssLoader::fail(const std::string& message) {
+    throw std::logic_error("GPSS model line " + std::to_string(_lineNumb) + ": " + message);
+}
+
+std::vector<std::string> GpssLoader::splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string field;
+    int depth = 0;
+    bool quoted = false;
+    for (char symbol : line) {
+        if (std::isspace((unsigned char)symbol) && depth == 0 && !quoted) {
+            if (!field.empty()) {
+                fields.push_back(field);
+                field.clear();
+            }
+            continue;
+        }
+        if (symbol == '\'') {
+            quoted = !quoted;
+        }
+        depth += symbol == '(' ? 1 : (symbol == ')' ? -1 : 0);
+        field += symbol;
+    }
+    if (!field.empty()) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+std::vector<std::string> GpssLoader::splitOperands(const std::string& field) {
+    std::vector<std::string> operands(1);
+    int depth = 0;
+    for (char symbol : field) {
+        if (symbol == ',' && depth == 0) {
+            operands.emplace_back();
+            continue;
+        }
+        depth += symbol == '(' ? 1 : (symbol == ')' ? -1 : 0);
+        operands.back() += symbol;
+    }
+    return operands;
+}
+
+void GpssLoader::loadFile(const std::string& fileName) {
+    std::ifstream source(fileName);
+    if (!source) {
+        throw std::logic_error("Cannot open the GPSS model \"" + fileName + '\"');
+    }
+    this->load(source);
+}
+
+void GpssLoader::load(std::istream& source) {
+    std::string line;
+    while (std::getline(source, line)) {
+        _lineNumb++;
+        this->parseLine(line);
+    }
+}
+
+void GpssLoader::parseLine(const std::string& rawLine) {
+    static const std::vector<std::string> keywords {"EQU", "STORAGE", "VARIABLE", "FVARIABLE", "BVARIABLE", "TABLE", "QTABLE", "START", "GENERATE", "TERMINATE", \
+        "ADVANCE", "TEST", "TRANSFER", "ASSIGN", "ENTER", "LEAVE", "QUEUE", "DEPART", "LINK", "UNLINK", "TABULATE"};
+    std::string line = rawLine.substr(0, rawLine.find(';'));
+    std::string label, keyword, relation;
+    unsigned int pos = 0;
+
+    line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+    if (line.empty() || line[0] == '*') {
+        return;
+    }
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.empty()) {
+        return;
+    }
+    if (!std::isspace((unsigned char)line[0])) {
+        label = fields[pos++];
+    }
+    if (pos == fields.size()) {
+        this->fail("statement is expected after the label \"" + label + '\"');
+    }
+    keyword = toUpper(fields[pos++]);
+    if (std::find(keywords.begin(), keywords.end(), keyword) == keywords.end()) {
+        this->fail("unsupported statement \"" + keyword + '\"');
+    }
+    if (keyword == "TEST") {
+        if (pos == fields.size()) {
+            this->fail("TEST needs a relation (E, NE, L, LE, G, GE)");
+        }
+        relation = toUpper(fields[pos++]);
+    }
+    //the text after the operand field is a comment
+    this->parseStatement(label, keyword, relation, pos < fields.size() ? splitOperands(fields[pos]) : std::vector<std::string>(1));
+}
+
+Expression GpssLoader::getExpression(const std::vector<std::string>& operands, unsigned int i, const std::string& defaultText) {
+    std::string text = i < operands.size() ? operands[i] : "";
+    if (text.empty()) {
+        if (defaultText.empty()) {
+            this->fail("operand " + std::string(1, 'A' + i) + " is required");
+        }
+        text = defaultText;
+    }
+    try {
+        return Expression::parse(text, _constants, _variables);
+    }
+    catch (const std::logic_error& error) {
+        this->fail(error.what());
+    }
+}
+
+Expression GpssLoader::getTime(const std::vector<std::string>& operands, unsigned int i, const std::string& defaultText) {
+    Expression expression = this->getExpression(operands, i, defaultText);
+    if (expression.isConstant() && (!(expression.getConstant() >= 0) || std::isinf(expression.getConstant()))) {
+        this->fail("operand " + std::string(1, 'A' + i) + " must be a finite nonnegative time");
+    }
+    return expression;
+}
+
+unsigned int GpssLoader::getConstant(const std::vector<std::string>& operands, unsigned int i, unsigned int defaultValue) {
+    if (i >= operands.size() || operands[i].empty()) {
+        return defaultValue;
+    }
+    Expression expression = this->getExpression(operands, i);
+    if (!expression.isConstant() || expression.getConstant() < 0) {
+        this->fail("operand " + std::string(1, 'A' + i) + " must be a nonnegative constant");
+    }
+    return (unsigned int)expression.getConstant();
+}
+
+long double GpssLoader::getNumber(const std::vector<std::string>& operands, unsigned int i) {
+    Expression expression = this->getExpression(operands, i);
+    if (!expression.isConstant()) {
+        this->fail("operand " + std::string(1, 'A' + i) + " must be a constant");
+    }
+    return expression.getConstant();
+}
+
+std::string GpssLoader::getName(const std::vector<std::string>& operands, unsigned int i, const std::string& what) {
+    if (i >= operands.size() || operands[i].empty()) {
+        this->fail("operand " + std::string(1, 'A' + i) + " must be the name of a " + what);
+    }
+    return operands[i];
+}
+
+void GpssLoader::parseStatement(const std::string& label, const std::string& keyword, const std::string& relation, \
+    const std::vector<std::string>& operands) {
+    static const std::unordered_map<std::string, ExprOp> relations {{"E", ExprOp::E}, {"NE", ExprOp::NE}, {"L", ExprOp::L}, \
+        {"LE", ExprOp::LE}, {"G", ExprOp::G}, {"GE", ExprOp::GE}};
+
+    //definitions, the label is the name
+    if (keyword == "EQU" || keyword == "STORAGE" || keyword == "VARIABLE" || keyword == "FVARIABLE" || keyword == "BVARIABLE" \
+        || keyword == "TABLE" || keyword == "QTABLE") {
+        if (label.empty()) {
+            this->fail(keyword + " needs a name in the label field");
+        }
+        if (keyword == "EQU") {
+            Expression value = this->getExpression(operands, 0);
+            if (!value.isConstant()) {
+                this->fail("EQU value must be a constant");
+            }
+            _constants[label] = value.getConstant();
+        }
+        else if (keyword == "STORAGE") {
+            _program.storage(label, this->getConstant(operands, 0, 0));
+        }
+        else if (keyword == "TABLE" || keyword == "QTABLE") {
+            long double upperLimit = this->getNumber(operands, 1), width = this->getNumber(operands, 2);
+            unsigned int classesNumb = this->getConstant(operands, 3, 0);
+            if (width <= 0 || classesNumb < 2) {
+                this->fail(keyword + " needs a positive class width (C) and at least two frequency classes (D)");
+            }
+            keyword == "TABLE" ? _program.table(label, this->getExpression(operands, 0), upperLimit, width, classesNumb) \
+                : _program.qtable(label, this->getName(operands, 0, "queue"), upperLimit, width, classesNumb);
+        }
+        else {
+            VariableType type = keyword == "VARIABLE" ? VariableType::VARIABLE : (keyword == "FVARIABLE" ? VariableType::FVARIABLE : VariableType::BVARIABLE);
+            try {
+                _variables[label] = Expression::parseVariable(this->getName(operands, 0, "expression"), type, _constants, _variables);
+            }
+            catch (const std::logic_error& error) {
+                this->fail(error.what());
+            }
+        }
+        return;
+    }
+    if (keyword == "START") {
+        _startCount = this->getConstant(operands, 0, 0);
+        if (_startCount == 0) {
+            this->fail("START needs a positive termination count");
+        }
+        return;
+    }
+
+    //blocks
+    if (!label.empty()) {
+        _program.label(label);
+    }
+    if (keyword == "GENERATE") {
+        if (operands.size() > 1 && !operands[1].empty() && operands[1] != "0") {
+            this->fail("GENERATE spread (B) is not supported, use a distribution in A");
+        }
+        if (operands.size() > 2 && !operands[2].empty()) {
+            _program.generate(this->getTime(operands, 0, "0"), this->getTime(operands, 2), this->getConstant(operands, 3, 0));
+        }
+        else {
+            //without an offset the first transact comes after an interval
+            Expression interval = this->getTime(operands, 0, "0");
+            _program.generate(interval, interval, this->getConstant(operands, 3, 0));
+        }
+    }
+    else if (keyword == "TERMINATE") {
+        _program.terminate(this->getConstant(operands, 0, 0));
+    }
+    else if (keyword == "ADVANCE") {
+        if (operands.size() > 1 && !operands[1].empty()) {
+            this->fail("ADVANCE spread (B) is not supported, use a distribution in A");
+        }
+        _program.advance(this->getTime(operands, 0, "0"));
+    }
+    else if (keyword == "TEST") {
+        if (relations.find(relation) == relations.end()) {
+            this->fail("unknown TEST relation \"" + relation + '\"');
+        }
+        _program.test(Expression::combine(this->getExpression(operands, 0), relations.at(relation), this->getExpression(operands, 1)), \
+            this->getName(operands, 2, "block (TEST without C waits, which is not supported)"));
+    }
+    else if (keyword == "TRANSFER") {
+        if (!operands[0].empty()) {
+            this->fail("only unconditional TRANSFER ,B is supported");
+        }
+        _program.transfer(this->getName(operands, 1, "block"));
+    }
+    else if (keyword == "ASSIGN") {
+        std::string paramName = this->getName(operands, 0, "parameter");
+        if (paramName.back() == '+' || paramName.back() == '-') {
+            this->fail("ASSIGN A+ and A- are not supported");
+        }
+        _program.assign(paramName, this->getExpression(operands, 1));
+    }
+    else if (keyword == "ENTER" || keyword == "LEAVE") {
+        std::string storageName = this->getName(operands, 0, "storage");
+        unsigned int numbOfChannels = this->getConstant(operands, 1, 1);
+        keyword == "ENTER" ? _program.enter(storageName, numbOfChannels) : _program.leave(storageName, numbOfChannels);
+    }
+    else if (keyword == "QUEUE" || keyword == "DEPART") {
+        if (operands.size() > 1 && !operands[1].empty()) {
+            this->fail(keyword + " B is not supported, every transact counts as one");
+        }
+        keyword == "QUEUE" ? _program.queue(this->getName(operands, 0, "queue")) : _program.depart(this->getName(operands, 0, "queue"));
+    }
+    else if (keyword == "TABULATE") {
+        _program.tabulate(this->getName(operands, 0, "table"), this->getConstant(operands, 1, 1));
+    }
+    else if (keyword == "LINK") {
+        std::string discipline = this->getName(operands, 1, "discipline (FIFO, LIFO or a parameter)");
+        if (toUpper(discipline) == "FIFO" || toUpper(discipline) == "LIFO") {
+            discipline = toUpper(discipline);
+        }
+        else if (toUpper(discipline.substr(0, 2)) == "P$") {
+            discipline = discipline.substr(2);
+        }
+        if (operands.size() > 2 && !operands[2].empty()) {
+            this->fail("LINK C is not supported");
+        }
+        _program.link(this->getName(operands, 0, "user chain"), discipline);
+    }
+    else if (keyword == "UNLINK") {
+        unsigned int numbReleasedTrans = operands.size() > 2 && toUpper(operands[2]) == "ALL" ? std::numeric_limits<unsigned int>::max() \
+            : this->getConstant(operands, 2, std::numeric_limits<unsigned int>::max());
+        std::string selection = operands.size() > 3 ? operands[3] : "";
+        if (operands.size() > 5 && !operands[5].empty()) {
+            this->fail("UNLINK F is not supported");
+        }
+        if (selection.empty()) {
+            _program.unlink(this->getName(operands, 0, "user chain"), this->getName(operands, 1, "block"), numbReleasedTrans);
+        }
+        else if (toUpper(selection) == "BACK") {
+            _program.unlinkBack(this->getName(operands, 0, "user chain"), this->getName(operands, 1, "block"), numbReleasedTrans);
+        }
+        else {
+            //without E the parameter is compared with the one of the active transact
+            std::string paramName = toUpper(selection.substr(0, 2)) == "P$" ? selection.substr(2) : selection;
+            _program.unlink(this->getName(operands, 0, "user chain"), this->getName(operands, 1, "block"), numbReleasedTrans, paramName, \
+                this->getExpression(operands, 4, "P$" + paramName));
+        }
+    }
+}
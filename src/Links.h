@@ -2,65 +2,182 @@
 
 #include "Transact.h"
 #include "EventChain.h"
+#include "SymbolTable.h"
+#include "Checkpoint.h"
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+//statistics of a user chain as GPSS prints them, NaN where the report shows "------"
+struct LinkStat {
+    std::string name;
+    unsigned long cont; //SIZE
+    unsigned long maxCont; //MAX
+    unsigned long entries; //ENTRIES
+    long double aveCont; //AVE.CONT.
+    long double aveTime; //AVE.TIME, transacts still in the chain count as leaving at the time of the statistics
+};
+
 class Links {
     friend class SimCPP;
     private:
         class Link;
-        std::vector<Link*> _links;
+        std::vector<Link*> _links; //indexed by LinkId
+        SymbolTable<LinkId> _names;
+        std::vector<Transact*> _releasedTrans; //reused by every unlink
         Links(){};
+        EventChain& getChain(LinkId linkId);
     public:
+        ~Links();
+
+        LinkId getId(const std::string& linkName); //user chain is created at the first reference, gpss style
+        const std::string& getName(LinkId linkId) { return _names.getName(linkId); }
         std::string getAsString();
-        void link(Transact* transact, const std::string linkName, const std::string discipline);
-        std::vector<Transact*> unlink(const std::string linkName, const unsigned int numbReleasedTrans);
-        unsigned int getLinkParam(const std::string linkName, const std::string SNA);
+        void link(Transact* transact, LinkId linkId, LinkOrder order, ParamId paramId = ParamId {0}); //at the time of the transact
+        //PARAM releases the transacts with the paramId parameter equal to value
+        const std::vector<Transact*>& unlink(LinkId linkId, const unsigned int numbReleasedTrans, long double currTime, \
+            UnlinkFrom from = UnlinkFrom::HEAD, ParamId paramId = ParamId {0}, long double value = 0);
+        unsigned int getLinkParam(LinkId linkId, SNA attribute);
+        long double getArea(LinkId linkId, long double time); //integral of the chain size from the last reset to time
+        void reset(long double resetTime); //GPSS RESET, transacts in the chains stay
+        std::vector<LinkStat> getFinalStats(long double endModelTime); //the model can go on
+        static std::string getFinalStatString(const std::vector<LinkStat>& linkStats);
+        //of one user chain, its transacts are saved by SimCPP and put back at the end of the chain before restoreIndex
+        void save(LinkId linkId, CheckpointWriter& writer);
+        void restore(LinkId linkId, CheckpointReader& reader);
+        void restoreIndex(LinkId linkId);
 };
 
+//a chain filled by one parameter discipline only is indexed by a skip list on (parameter, insertion number):
+//ordered LINK and the removal of any transact are O(log n), UNLINK of the head is O(1);
+//another discipline drops the index until the chain is empty, the chain order stays right with linear insertion
 class Links::Link {
     private:
         EventChain _link;
+        Transact* _skipHeads[SKIP_LEVELS - 1]; //first transacts of the upper levels
+        bool _indexed;
+        ParamId _indexParam;
+        unsigned long _linkSeq;
+        uint64_t _levelState; //xorshift of the skip list levels, the model streams are not touched
+
+        //statistics as of Queues::Queue, a transact enters at its time of LINK
+        unsigned long _numbEntries;
+        unsigned long _maxLength;
+        long double _cumSumCont; //AVE.CONT. = _cumSumCont / measured time
+        long double _cumSumTime; //of the unlinked transacts
+        long double _prevLinkTime;
+        long double _resetTime; //earlier entries count as made at it
+        long double _sumEntryTime; //of the transacts in the chain
+
+        unsigned int getLevel(); //geometric, p = 1/4
+        bool isBefore(Transact* first, Transact* second) \
+            { return first->_linkKey < second->_linkKey || (first->_linkKey == second->_linkKey && first->_linkSeq < second->_linkSeq); }
+        void insertIndexed(Transact* transact);
+        void remove(Transact* transact);
     public:
-        Link (const std::string name): _link(EventChain (name)) {}
+        Link (const std::string& name): _link(EventChain (name)), _skipHeads {}, _indexed(false), _indexParam {0}, _linkSeq(0), \
+            _levelState(0x9E3779B97F4A7C15ull), _numbEntries(0), _maxLength(0), _cumSumCont(0), _cumSumTime(0), _prevLinkTime(0), \
+            _resetTime(0), _sumEntryTime(0) {}
 
         std::string getName() { return _link.getName(); }
         std::string getAsString() { return _link.getAsString(); }
+        EventChain& getChain() { return _link; }
 
-        void link(Transact* transact, const std::string discipline);
-        std::vector<Transact*> unlink(unsigned int numbReleasedTrans);
-        unsigned int getLinkParam(const std::string SNA);
+        void link(Transact* transact, LinkOrder order, ParamId paramId);
+        void unlink(unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans);
+        void unlinkBack(unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans);
+        void unlink(ParamId paramId, long double value, unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans);
+        unsigned int getLinkParam(SNA attribute);
+        long double getArea(long double time) { return _cumSumCont + (time - _prevLinkTime) * _link.size(); }
+
+        void linkStat(long double currTime); //after the insertion
+        void unlinkStat(long double entryTime, long double currTime); //after the removal
+        void reset(long double resetTime);
+        LinkStat getFinalStat(long double endModelTime);
+        static std::string getFinalStatString(const LinkStat& linkStat);
+        static std::string getFinalStatMeaningString() { return "USER CHAIN	SIZE	MAX	ENTRIES		AVE.CONT.	AVE.TIME"; }
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
+        void restoreIndex(); //skip list over the chain, the keys are on the transacts
 };
 
 //-----
 
-unsigned int Links::getLinkParam(const std::string linkName, const std::string SNA) {
-    std::vector<Link*>::iterator linkIt = std::find_if(_links.begin(),_links.end(), [ linkName ](Links::Link* link){ return linkName == link->getName(); });
-    if (linkIt == _links.end()) {
-        return 0;
-    }
-    return (*linkIt)->getLinkParam(SNA);
+Links::~Links() {
+    std::for_each(_links.begin(), _links.end(), [](Links::Link* link){ delete link; });
 }
 
-void Links::link(Transact* insertedTransact, const::std::string linkName, const std::string discipline) {
-    std::vector<Link*>::iterator linkIt = std::find_if(_links.begin(),_links.end(), [ linkName ](Links::Link* link){ return linkName == link->getName(); });
-    if (linkIt == _links.end()) {
+LinkId Links::getId(const std::string& linkName) {
+    if (!_names.contains(linkName)) {
         _links.push_back(new Link(linkName));
-        linkIt = _links.end();
-        linkIt--;
     }
-    (*linkIt)->link(insertedTransact,discipline);
+    return _names.intern(linkName);
 }
 
-std::vector<Transact*> Links::unlink(const std::string linkName, const unsigned int numbReleasedTrans) {
-    std::vector<Links::Link*>::iterator linkIt = std::find_if(_links.begin(),_links.end(), [ linkName ](Links::Link* LINK){ return linkName == LINK->getName(); });
-    if (linkIt == _links.end()) {
-        _links.push_back(new Link(linkName)); //gpss style solution, ?throw as alter?
-        linkIt = _links.end();
-        linkIt--;
+EventChain& Links::getChain(LinkId linkId) {
+    return _links[linkId.id]->getChain();
+}
+
+unsigned int Links::getLinkParam(LinkId linkId, SNA attribute) {
+    return _links[linkId.id]->getLinkParam(attribute);
+}
+
+long double Links::getArea(LinkId linkId, long double time) {
+    return _links[linkId.id]->getArea(time);
+}
+
+void Links::link(Transact* insertedTransact, LinkId linkId, LinkOrder order, ParamId paramId) {
+    _links[linkId.id]->link(insertedTransact, order, paramId);
+    _links[linkId.id]->linkStat(insertedTransact->getTime());
+}
+
+const std::vector<Transact*>& Links::unlink(LinkId linkId, const unsigned int numbReleasedTrans, long double currTime, UnlinkFrom from, \
+    ParamId paramId, long double value) {
+    _releasedTrans.clear();
+    if (from == UnlinkFrom::HEAD) {
+        _links[linkId.id]->unlink(numbReleasedTrans, _releasedTrans);
     }
-    return (*linkIt)->unlink(numbReleasedTrans);
+    else if (from == UnlinkFrom::BACK) {
+        _links[linkId.id]->unlinkBack(numbReleasedTrans, _releasedTrans);
+    }
+    else {
+        _links[linkId.id]->unlink(paramId, value, numbReleasedTrans, _releasedTrans);
+    }
+    //the released transacts keep their time of LINK until SimCPP moves them to the CEC
+    std::for_each(_releasedTrans.begin(), _releasedTrans.end(), [this, linkId, currTime](Transact* transact) \
+        { _links[linkId.id]->unlinkStat(transact->getTime(), currTime); });
+    return _releasedTrans;
+}
+
+void Links::save(LinkId linkId, CheckpointWriter& writer) {
+    _links[linkId.id]->save(writer);
+}
+
+void Links::restore(LinkId linkId, CheckpointReader& reader) {
+    _links[linkId.id]->restore(reader);
+}
+
+void Links::restoreIndex(LinkId linkId) {
+    _links[linkId.id]->restoreIndex();
+}
+
+void Links::reset(long double resetTime) {
+    std::for_each(_links.begin(), _links.end(), [resetTime](Links::Link* link){ link->reset(resetTime); });
+}
+
+std::vector<LinkStat> Links::getFinalStats(long double endModelTime) {
+    std::vector<LinkStat> linkStats;
+    std::for_each(_links.begin(), _links.end(), [&linkStats, endModelTime](Links::Link* link){ linkStats.push_back(link->getFinalStat(endModelTime)); });
+    return linkStats;
+}
+
+std::string Links::getFinalStatString(const std::vector<LinkStat>& linkStats) {
+    std::string message = '\n' + Links::Link::getFinalStatMeaningString();
+    std::for_each(linkStats.begin(), linkStats.end(), [&message](const LinkStat& linkStat) \
+        { message += '\n' + Links::Link::getFinalStatString(linkStat); });
+    return message;
 }
 
 std::string Links::getAsString() {
@@ -71,34 +188,240 @@ std::string Links::getAsString() {
 
 //-----
 
-unsigned int Links::Link::getLinkParam(const std::string SNA) {
-    if (SNA == "CH") {
+void Links::Link::linkStat(long double currTime) {
+    _numbEntries++;
+    _cumSumCont += (currTime - _prevLinkTime) * (_link.size() - 1);
+    _prevLinkTime = currTime;
+    _sumEntryTime += currTime;
+    if (_link.size() > _maxLength) {
+        _maxLength = _link.size();
+    }
+}
+
+void Links::Link::unlinkStat(long double entryTime, long double currTime) {
+    entryTime = std::max(entryTime, _resetTime);
+    _cumSumCont += (currTime - _prevLinkTime) * (_link.size() + 1);
+    _prevLinkTime = currTime;
+    _cumSumTime += currTime - entryTime;
+    _sumEntryTime -= entryTime;
+}
+
+void Links::Link::reset(long double resetTime) {
+    _numbEntries = _link.size();
+    _maxLength = _link.size();
+    _cumSumCont = 0;
+    _cumSumTime = 0;
+    _prevLinkTime = resetTime;
+    _resetTime = resetTime;
+    _sumEntryTime = _link.size() * resetTime;
+}
+
+void Links::Link::save(CheckpointWriter& writer) {
+    writer.write(_indexed);
+    writer.write(_indexParam);
+    writer.write(_linkSeq);
+    writer.write(_levelState);
+    writer.write(_numbEntries);
+    writer.write(_maxLength);
+    writer.write(_cumSumCont);
+    writer.write(_cumSumTime);
+    writer.write(_prevLinkTime);
+    writer.write(_resetTime);
+    writer.write(_sumEntryTime);
+}
+
+void Links::Link::restore(CheckpointReader& reader) {
+    reader.read(_indexed);
+    reader.read(_indexParam);
+    reader.read(_linkSeq);
+    reader.read(_levelState);
+    reader.read(_numbEntries);
+    reader.read(_maxLength);
+    reader.read(_cumSumCont);
+    reader.read(_cumSumTime);
+    reader.read(_prevLinkTime);
+    reader.read(_resetTime);
+    reader.read(_sumEntryTime);
+}
+
+void Links::Link::restoreIndex() {
+    //the chain is in the key order already, every transact is appended to its levels
+    Transact* last[SKIP_LEVELS - 1] = {};
+    std::fill(_skipHeads, _skipHeads + SKIP_LEVELS - 1, nullptr);
+    for (Transact* transact = _indexed ? _link._head : nullptr; transact != nullptr; transact = transact->_chainNext) {
+        std::fill(transact->_skipNext, transact->_skipNext + SKIP_LEVELS - 1, nullptr);
+        unsigned int level = this->getLevel();
+        for (unsigned int upper = 0; upper + 1 < level; upper++) {
+            (last[upper] == nullptr ? _skipHeads[upper] : last[upper]->_skipNext[upper]) = transact;
+            last[upper] = transact;
+        }
+    }
+}
+
+LinkStat Links::Link::getFinalStat(long double endModelTime) {
+    LinkStat linkStat;
+    long double measuredTime = endModelTime - _resetTime;
+    long double cumSumTime = _cumSumTime + _link.size() * endModelTime - _sumEntryTime;
+
+    linkStat.name = _link.getName();
+    linkStat.cont = _link.size();
+    linkStat.maxCont = _maxLength;
+    linkStat.entries = _numbEntries;
+    linkStat.aveCont = measuredTime > 0 ? (_cumSumCont + (endModelTime - _prevLinkTime) * _link.size()) / measuredTime : NAN;
+    linkStat.aveTime = _numbEntries != 0 ? cumSumTime / _numbEntries : NAN;
+    return linkStat;
+}
+
+std::string Links::Link::getFinalStatString(const LinkStat& linkStat) {
+    std::string aveContStr = std::isnan(linkStat.aveCont) ? "------" : std::to_string(linkStat.aveCont);
+    std::string aveTimeStr = std::isnan(linkStat.aveTime) ? "------" : std::to_string(linkStat.aveTime);
+    return linkStat.name + '\t' + std::to_string(linkStat.cont) + '\t' + std::to_string(linkStat.maxCont) + '\t' \
+        + std::to_string(linkStat.entries) + "\t\t" + aveContStr + '\t' + aveTimeStr;
+}
+
+unsigned int Links::Link::getLinkParam(SNA attribute) {
+    if (attribute == SNA::CH) {
         return _link.size();
     }
-    throw std::logic_error("Unknown system numeric attribute \"" + SNA + '\"');
+    throw std::logic_error("Unknown system numeric attribute of user chain \"" + _link.getName() + '\"');
+}
+
+unsigned int Links::Link::getLevel() {
+    _levelState ^= _levelState << 13;
+    _levelState ^= _levelState >> 7;
+    _levelState ^= _levelState << 17;
+    unsigned int level = 1;
+    for (uint64_t bits = _levelState; level < SKIP_LEVELS && (bits & 3) == 0; bits >>= 2) {
+        level++;
+    }
+    return level;
+}
+
+void Links::Link::insertIndexed(Transact* insertedTransact) {
+    Transact* update[SKIP_LEVELS - 1]; //last transact before the inserted one per upper level, nullptr is the head
+    Transact* prev = nullptr;
+
+    insertedTransact->_linkKey = insertedTransact->getParam(_indexParam);
+    insertedTransact->_linkSeq = _linkSeq++;
+    for (int level = SKIP_LEVELS - 2; level >= 0; level--) {
+        Transact* next = prev == nullptr ? _skipHeads[level] : prev->_skipNext[level];
+        while (next != nullptr && this->isBefore(next, insertedTransact)) {
+            prev = next;
+            next = next->_skipNext[level];
+        }
+        update[level] = prev;
+    }
+    Transact* next = prev == nullptr ? _link._head : prev->_chainNext;
+    while (next != nullptr && this->isBefore(next, insertedTransact)) {
+        next = next->_chainNext;
+    }
+    _link.emplace(EventChain::iterator(next), insertedTransact);
+
+    unsigned int level = this->getLevel();
+    for (unsigned int upper = 0; upper + 1 < level; upper++) {
+        Transact*& link = update[upper] == nullptr ? _skipHeads[upper] : update[upper]->_skipNext[upper];
+        insertedTransact->_skipNext[upper] = link;
+        link = insertedTransact;
+    }
+}
+
+void Links::Link::remove(Transact* transact) {
+    if (_indexed) {
+        Transact* prev = nullptr;
+        for (int level = SKIP_LEVELS - 2; level >= 0; level--) {
+            Transact* next = prev == nullptr ? _skipHeads[level] : prev->_skipNext[level];
+            while (next != nullptr && next != transact && this->isBefore(next, transact)) {
+                prev = next;
+                next = next->_skipNext[level];
+            }
+            if (next == transact) {
+                (prev == nullptr ? _skipHeads[level] : prev->_skipNext[level]) = transact->_skipNext[level];
+            }
+        }
+    }
+    _link.eraseTrans(transact);
 }
 
-void Links::Link::link(Transact* insertedTransact, const std::string discipline) {
+void Links::Link::link(Transact* insertedTransact, LinkOrder order, ParamId paramId) {
+    if (_link.size() == 0) {
+        _indexed = order == LinkOrder::PARAM;
+        _indexParam = paramId;
+        std::fill(_skipHeads, _skipHeads + SKIP_LEVELS - 1, nullptr);
+    }
+    else if (_indexed && (order != LinkOrder::PARAM || paramId.id != _indexParam.id)) {
+        _indexed = false;
+    }
+
     //M1,FIFO,LIFO,PR
-    if (discipline == "LIFO") {
+    if (_indexed) {
+        this->insertIndexed(insertedTransact);
+    }
+    else if (order == LinkOrder::LIFO) {
         _link.emplace(_link.begin(), insertedTransact);
     }
-    else if (discipline == "FIFO") {
+    else if (order == LinkOrder::FIFO) {
         _link.emplace(_link.end(), insertedTransact);
     }
     else {
-        _link.emplace(std::find_if(_link.begin(),_link.end(),[discipline,insertedTransact] (Transact* transact) \
-            { return insertedTransact->getParam(discipline) < transact->getParam(discipline); }),insertedTransact);
+        long double insertedParam = insertedTransact->getParam(paramId);
+        _link.emplace(std::find_if(_link.begin(),_link.end(),[ paramId,insertedParam ] (Transact* transact) \
+            { return insertedParam < transact->getParam(paramId); }),insertedTransact);
     }
 }
 
-std::vector<Transact*> Links::Link::unlink(unsigned int numbReleasedTrans) {
-    std::vector<Transact*> releasedTrans;
-    EventChain::iterator linkIt = _link.begin();
-    while (linkIt != _link.end() && numbReleasedTrans > 0) {
-        releasedTrans.push_back(*linkIt);
-        _link.erase(linkIt++);
+void Links::Link::unlink(unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans) {
+    while (_link._head != nullptr && numbReleasedTrans > 0) {
+        Transact* head = _link._head;
+        //the head is first on every level it is in
+        for (unsigned int level = 0; _indexed && level < SKIP_LEVELS - 1 && _skipHeads[level] == head; level++) {
+            _skipHeads[level] = head->_skipNext[level];
+        }
+        releasedTrans.push_back(head);
+        _link.eraseTrans(head);
         numbReleasedTrans--;
     }
-    return releasedTrans;
-}
\ No newline at end of file
+}
+
+void Links::Link::unlinkBack(unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans) {
+    while (_link._tail != nullptr && numbReleasedTrans > 0) {
+        releasedTrans.push_back(_link._tail);
+        this->remove(_link._tail);
+        numbReleasedTrans--;
+    }
+}
+
+void Links::Link::unlink(ParamId paramId, long double value, unsigned int numbReleasedTrans, std::vector<Transact*>& releasedTrans) {
+    Transact* matching = _link._head;
+    if (_indexed && paramId.id == _indexParam.id) {
+        //the equal keys are together, the first one is found on the upper levels
+        Transact* prev = nullptr;
+        for (int level = SKIP_LEVELS - 2; level >= 0; level--) {
+            Transact* next = prev == nullptr ? _skipHeads[level] : prev->_skipNext[level];
+            while (next != nullptr && next->_linkKey < value) {
+                prev = next;
+                next = next->_skipNext[level];
+            }
+        }
+        matching = prev == nullptr ? _link._head : prev->_chainNext;
+        while (matching != nullptr && matching->_linkKey < value) {
+            matching = matching->_chainNext;
+        }
+        while (matching != nullptr && matching->_linkKey == value && numbReleasedTrans > 0) {
+            Transact* next = matching->_chainNext;
+            releasedTrans.push_back(matching);
+            this->remove(matching);
+            matching = next;
+            numbReleasedTrans--;
+        }
+        return;
+    }
+    while (matching != nullptr && numbReleasedTrans > 0) {
+        Transact* next = matching->_chainNext;
+        if (matching->getParam(paramId) == value) {
+            releasedTrans.push_back(matching);
+            this->remove(matching);
+            numbReleasedTrans--;
+        }
+        matching = next;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+//engine phases of SimCPP, MODEL is the rest: block interpretation, expressions and the model code around sysEvent
+enum class ProfilePhase : unsigned int { MODEL, FEC, PROMOTION, STORAGES, USER_CHAINS, STATISTICS, LOGGING };
+
+#define PROFILE_PHASES_NUMB 7
+
+//wall time of the runs (start to the end of the model) split by phase; the time is exclusive: a phase entered inside another one
+//is charged to itself only, so the phases sum up to the run time. SimCPP enters the phases only when it is compiled
+//with SIMCPP_PROFILE, otherwise everything is MODEL and the profiler costs two clock reads per run
+class Profiler {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point _mark; //of the last phase change
+        ProfilePhase _phase;
+        bool _running;
+        double _seconds[PROFILE_PHASES_NUMB];
+        unsigned long _entries[PROFILE_PHASES_NUMB];
+
+        void charge(Clock::time_point now) { _seconds[(unsigned int)_phase] += std::chrono::duration<double>(now - _mark).count(); _mark = now; }
+    public:
+        Profiler(): _phase(ProfilePhase::MODEL), _running(false), _seconds {}, _entries {} {}
+
+        void start();
+        void stop();
+        ProfilePhase enter(ProfilePhase phase); //gives the interrupted phase back to leave
+        void leave(ProfilePhase interruptedPhase);
+        void clear();
+
+        double getSeconds(ProfilePhase phase) { return _seconds[(unsigned int)phase]; }
+        unsigned long getEntries(ProfilePhase phase) { return _entries[(unsigned int)phase]; }
+        double getTotalSeconds();
+        std::string getString(); //phases with their share of the run time
+
+        static std::string getPhaseName(ProfilePhase phase);
+};
+
+//the enclosing C++ scope is the phase
+class ProfileScope {
+    private:
+        Profiler& _profiler;
+        ProfilePhase _interruptedPhase;
+    public:
+        ProfileScope(Profiler& profiler, ProfilePhase phase): _profiler(profiler), _interruptedPhase(profiler.enter(phase)) {}
+        ~ProfileScope() { _profiler.leave(_interruptedPhase); }
+};
+
+#ifdef SIMCPP_PROFILE
+#define SIMCPP_PROFILE_SCOPE(phase) ProfileScope profileScope(_profiler, ProfilePhase::phase)
+#else
+#define SIMCPP_PROFILE_SCOPE(phase)
+#endif
+
+//-----
+
+void Profiler::start() {
+    _mark = Clock::now();
+    _phase = ProfilePhase::MODEL;
+    _running = true;
+}
+
+void Profiler::stop() {
+    if (_running) {
+        this->charge(Clock::now());
+        _running = false;
+    }
+}
+
+ProfilePhase Profiler::enter(ProfilePhase phase) {
+    ProfilePhase interruptedPhase = _phase;
+    if (_running) {
+        this->charge(Clock::now());
+    }
+    _phase = phase;
+    _entries[(unsigned int)phase]++;
+    return interruptedPhase;
+}
+
+void Profiler::leave(ProfilePhase interruptedPhase) {
+    if (_running) {
+        this->charge(Clock::now());
+    }
+    _phase = interruptedPhase;
+}
+
+void Profiler::clear() {
+    std::fill(_seconds, _seconds + PROFILE_PHASES_NUMB, 0);
+    std::fill(_entries, _entries + PROFILE_PHASES_NUMB, 0);
+}
+
+double Profiler::getTotalSeconds() {
+    double total = 0;
+    std::for_each(_seconds, _seconds + PROFILE_PHASES_NUMB, [&total](double seconds){ total += seconds; });
+    return total;
+}
+
+std::string Profiler::getString() {
+    std::string message = "PHASE\t\tENTRIES\t\tTIME,S\t\tSHARE,%";
+    double total = this->getTotalSeconds();
+    char line[128];
+    for (unsigned int i = 0; i < PROFILE_PHASES_NUMB; i++) {
+        std::snprintf(line, sizeof(line), "\n%-12s\t%-12lu\t%.6f\t%.2f", getPhaseName((ProfilePhase)i).c_str(), _entries[i], _seconds[i], \
+            total > 0 ? 100 * _seconds[i] / total : 0.);
+        message += line;
+    }
+    return message;
+}
+
+std::string Profiler::getPhaseName(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::MODEL: return "MODEL";
+        case ProfilePhase::FEC: return "FEC";
+        case ProfilePhase::PROMOTION: return "PROMOTION";
+        case ProfilePhase::STORAGES: return "STORAGES";
+        case ProfilePhase::USER_CHAINS: return "USER CHAINS";
+        case ProfilePhase::STATISTICS: return "STATISTICS";
+        case ProfilePhase::LOGGING: return "LOGGING";
+    }
+    return "UNKNOWN";
+}
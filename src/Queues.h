@@ -1,32 +1,55 @@
 #pragma once
 
 #include "Transact.h"
+#include "SymbolTable.h"
+#include "Checkpoint.h"
 #include <string>
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <vector>
-#include <tuple>
-#include <list>
+#include <cmath>
+
+//final statistics of a queue as GPSS prints them, NaN where the report shows "------"
+struct QueueStat {
+    std::string name;
+    unsigned long maxCont; //MAX
+    unsigned long cont; //CONT.
+    unsigned long entries; //ENTRY
+    unsigned long zeroEntries; //ENTRY(0)
+    long double aveCont; //AVE.CONT.
+    long double aveTime; //AVE.TIME
+    long double aveTimeNonZero; //AVE.(-0)
+};
 
 class Queues {
     friend class SimCPP;
     private:
         class Queue;
-        std::vector<Queue*> _queues;
+        std::vector<Queue*> _queues; //indexed by QueueId
+        SymbolTable<QueueId> _names;
         
         Queues(){}
-        std::vector<Queue*>::iterator chooseQueue(const std::string queueName);
     public:
-        void queue(const std::string queueName, Transact* transact);
-        void depart(const std::string queueName, Transact* transact);
-        std::string getFinalStatString(long double endModelTime);
+        ~Queues();
+
+        QueueId getId(const std::string& queueName); //queue is created at the first reference
+        const std::string& getName(QueueId queueId) { return _names.getName(queueId); }
+        void queue(QueueId queueId, Transact* transact);
+        long double depart(QueueId queueId, Transact* transact); //time in the queue
+        unsigned long getContent(QueueId queueId);
+        long double getArea(QueueId queueId, long double time); //integral of the content from the last reset to time
+        void reset(long double resetTime); //GPSS RESET, transacts in the queues stay
+        std::vector<QueueStat> getFinalStats(long double endModelTime); //the model can go on
+        static std::string getFinalStatString(const std::vector<QueueStat>& queueStats);
+        //names and statistics, the membership is saved with the transacts; queues missing here are created
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
 };
 
 class Queues::Queue {
     private:
         const std::string _queueName;
-        std::list<std::tuple<Transact*,long double>> _queue;
         unsigned long _numbRegTrans; //number of reg. trans. at queue
         unsigned long _nullnumbRegTrans; //avTime(-0) in queue = cumSumTime / numbRegTrans(-0) (if time in _queue not 0)
         long double _cumSumTime; //avTime in queue = cumSumTime / numbRegTrans
@@ -34,74 +57,137 @@ class Queues::Queue {
         long double _prevQueueTime; //_cumSumCont = (currTransTime - prevQueueTime) * _currQueueLength
         unsigned long _maxQueueLength;
         unsigned long _currQueueLength;
+        long double _resetTime; //statistics are measured from here, earlier entries count as made at it
+        long double _sumEntryTime; //of the transacts in the queue, they count as departing at the end of the run
+        long double _lastEntryTime;
+        unsigned long _lastEntryNumb; //transacts in the queue entered at _lastEntryTime, the zero entries at the end
 
         void departStat(long double prevTransTime, long double currTransTime);
         void queueStat(long double currTransTime);
     public:
-        Queue (const std::string queueName): _queueName(queueName), _numbRegTrans(0), _nullnumbRegTrans(0), _cumSumTime(.0), \
-            _maxQueueLength(0), _currQueueLength(0), _cumSumCont(0), _prevQueueTime(0) {}
+        Queue (const std::string& queueName): _queueName(queueName), _numbRegTrans(0), _nullnumbRegTrans(0), _cumSumTime(.0), \
+            _cumSumCont(0), _prevQueueTime(0), _maxQueueLength(0), _currQueueLength(0), _resetTime(0), \
+            _sumEntryTime(0), _lastEntryTime(0), _lastEntryNumb(0) {}
 
-        std::string getName() { return _queueName; }
-        void queue(Transact* transact);
-        void depart(Transact* transact);
-        std::string getFinalStatString(long double endModelTime);
+        const std::string& getName() { return _queueName; }
+        void queue(long double currTransTime);
+        void depart(long double entryTime, long double currTransTime);
+        unsigned long getContent() { return _currQueueLength; }
+        long double getArea(long double time) { return _cumSumCont + (time - _prevQueueTime) * _currQueueLength; }
+        void reset(long double resetTime);
+        QueueStat getFinalStat(long double endModelTime);
+        static std::string getFinalStatString(const QueueStat& queueStat);
         static std::string getFinalStatMeaningString() {return "QUEUE\t\tMAX\tCONT.\tENTRY\tENTRY(0)\tAVE.CONT.\tAVE.TIME\tAVE.(-0)"; }
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
 };
 
 //-----
 
-std::string Queues::getFinalStatString(long double endModelTime) {
+Queues::~Queues() {
+    std::for_each(_queues.begin(), _queues.end(), [](Queues::Queue* queue){ delete queue; });
+}
+
+unsigned long Queues::getContent(QueueId queueId) {
+    return _queues[queueId.id]->getContent();
+}
+
+long double Queues::getArea(QueueId queueId, long double time) {
+    return _queues[queueId.id]->getArea(time);
+}
+
+void Queues::reset(long double resetTime) {
+    std::for_each(_queues.begin(),_queues.end(),[resetTime](Queues::Queue* queue){ queue->reset(resetTime); });
+}
+
+std::vector<QueueStat> Queues::getFinalStats(long double endModelTime) {
+    std::vector<QueueStat> queueStats;
+    std::for_each(_queues.begin(),_queues.end(),[&queueStats, endModelTime](Queues::Queue* queue) \
+        { queueStats.push_back(queue->getFinalStat(endModelTime)); });
+    return queueStats;
+}
+
+std::string Queues::getFinalStatString(const std::vector<QueueStat>& queueStats) {
     std::string message = '\n' + Queue::getFinalStatMeaningString();
-    std::for_each(_queues.begin(),_queues.end(),[&message, endModelTime](Queues::Queue* queue) \
-        { message += '\n' + queue->getFinalStatString(endModelTime); });
+    std::for_each(queueStats.begin(),queueStats.end(),[&message](const QueueStat& queueStat) \
+        { message += '\n' + Queue::getFinalStatString(queueStat); });
     return message;
 }
 
-std::vector<Queues::Queue*>::iterator Queues::chooseQueue(const std::string queueName) {
-    std::vector<Queue*>::iterator queuesIt = std::find_if(_queues.begin(), _queues.end(), \
-        [ queueName ](Queues::Queue* queue){return queueName == queue->getName();});
-    return queuesIt;
+QueueId Queues::getId(const std::string& queueName) {
+    if (!_names.contains(queueName)) {
+        _queues.push_back(new Queue(queueName));
+    }
+    return _names.intern(queueName);
 }
 
-void Queues::queue(const std::string queueName, Transact* transact) {
-    std::vector<Queue*>::iterator queuesIt = this->chooseQueue(queueName);
-    if (queuesIt == _queues.end()) {
-        _queues.push_back(new Queue(queueName));
-        queuesIt = _queues.end(); queuesIt--;
+void Queues::save(CheckpointWriter& writer) {
+    writer.write((uint64_t)_queues.size());
+    std::for_each(_queues.begin(), _queues.end(), [&writer](Queues::Queue* queue) {
+        writer.write(queue->getName());
+        queue->save(writer);
+    });
+}
+
+void Queues::restore(CheckpointReader& reader) {
+    uint64_t queuesNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < queuesNumb; i++) {
+        std::string name = reader.get<std::string>();
+        if (i < _queues.size() && _queues[i]->getName() != name) {
+            throw std::logic_error("Queue " + std::to_string(i) + " of the checkpoint is \"" + name + "\", of the model is \"" \
+                + _queues[i]->getName() + '\"');
+        }
+        _queues[this->getId(name).id]->restore(reader);
     }
-    (*queuesIt)->queue(transact);
 }
 
-void Queues::depart(const std::string queueName, Transact* transact) {
-    std::vector<Queue*>::iterator queuesIt = this->chooseQueue(queueName);
-    if (queuesIt == _queues.end()) {
-        throw std::logic_error("Illegal attempt to make Queue entity content negative at \"" + queueName + "\" queue");
+//the membership is kept on the transact, so both are constant time for the inline entries
+void Queues::queue(QueueId queueId, Transact* transact) {
+    Transact::QueueEntry queueEntry {queueId.id, transact->getTime()};
+    if (transact->_queuesNumb < TRANSACT_QUEUES_NUMB) {
+        transact->_queueEntries[transact->_queuesNumb] = queueEntry;
+    }
+    else {
+        transact->_moreQueueEntries.push_back(queueEntry);
     }
-    (*queuesIt)->depart(transact);
+    transact->_queuesNumb++;
+    _queues[queueId.id]->queue(transact->getTime());
 }
 
-//-----
+long double Queues::depart(QueueId queueId, Transact* transact) {
+    unsigned int i = 0;
+    while (i < transact->_queuesNumb && transact->getQueueEntry(i).queue != queueId.id) {
+        i++;
+    }
 
-void Queues::Queue::queue(Transact* transact) {
-    _queue.push_back({transact,transact->getTime()});
-    this->queueStat(transact->getTime());
+    if (i == transact->_queuesNumb) {
+        throw std::logic_error("Illegal attempt to make Queue entity content negative at \"" + _names.getName(queueId) + "\" queue");
+    }
+    long double entryTime = transact->getQueueEntry(i).time;
+    _queues[queueId.id]->depart(entryTime, transact->getTime());
+    transact->getQueueEntry(i) = transact->getQueueEntry(--transact->_queuesNumb);
+    if (transact->_queuesNumb >= TRANSACT_QUEUES_NUMB) {
+        transact->_moreQueueEntries.pop_back();
+    }
+    return transact->getTime() - entryTime;
 }
 
-void Queues::Queue::depart(Transact* transact) {
-    std::tuple<Transact*,long double> data;
-    long double currTransTime = transact->getTime();
+//-----
 
-    std::list<std::tuple<Transact*,long double>>::iterator QIt = std::find_if(_queue.begin(),_queue.end(), \
-        [transact](std::tuple<Transact*,long double> data){return transact == std::get<0>(data);});
+void Queues::Queue::queue(long double currTransTime) {
+    _sumEntryTime += currTransTime;
+    _lastEntryNumb = currTransTime == _lastEntryTime ? _lastEntryNumb + 1 : 1;
+    _lastEntryTime = currTransTime;
+    this->queueStat(currTransTime);
+}
 
-    if (QIt == _queue.end()) {
-        throw std::logic_error("Illegal attempt to make Queue entity content negative at \"" + _queueName + "\" queue");
+void Queues::Queue::depart(long double entryTime, long double currTransTime) {
+    entryTime = std::max(entryTime, _resetTime);
+    _sumEntryTime -= entryTime;
+    if (entryTime == _lastEntryTime) {
+        _lastEntryNumb--;
     }
-
-    data = *QIt;
-    this->departStat(std::get<1>(data), currTransTime);
-
-    _queue.erase(QIt);
+    this->departStat(entryTime, currTransTime);
 }
 
 void Queues::Queue::departStat(long double prevTransTime, long double currTransTime) {
@@ -128,39 +214,76 @@ void Queues::Queue::queueStat(long double currTransTime) {
     } 
 }
 
-std::string Queues::Queue::getFinalStatString(long double endModelTime) {
+void Queues::Queue::reset(long double resetTime) {
+    //GPSS RESET: entry count is the current content, waiting is measured from the reset
+    _sumEntryTime = _currQueueLength * resetTime;
+    _lastEntryTime = resetTime;
+    _lastEntryNumb = _currQueueLength;
+    _numbRegTrans = _currQueueLength;
+    _nullnumbRegTrans = 0;
+    _cumSumTime = 0;
+    _cumSumCont = 0;
+    _prevQueueTime = resetTime;
+    _maxQueueLength = _currQueueLength;
+    _resetTime = resetTime;
+}
 
-    std::string statString = _queueName + '\t';
-    std::string avTimeStr, noNullAvTimeStr, avContStr;
-    unsigned long contAtQueue = 0; //CONT.
+void Queues::Queue::save(CheckpointWriter& writer) {
+    writer.write(_numbRegTrans);
+    writer.write(_nullnumbRegTrans);
+    writer.write(_cumSumTime);
+    writer.write(_cumSumCont);
+    writer.write(_prevQueueTime);
+    writer.write(_maxQueueLength);
+    writer.write(_currQueueLength);
+    writer.write(_resetTime);
+    writer.write(_sumEntryTime);
+    writer.write(_lastEntryTime);
+    writer.write(_lastEntryNumb);
+}
 
-    std::for_each(_queue.begin(),_queue.end(),[ endModelTime,this,&contAtQueue ](std::tuple<Transact*,long double> data) \
-        { this->departStat(std::get<1>(data), endModelTime); contAtQueue++; });
-    _queue.clear();
+void Queues::Queue::restore(CheckpointReader& reader) {
+    reader.read(_numbRegTrans);
+    reader.read(_nullnumbRegTrans);
+    reader.read(_cumSumTime);
+    reader.read(_cumSumCont);
+    reader.read(_prevQueueTime);
+    reader.read(_maxQueueLength);
+    reader.read(_currQueueLength);
+    reader.read(_resetTime);
+    reader.read(_sumEntryTime);
+    reader.read(_lastEntryTime);
+    reader.read(_lastEntryNumb);
+}
 
-    if (_numbRegTrans != 0) {
-        avTimeStr = std::to_string(_cumSumTime / _numbRegTrans);
-    }
-    else {
-        avTimeStr = "------";
-    }
+QueueStat Queues::Queue::getFinalStat(long double endModelTime) {
+    QueueStat queueStat;
+    long double cumSumCont = _cumSumCont + (endModelTime - _prevQueueTime) * _currQueueLength;
+    long double measuredTime = endModelTime - _resetTime;
 
-    if (_numbRegTrans - _nullnumbRegTrans != 0) {
-        noNullAvTimeStr = std::to_string(_cumSumTime / (_numbRegTrans - _nullnumbRegTrans));
-    }
-    else {
-        noNullAvTimeStr = "------";
-    }
+    //transacts still in the queue are counted as departing at the end, the queue itself is left as it is
+    long double cumSumTime = _cumSumTime + _currQueueLength * endModelTime - _sumEntryTime;
+    unsigned long nullnumbRegTrans = _nullnumbRegTrans + (_lastEntryTime == endModelTime ? _lastEntryNumb : 0);
 
-    if (endModelTime > 0) {
-        avContStr = std::to_string(_cumSumCont / endModelTime);
-    }
-    else {
-        avContStr = "------";
-    }
+    queueStat.name = _queueName;
+    queueStat.maxCont = _maxQueueLength;
+    queueStat.cont = _currQueueLength;
+    queueStat.entries = _numbRegTrans;
+    queueStat.zeroEntries = nullnumbRegTrans;
+    queueStat.aveCont = measuredTime > 0 ? cumSumCont / measuredTime : NAN;
+    queueStat.aveTime = _numbRegTrans != 0 ? cumSumTime / _numbRegTrans : NAN;
+    queueStat.aveTimeNonZero = _numbRegTrans - nullnumbRegTrans != 0 ? cumSumTime / (_numbRegTrans - nullnumbRegTrans) : NAN;
+    return queueStat;
+}
 
-    statString += std::to_string(_maxQueueLength) + '\t' + std::to_string(contAtQueue) + '\t' + std::to_string(_numbRegTrans) + "\t" \
-        + std::to_string(_nullnumbRegTrans) + "\t\t" + avContStr + '\t' + avTimeStr + '\t' + noNullAvTimeStr;
+std::string Queues::Queue::getFinalStatString(const QueueStat& queueStat) {
+    std::string statString = queueStat.name + '\t';
+    std::string avTimeStr = std::isnan(queueStat.aveTime) ? "------" : std::to_string(queueStat.aveTime);
+    std::string noNullAvTimeStr = std::isnan(queueStat.aveTimeNonZero) ? "------" : std::to_string(queueStat.aveTimeNonZero);
+    std::string avContStr = std::isnan(queueStat.aveCont) ? "------" : std::to_string(queueStat.aveCont);
+
+    statString += std::to_string(queueStat.maxCont) + '\t' + std::to_string(queueStat.cont) + '\t' + std::to_string(queueStat.entries) + "\t" \
+        + std::to_string(queueStat.zeroEntries) + "\t\t" + avContStr + '\t' + avTimeStr + '\t' + noNullAvTimeStr;
     
     return statString;
-}
\ No newline at end of file
+}
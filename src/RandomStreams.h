@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Checkpoint.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//GPSS FUNCTION analog, points are (cumulative probability; value), the last probability is 1
+enum class FunctionType { CONTINUOUS, DISCRETE };
+
+class EmpiricalFunction {
+    private:
+        FunctionType _type;
+        std::vector<std::pair<double,double>> _points;
+    public:
+        EmpiricalFunction(FunctionType type, const std::vector<std::pair<double,double>>& points);
+        double getValue(double probability);
+};
+
+//PCG32 (XSH RR) generator of one stream, O(log n) jump ahead and back
+class PCG32 {
+    private:
+        static const uint64_t MULTIPLIER = 6364136223846793005ULL;
+        uint64_t _state;
+        uint64_t _inc; //odd, selects the sequence
+    public:
+        PCG32(uint64_t seed = 0, uint64_t sequence = 0) { this->seed(seed, sequence); }
+
+        void seed(uint64_t seed, uint64_t sequence);
+        uint32_t next();
+        double nextUniform() { return (this->next() + 0.5) * (1.0 / 4294967296.0); } //(0;1), never 0 or 1
+        void fillUniforms(double* uniforms, unsigned int numb); //same values as numb calls of nextUniform
+        void advance(uint64_t delta); //delta = 2^64 - n goes n steps back
+        static void strideConstants(uint64_t inc, uint64_t delta, uint64_t& mult, uint64_t& plus); //state(n+delta) = mult*state(n)+plus
+        uint64_t getState() { return _state; }
+        uint64_t getInc() { return _inc; }
+        void setState(uint64_t state, uint64_t inc) { _state = state; _inc = inc; }
+};
+
+//uniforms generated ahead of a stream in blocks, pos == UNIFORM_BLOCK is empty
+#define UNIFORM_BLOCK 256
+
+struct UniformBuffer {
+    unsigned int pos;
+    double values[UNIFORM_BLOCK];
+};
+
+//numbered independent random number streams, GPSS RMULT reseeds them all
+class RandomStreams {
+    friend class SimCPP;
+
+    private:
+        std::vector<PCG32> _streams; //stream N is _streams[N-1], created at the first reference
+        std::vector<UniformBuffer> _buffers; //per stream, the generator runs UNIFORM_BLOCK - pos draws ahead
+        uint64_t _runSeed;
+        bool _buffering;
+        bool _antithetic; //every uniform U is drawn as 1 - U
+
+        RandomStreams(uint64_t runSeed = 0): _runSeed(runSeed), _buffering(true), _antithetic(false) {}
+        static uint64_t splitMix(uint64_t value);
+        PCG32& getStream(unsigned int streamNumb);
+        void sync(unsigned int streamNumb); //gives back unused buffered draws, the generator is at the logical position
+    public:
+        //buffered and unbuffered draws are bit-identical for the same seed, buffering only changes speed
+        void setBuffering(bool buffering);
+        bool isBuffering() { return _buffering; }
+        //a run with the same seeds and 1 - U for every U, its results are negatively correlated with the ones of the original run
+        void setAntithetic(bool antithetic);
+        bool isAntithetic() { return _antithetic; }
+
+        void rmult(uint64_t runSeed); //every stream is derived from the run seed and its number
+        void rmult(const std::vector<uint64_t>& seeds); //stream N gets seeds[N-1], the rest keep derived seeds
+        void skip(unsigned int streamNumb, uint64_t numbOfDraws) { this->sync(streamNumb); this->getStream(streamNumb).advance(numbOfDraws); }
+        uint64_t getRunSeed() { return _runSeed; }
+        //logical positions of the streams, the buffered draws are given back first, so the draws go on the same
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
+
+        double uniform01(unsigned int streamNumb);
+        double uniform(unsigned int streamNumb, double min, double max);
+        double exponential(unsigned int streamNumb, double locate, double scale);
+        double normal(unsigned int streamNumb, double mean, double stdDev);
+        double erlang(unsigned int streamNumb, double locate, double scale, unsigned int shape);
+        double triangular(unsigned int streamNumb, double min, double max, double mode);
+        double weibull(unsigned int streamNumb, double locate, double scale, double shape);
+        double empirical(unsigned int streamNumb, EmpiricalFunction& function);
+
+        static double stdExponential(double u) { return -std::log(u); }
+        static double stdNormal(double u); //inverse of the standard normal distribution function
+};
+
+//-----
+
+EmpiricalFunction::EmpiricalFunction(FunctionType type, const std::vector<std::pair<double,double>>& points): _type(type), _points(points) {
+    if (_points.empty() || _points.back().first != 1.) {
+        throw std::logic_error("Function points must end with cumulative probability 1");
+    }
+    for (unsigned int i = 1; i < _points.size(); i++) {
+        if (_points[i].first < _points[i-1].first) {
+            throw std::logic_error("Function cumulative probabilities must not decrease");
+        }
+    }
+}
+
+double EmpiricalFunction::getValue(double probability) {
+    std::vector<std::pair<double,double>>::iterator pointIt = std::lower_bound(_points.begin(), _points.end(), probability, \
+        [](const std::pair<double,double>& point, double probability){ return point.first < probability; });
+    if (_type == FunctionType::DISCRETE || pointIt == _points.begin()) {
+        return pointIt->second;
+    }
+    std::vector<std::pair<double,double>>::iterator prevIt = pointIt - 1;
+    return prevIt->second + (pointIt->second - prevIt->second) * (probability - prevIt->first) / (pointIt->first - prevIt->first);
+}
+
+//-----
+
+void PCG32::seed(uint64_t seed, uint64_t sequence) {
+    _state = 0;
+    _inc = (sequence << 1) | 1;
+    this->next();
+    _state += seed;
+    this->next();
+}
+
+uint32_t PCG32::next() {
+    uint64_t oldState = _state;
+    _state = oldState * MULTIPLIER + _inc;
+    uint32_t xorShifted = (uint32_t)(((oldState >> 18) ^ oldState) >> 27);
+    uint32_t rot = (uint32_t)(oldState >> 59);
+    return (xorShifted >> rot) | (xorShifted << ((-rot) & 31));
+}
+
+void PCG32::strideConstants(uint64_t inc, uint64_t delta, uint64_t& mult, uint64_t& plus) {
+    //F. Brown, "Random number generation with arbitrary stride"
+    uint64_t curMult = MULTIPLIER, curPlus = inc;
+    mult = 1;
+    plus = 0;
+    while (delta > 0) {
+        if (delta & 1) {
+            mult *= curMult;
+            plus = plus * curMult + curPlus;
+        }
+        curPlus = (curMult + 1) * curPlus;
+        curMult *= curMult;
+        delta >>= 1;
+    }
+}
+
+void PCG32::advance(uint64_t delta) {
+    uint64_t mult, plus;
+    strideConstants(_inc, delta, mult, plus);
+    _state = mult * _state + plus;
+}
+
+void PCG32::fillUniforms(double* uniforms, unsigned int numb) {
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    //4 lanes run interleaved copies of the generator, lane j produces draws j, j+4, ...
+    uint64_t laneStates[4], laneMult, lanePlus;
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        strideConstants(_inc, lane, laneMult, lanePlus);
+        laneStates[lane] = laneMult * _state + lanePlus;
+    }
+    strideConstants(_inc, 4, laneMult, lanePlus);
+
+    __m256i state = _mm256_loadu_si256((const __m256i*)laneStates);
+    const __m256i vMult = _mm256_set1_epi64x(laneMult), vPlus = _mm256_set1_epi64x(lanePlus), multHigh = _mm256_srli_epi64(vMult, 32);
+    const __m256i low32 = _mm256_set1_epi64x(0xFFFFFFFFULL), thirtyTwo = _mm256_set1_epi64x(32), magic = _mm256_set1_epi64x(0x4330000000000000ULL);
+    const __m256d two52 = _mm256_set1_pd(4503599627370496.0), half = _mm256_set1_pd(0.5), scale = _mm256_set1_pd(1.0 / 4294967296.0);
+    for (; i + 4 <= numb; i += 4) {
+        __m256i oldState = state;
+        //64 bit multiplication from 32 bit halves
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(oldState, 32), vMult), _mm256_mul_epu32(oldState, multHigh));
+        state = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(oldState, vMult), _mm256_slli_epi64(cross, 32)), vPlus);
+        __m256i xorShifted = _mm256_and_si256(_mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(oldState, 18), oldState), 27), low32);
+        __m256i rot = _mm256_srli_epi64(oldState, 59);
+        __m256i rotated = _mm256_or_si256(_mm256_srlv_epi64(xorShifted, rot), \
+            _mm256_and_si256(_mm256_sllv_epi64(xorShifted, _mm256_sub_epi64(thirtyTwo, rot)), low32));
+        __m256d value = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(rotated, magic)), two52); //exact uint32 to double
+        _mm256_storeu_pd(uniforms + i, _mm256_mul_pd(_mm256_add_pd(value, half), scale));
+    }
+    _mm256_zeroupper(); //dirty upper halves make the SSE code of libm very slow
+#endif
+    //scalar tail continues from draw i
+    PCG32 tail;
+    tail.setState(_state, _inc);
+    tail.advance(i);
+    for (; i < numb; i++) {
+        uniforms[i] = tail.nextUniform();
+    }
+    this->advance(numb);
+}
+
+//-----
+
+uint64_t RandomStreams::splitMix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+PCG32& RandomStreams::getStream(unsigned int streamNumb) {
+    if (streamNumb == 0) {
+        throw std::logic_error("Random number streams are numbered from 1");
+    }
+    while (_streams.size() < streamNumb) {
+        uint64_t streamN = _streams.size() + 1;
+        _streams.emplace_back(splitMix(_runSeed ^ splitMix(streamN)), streamN);
+        _buffers.emplace_back();
+        _buffers.back().pos = UNIFORM_BLOCK;
+    }
+    return _streams[streamNumb - 1];
+}
+
+void RandomStreams::sync(unsigned int streamNumb) {
+    UniformBuffer& buffer = _buffers[streamNumb - 1];
+    _streams[streamNumb - 1].advance(0 - (uint64_t)(UNIFORM_BLOCK - buffer.pos));
+    buffer.pos = UNIFORM_BLOCK;
+}
+
+double RandomStreams::uniform01(unsigned int streamNumb) {
+    if (_buffering && streamNumb - 1 < _buffers.size() && _buffers[streamNumb - 1].pos < UNIFORM_BLOCK) {
+        UniformBuffer& buffer = _buffers[streamNumb - 1];
+        return buffer.values[buffer.pos++];
+    }
+
+    PCG32& stream = this->getStream(streamNumb);
+    if (!_buffering) {
+        return _antithetic ? 1 - stream.nextUniform() : stream.nextUniform();
+    }
+    UniformBuffer& buffer = _buffers[streamNumb - 1];
+    stream.fillUniforms(buffer.values, UNIFORM_BLOCK);
+    if (_antithetic) {
+        std::for_each(buffer.values, buffer.values + UNIFORM_BLOCK, [](double& value){ value = 1 - value; });
+    }
+    buffer.pos = 1;
+    return buffer.values[0];
+}
+
+void RandomStreams::setBuffering(bool buffering) {
+    for (unsigned int i = 0; i < _streams.size(); i++) {
+        this->sync(i + 1);
+    }
+    _buffering = buffering;
+}
+
+void RandomStreams::setAntithetic(bool antithetic) {
+    for (unsigned int i = 0; i < _streams.size(); i++) {
+        this->sync(i + 1);
+    }
+    _antithetic = antithetic;
+}
+
+void RandomStreams::rmult(uint64_t runSeed) {
+    _runSeed = runSeed;
+    for (unsigned int i = 0; i < _streams.size(); i++) {
+        _streams[i].seed(splitMix(_runSeed ^ splitMix(i + 1)), i + 1);
+        _buffers[i].pos = UNIFORM_BLOCK;
+    }
+}
+
+void RandomStreams::rmult(const std::vector<uint64_t>& seeds) {
+    for (unsigned int i = 0; i < seeds.size(); i++) {
+        this->getStream(i + 1).seed(seeds[i], i + 1);
+        _buffers[i].pos = UNIFORM_BLOCK; //buffered draws of the old seed are dropped
+    }
+}
+
+void RandomStreams::save(CheckpointWriter& writer) {
+    writer.write(_runSeed);
+    writer.write(_antithetic);
+    writer.write((uint64_t)_streams.size());
+    for (unsigned int i = 0; i < _streams.size(); i++) {
+        this->sync(i + 1);
+        writer.write(_streams[i].getState());
+        writer.write(_streams[i].getInc());
+    }
+}
+
+void RandomStreams::restore(CheckpointReader& reader) {
+    reader.read(_runSeed);
+    reader.read(_antithetic);
+    uint64_t streamsNumb = reader.get<uint64_t>();
+    _streams.clear();
+    _buffers.assign(streamsNumb, UniformBuffer());
+    for (uint64_t i = 0; i < streamsNumb; i++) {
+        uint64_t state = reader.get<uint64_t>();
+        _streams.emplace_back();
+        _streams.back().setState(state, reader.get<uint64_t>());
+        _buffers[i].pos = UNIFORM_BLOCK;
+    }
+}
+
+double RandomStreams::uniform(unsigned int streamNumb, double min, double max) {
+    return min + (max - min) * this->uniform01(streamNumb);
+}
+
+double RandomStreams::exponential(unsigned int streamNumb, double locate, double scale) {
+    return locate + scale * stdExponential(this->uniform01(streamNumb));
+}
+
+double RandomStreams::normal(unsigned int streamNumb, double mean, double stdDev) {
+    return mean + stdDev * stdNormal(this->uniform01(streamNumb));
+}
+
+double RandomStreams::erlang(unsigned int streamNumb, double locate, double scale, unsigned int shape) {
+    //sum of "shape" exponential phases, mean = locate + scale
+    if (shape == 0) {
+        throw std::logic_error("Erlang distribution shape must be positive");
+    }
+    double sum = 0;
+    for (unsigned int i = 0; i < shape; i++) {
+        sum += stdExponential(this->uniform01(streamNumb));
+    }
+    return locate + scale * sum / shape;
+}
+
+double RandomStreams::triangular(unsigned int streamNumb, double min, double max, double mode) {
+    double u = this->uniform01(streamNumb);
+    double modeProb = (mode - min) / (max - min);
+    if (u < modeProb) {
+        return min + std::sqrt(u * (max - min) * (mode - min));
+    }
+    return max - std::sqrt((1 - u) * (max - min) * (max - mode));
+}
+
+double RandomStreams::weibull(unsigned int streamNumb, double locate, double scale, double shape) {
+    return locate + scale * std::pow(stdExponential(this->uniform01(streamNumb)), 1. / shape);
+}
+
+double RandomStreams::empirical(unsigned int streamNumb, EmpiricalFunction& function) {
+    return function.getValue(this->uniform01(streamNumb));
+}
+
+double RandomStreams::stdNormal(double u) {
+    //M.J. Wichura, algorithm AS241 PPND16
+    double q = u - 0.5, r, value;
+    if (std::fabs(q) <= 0.425) {
+        r = 0.180625 - q * q;
+        return q * (((((((r * 2509.0809287301226727 + 33430.575583588128105) * r + 67265.770927008700853) * r \
+            + 45921.953931549871457) * r + 13731.693765509461125) * r + 1971.5909503065514427) * r + 133.14166789178437745) * r \
+            + 3.387132872796366608) / (((((((r * 5226.495278852545925 + 28729.085735721942674) * r + 39307.89580009271061) * r \
+            + 21213.794301586595867) * r + 5394.1960214247511077) * r + 687.1870074920579083) * r + 42.313330701600911252) * r + 1.);
+    }
+    r = std::sqrt(-std::log(q < 0 ? u : 1 - u));
+    if (r <= 5.) {
+        r -= 1.6;
+        value = (((((((r * 7.7454501427834140764e-4 + 0.0227238449892691845833) * r + 0.24178072517745061177) * r \
+            + 1.27045825245236838258) * r + 3.64784832476320460504) * r + 5.7694972214606914055) * r + 4.6303378461565452959) * r \
+            + 1.42343711074968357734) / (((((((r * 1.05075007164441684324e-9 + 5.475938084995344946e-4) * r + 0.0151986665636164571966) * r \
+            + 0.14810397642748007459) * r + 0.68976733498510000455) * r + 1.6763848301838038494) * r + 2.05319162663775882187) * r + 1.);
+    }
+    else {
+        r -= 5.;
+        value = (((((((r * 2.01033439929228813265e-7 + 2.71155556874348757815e-5) * r + 0.0012426609473880784386) * r \
+            + 0.026532189526576123093) * r + 0.29656057182850489123) * r + 1.7848265399172913358) * r + 5.4637849111641143699) * r \
+            + 6.6579046435011037772) / (((((((r * 2.04426310338993978564e-15 + 1.4215117583164458887e-7) * r + 1.8463183175100546818e-5) * r \
+            + 7.868691311456132591e-4) * r + 0.0148753612908506148525) * r + 0.13692988092273580531) * r + 0.59983220655588793769) * r + 1.);
+    }
+    return q < 0 ? -value : value;
+}
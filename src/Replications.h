@@ -0,0 +1,311 @@
+#pragma once
+
+#include "SimCPP.h"
+#include "Estimators.h"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//final statistics of one replication
+struct RunStat {
+    unsigned int runNumb;
+    uint64_t runSeed;
+    bool antithetic;
+    long double endTime;
+    std::vector<QueueStat> queueStats;
+    std::vector<StorageStat> storageStats;
+    std::vector<TableStat> tableStats;
+};
+
+//estimates over the replications, every run gives one observation
+struct QueueEstimates {
+    std::string name;
+    Estimator maxCont, entries, aveCont, aveTime, aveTimeNonZero;
+};
+
+struct StorageEstimates {
+    std::string name;
+    Estimator maxCont, entries, aveCont, util;
+};
+
+//runs making one observation with their weights: a run, the mean of an antithetic pair or a difference of paired runs
+using Observation = std::vector<std::pair<const RunStat*,double>>;
+
+//GPSS "DoTheRun" analog: independent replications of a model on a pool of threads,
+//run N is a fresh SimCPP reseeded with RMULT baseSeed + N, so results do not depend on the number of threads.
+//Replications of two configurations with the same base seed use common random numbers: every stream gives
+//the same variates to the same activity, the paired differences then have a smaller variance than independent ones.
+//In the antithetic mode runs 2N - 1 and 2N are a pair reseeded with baseSeed + N, the second one draws 1 - U,
+//and the mean of the pair is one observation
+class Replications {
+    private:
+        const std::string _modelName;
+        const std::function<void(SimCPP&)> _model; //declares the entities, starts the model and runs the sysEvent loop to completion
+        unsigned int _threadsNumb;
+        FECType _FECEngine;
+        bool _antithetic;
+        std::vector<RunStat> _runs; //ordered by run number
+
+        RunStat runOnce(unsigned int runNumb, uint64_t runSeed, bool antithetic);
+        std::vector<Observation> getObservations();
+        std::vector<Observation> getPairedObservations(Replications& baseline); //this minus baseline, throws if the runs are not paired
+        static void addQueueObservation(std::vector<QueueEstimates>& estimates, const std::string& name, const Observation& observation);
+        static void addStorageObservation(std::vector<StorageEstimates>& estimates, const std::string& name, const Observation& observation);
+        static std::vector<QueueEstimates> getQueueEstimates(const std::vector<Observation>& observations);
+        static std::vector<StorageEstimates> getStorageEstimates(const std::vector<Observation>& observations);
+    public:
+        //0 threads is one per hardware thread
+        Replications(const std::string& modelName, const std::function<void(SimCPP&)>& model, unsigned int threadsNumb = 0, \
+            FECType FECEngine = FECType::BINARY_HEAP);
+
+        void setAntithetic(bool antithetic); //before the first run
+        void run(unsigned int numbOfRuns, uint64_t baseSeed = 0); //appends runs, numbering continues; an even number in the antithetic mode
+        unsigned int getThreadsNumb() { return _threadsNumb; }
+        bool isAntithetic() { return _antithetic; }
+        const std::vector<RunStat>& getRuns() { return _runs; }
+        std::vector<QueueEstimates> getQueueEstimates() { return getQueueEstimates(this->getObservations()); }
+        std::vector<StorageEstimates> getStorageEstimates() { return getStorageEstimates(this->getObservations()); }
+        std::vector<TableStat> getTableStats(); //tables of all runs merged, the quantiles are of the pooled observations
+        std::string getSummaryString(double confidence = 0.95);
+        //estimates of this minus baseline, run N of one is paired with run N of the other,
+        //so both need the same runs with the same seeds (the same base seeds and the same mode)
+        std::vector<QueueEstimates> getQueueDifferences(Replications& baseline) { return getQueueEstimates(this->getPairedObservations(baseline)); }
+        std::vector<StorageEstimates> getStorageDifferences(Replications& baseline) { return getStorageEstimates(this->getPairedObservations(baseline)); }
+        std::string getDifferenceString(Replications& baseline, double confidence = 0.95); //"*" marks an interval without 0
+};
+
+//-----
+
+Replications::Replications(const std::string& modelName, const std::function<void(SimCPP&)>& model, unsigned int threadsNumb, FECType FECEngine): \
+    _modelName(modelName), _model(model), _threadsNumb(threadsNumb), _FECEngine(FECEngine), _antithetic(false) {
+    if (_threadsNumb == 0) {
+        _threadsNumb = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void Replications::setAntithetic(bool antithetic) {
+    if (!_runs.empty()) {
+        throw std::logic_error("The antithetic mode is set before the first run");
+    }
+    _antithetic = antithetic;
+}
+
+RunStat Replications::runOnce(unsigned int runNumb, uint64_t runSeed, bool antithetic) {
+    SimCPP sim(_modelName + " #" + std::to_string(runNumb), _FECEngine);
+    sim.rmult(runSeed);
+    sim.setAntithetic(antithetic);
+    _model(sim);
+    if (sim.isRunning()) {
+        throw std::logic_error("The model of run #" + std::to_string(runNumb) + " returned before its completion");
+    }
+    return RunStat {runNumb, runSeed, antithetic, sim.getModelTime(), sim.getQueueStats(), sim.getStorageStats(), sim.getTableStats()};
+}
+
+void Replications::run(unsigned int numbOfRuns, uint64_t baseSeed) {
+    if (_antithetic && numbOfRuns % 2 != 0) {
+        throw std::logic_error("Antithetic replications are run in pairs");
+    }
+    unsigned int firstRunNumb = _runs.size() + 1;
+    unsigned int threadsNumb = std::min(_threadsNumb, numbOfRuns);
+    std::atomic<unsigned int> nextRun(0);
+    std::vector<RunStat> runs(numbOfRuns);
+    std::vector<std::exception_ptr> errors(numbOfRuns);
+    std::vector<std::thread> threads;
+
+    //runs are handed out one at a time, their lengths differ
+    std::function<void()> worker = [this, &nextRun, &runs, &errors, numbOfRuns, firstRunNumb, baseSeed]() {
+        for (unsigned int i = nextRun++; i < numbOfRuns; i = nextRun++) {
+            unsigned int runNumb = firstRunNumb + i;
+            try {
+                if (_antithetic) {
+                    runs[i] = this->runOnce(runNumb, baseSeed + (runNumb + 1) / 2, runNumb % 2 == 0);
+                }
+                else {
+                    runs[i] = this->runOnce(runNumb, baseSeed + runNumb, false);
+                }
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    for (unsigned int i = 1; i < threadsNumb; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    std::for_each(threads.begin(), threads.end(), [](std::thread& thread){ thread.join(); });
+
+    std::for_each(errors.begin(), errors.end(), [](std::exception_ptr& error){ if (error) { std::rethrow_exception(error); } });
+    _runs.insert(_runs.end(), runs.begin(), runs.end());
+}
+
+std::vector<Observation> Replications::getObservations() {
+    std::vector<Observation> observations;
+    for (unsigned int i = 0; i < _runs.size(); i += _antithetic ? 2 : 1) {
+        if (_antithetic) {
+            observations.push_back(Observation {{&_runs[i], 0.5}, {&_runs[i + 1], 0.5}});
+        }
+        else {
+            observations.push_back(Observation {{&_runs[i], 1.}});
+        }
+    }
+    return observations;
+}
+
+std::vector<Observation> Replications::getPairedObservations(Replications& baseline) {
+    if (_antithetic != baseline._antithetic || _runs.size() != baseline._runs.size() || !std::equal(_runs.begin(), _runs.end(), baseline._runs.begin(), \
+        [](const RunStat& run, const RunStat& baselineRun){ return run.runSeed == baselineRun.runSeed && run.antithetic == baselineRun.antithetic; })) {
+        throw std::logic_error("Paired differences need the same runs with the same seeds in both replications");
+    }
+    std::vector<Observation> observations = this->getObservations(), baselineObservations = baseline.getObservations();
+    for (unsigned int i = 0; i < observations.size(); i++) {
+        std::for_each(baselineObservations[i].begin(), baselineObservations[i].end(), [&observations, i](const std::pair<const RunStat*,double>& run) \
+            { observations[i].emplace_back(run.first, -run.second); });
+    }
+    return observations;
+}
+
+void Replications::addQueueObservation(std::vector<QueueEstimates>& estimates, const std::string& name, const Observation& observation) {
+    std::vector<std::pair<const QueueStat*,double>> stats;
+    for (const std::pair<const RunStat*,double>& run : observation) {
+        std::vector<QueueStat>::const_iterator statIt = std::find_if(run.first->queueStats.begin(), run.first->queueStats.end(), \
+            [&name](const QueueStat& queueStat){ return queueStat.name == name; });
+        if (statIt == run.first->queueStats.end()) {
+            return; //the queue is not in every run of the observation
+        }
+        stats.emplace_back(&*statIt, run.second);
+    }
+    std::vector<QueueEstimates>::iterator estIt = std::find_if(estimates.begin(), estimates.end(), \
+        [&name](const QueueEstimates& estimate){ return estimate.name == name; });
+    if (estIt == estimates.end()) {
+        estimates.push_back(QueueEstimates {name, {}, {}, {}, {}, {}});
+        estIt = estimates.end() - 1;
+    }
+    //NaN ("------") observations are left out
+    auto add = [&stats](Estimator& estimator, auto QueueStat::* field) {
+        double value = 0;
+        std::for_each(stats.begin(), stats.end(), [&value, field](const std::pair<const QueueStat*,double>& stat) \
+            { value += stat.second * (double)(stat.first->*field); });
+        if (!std::isnan(value)) estimator.add(value);
+    };
+    add(estIt->maxCont, &QueueStat::maxCont);
+    add(estIt->entries, &QueueStat::entries);
+    add(estIt->aveCont, &QueueStat::aveCont);
+    add(estIt->aveTime, &QueueStat::aveTime);
+    add(estIt->aveTimeNonZero, &QueueStat::aveTimeNonZero);
+}
+
+void Replications::addStorageObservation(std::vector<StorageEstimates>& estimates, const std::string& name, const Observation& observation) {
+    std::vector<std::pair<const StorageStat*,double>> stats;
+    for (const std::pair<const RunStat*,double>& run : observation) {
+        std::vector<StorageStat>::const_iterator statIt = std::find_if(run.first->storageStats.begin(), run.first->storageStats.end(), \
+            [&name](const StorageStat& storageStat){ return storageStat.name == name; });
+        if (statIt == run.first->storageStats.end()) {
+            return;
+        }
+        stats.emplace_back(&*statIt, run.second);
+    }
+    std::vector<StorageEstimates>::iterator estIt = std::find_if(estimates.begin(), estimates.end(), \
+        [&name](const StorageEstimates& estimate){ return estimate.name == name; });
+    if (estIt == estimates.end()) {
+        estimates.push_back(StorageEstimates {name, {}, {}, {}, {}});
+        estIt = estimates.end() - 1;
+    }
+    auto add = [&stats](Estimator& estimator, auto StorageStat::* field) {
+        double value = 0;
+        std::for_each(stats.begin(), stats.end(), [&value, field](const std::pair<const StorageStat*,double>& stat) \
+            { value += stat.second * (double)(stat.first->*field); });
+        if (!std::isnan(value)) estimator.add(value);
+    };
+    add(estIt->maxCont, &StorageStat::maxCont);
+    add(estIt->entries, &StorageStat::entries);
+    add(estIt->aveCont, &StorageStat::aveCont);
+    add(estIt->util, &StorageStat::util);
+}
+
+std::vector<QueueEstimates> Replications::getQueueEstimates(const std::vector<Observation>& observations) {
+    std::vector<QueueEstimates> estimates;
+    std::for_each(observations.begin(), observations.end(), [&estimates](const Observation& observation) {
+        std::for_each(observation[0].first->queueStats.begin(), observation[0].first->queueStats.end(), [&estimates, &observation](const QueueStat& queueStat) \
+            { addQueueObservation(estimates, queueStat.name, observation); });
+    });
+    return estimates;
+}
+
+std::vector<StorageEstimates> Replications::getStorageEstimates(const std::vector<Observation>& observations) {
+    std::vector<StorageEstimates> estimates;
+    std::for_each(observations.begin(), observations.end(), [&estimates](const Observation& observation) {
+        std::for_each(observation[0].first->storageStats.begin(), observation[0].first->storageStats.end(), [&estimates, &observation](const StorageStat& storageStat) \
+            { addStorageObservation(estimates, storageStat.name, observation); });
+    });
+    return estimates;
+}
+
+std::vector<TableStat> Replications::getTableStats() {
+    std::vector<TableStat> tableStats;
+    std::for_each(_runs.begin(), _runs.end(), [&tableStats](const RunStat& run) {
+        std::for_each(run.tableStats.begin(), run.tableStats.end(), [&tableStats](const TableStat& tableStat) {
+            std::vector<TableStat>::iterator statIt = std::find_if(tableStats.begin(), tableStats.end(), \
+                [&tableStat](const TableStat& merged){ return merged.name == tableStat.name; });
+            if (statIt == tableStats.end()) {
+                tableStats.push_back(tableStat);
+            }
+            else {
+                Tables::merge(*statIt, tableStat);
+            }
+        });
+    });
+    return tableStats;
+}
+
+std::string Replications::getSummaryString(double confidence) {
+    std::vector<QueueEstimates> queueEstimates = this->getQueueEstimates();
+    std::vector<StorageEstimates> storageEstimates = this->getStorageEstimates();
+    std::string message = '\"' + _modelName + "\" replications: " + std::to_string(_runs.size()) + (_antithetic ? " (antithetic pairs)" : "") \
+        + ", confidence: " + std::to_string(confidence);
+
+    message += "\n\nQUEUE\t\tMAX\t\t\tENTRY\t\t\tAVE.CONT.\t\tAVE.TIME";
+    std::for_each(queueEstimates.begin(), queueEstimates.end(), [&message, confidence](const QueueEstimates& estimate) {
+        message += '\n' + estimate.name + '\t' + estimate.maxCont.getString(confidence) + '\t' + estimate.entries.getString(confidence) \
+            + '\t' + estimate.aveCont.getString(confidence) + '\t' + estimate.aveTime.getString(confidence);
+    });
+
+    message += "\n\nSTORAGE\t\tMAX.\t\t\tENTRIES\t\t\tAVE.C.\t\t\tUTIL.";
+    std::for_each(storageEstimates.begin(), storageEstimates.end(), [&message, confidence](const StorageEstimates& estimate) {
+        message += '\n' + estimate.name + '\t' + estimate.maxCont.getString(confidence) + '\t' + estimate.entries.getString(confidence) \
+            + '\t' + estimate.aveCont.getString(confidence) + '\t' + estimate.util.getString(confidence);
+    });
+
+    std::vector<TableStat> tableStats = this->getTableStats();
+    if (!tableStats.empty()) {
+        message += "\n" + Tables::getFinalStatString(tableStats);
+    }
+    return message;
+}
+
+std::string Replications::getDifferenceString(Replications& baseline, double confidence) {
+    std::vector<QueueEstimates> queueDifferences = this->getQueueDifferences(baseline);
+    std::vector<StorageEstimates> storageDifferences = this->getStorageDifferences(baseline);
+    std::string message = '\"' + _modelName + "\" - \"" + baseline._modelName + "\" paired differences: " + std::to_string(_runs.size()) \
+        + " runs each" + (_antithetic ? " (antithetic pairs)" : "") + ", confidence: " + std::to_string(confidence);
+    auto getString = [confidence](const Estimator& difference) {
+        return difference.getString(confidence) + (std::fabs(difference.getMean()) > difference.getHalfWidth(confidence) ? " *\t" : "\t");
+    };
+
+    message += "\n\nQUEUE\t\tMAX\t\t\tENTRY\t\t\tAVE.CONT.\t\tAVE.TIME";
+    std::for_each(queueDifferences.begin(), queueDifferences.end(), [&message, &getString](const QueueEstimates& difference) {
+        message += '\n' + difference.name + '\t' + getString(difference.maxCont) + getString(difference.entries) \
+            + getString(difference.aveCont) + getString(difference.aveTime);
+    });
+
+    message += "\n\nSTORAGE\t\tMAX.\t\t\tENTRIES\t\t\tAVE.C.\t\t\tUTIL.";
+    std::for_each(storageDifferences.begin(), storageDifferences.end(), [&message, &getString](const StorageEstimates& difference) {
+        message += '\n' + difference.name + '\t' + getString(difference.maxCont) + getString(difference.entries) \
+            + getString(difference.aveCont) + getString(difference.util);
+    });
+    return message;
+}
@@ -1,21 +1,58 @@
 #pragma once
 
-#include <random>
 #include <list>
 #include <vector> 
 #include <string>
 #include <fstream> 
 #include <iostream>
+#include <cstdio> //std::rename
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <algorithm> //string.replace
 #include <functional> //[](){} - lambda func
 
 #include "Transact.h"
+#include "TransactPool.h"
 #include "EventChain.h"
+#include "FutureEventChain.h"
 #include "Storages.h"
 #include "SimLogs.h"
 #include "Queues.h"
 #include "Links.h"
+#include "Tables.h"
+#include "RandomStreams.h"
+#include "Estimators.h"
+#include "EventTrace.h"
+#include "TimeSeries.h"
+#include "BlockProgram.h"
+#include "Profiler.h"
+#include "Checkpoint.h"
+
+//statistics of all entities at one model time
+struct ModelStats {
+    long double modelTime;
+    std::vector<QueueStat> queueStats;
+    std::vector<StorageStat> storageStats;
+    std::vector<LinkStat> linkStats;
+    std::vector<TableStat> tableStats;
+};
+
+//time average of an entity content watched by SimCPP::batchMeans: content of a queue (Q$), utilization of a storage (SU$)
+//or size of a user chain (CH$), observed as the average over every sampleInterval
+enum class MetricType { QUEUE, STORAGE, LINK };
+
+struct OutputMetric {
+    std::string name;
+    MetricType type;
+    unsigned int entity; //handle
+    long double sampleInterval;
+    double relativePrecision; //of the stop, 0 is none
+    double confidence;
+    BatchMeans batchMeans;
+    long double nextSample; //end of the open interval
+    long double prevArea; //integral of the content at its start
+};
 
 class SimCPP {
     private:
@@ -24,78 +61,339 @@ class SimCPP {
         long double _modelTime; //current model time
         unsigned int _counter;  //analog GPSS START directive argument (START _counter)
 
-        EventChain _FEC; //feature event chain
+        TransactPool _pool;
+        FutureEventChain* _FEC; //feature event chain
+        FECType _FECEngine;
         EventChain _CEC; //current event chain
         EventChain::iterator _CECIt;
         Links _links;
         SimLogs* _simLogs;
         Storages _storages;
         Queues _queues;
+        Tables _tables;
+        SymbolTable<ParamId> _paramNames;
+        SymbolTable<VariableId> _variableNames;
+        std::vector<Expression*> _variables; //indexed by VariableId, bound at definition, a redefinition keeps the object
+        RandomStreams _random;
+        std::vector<QueueStat> _queueStats; //final statistics, taken when the model completes
+        std::vector<StorageStat> _storageStats;
+        std::vector<LinkStat> _linkStats;
+        std::vector<TableStat> _tableStats;
+        long double _resetTime; //of the last RESET, statistics are measured from here
+
+        //automatic warm-up detection, content of _warmupQueue is sampled every _warmupInterval (0 is off)
+        QueueId _warmupQueue;
+        long double _warmupInterval;
+        long double _nextWarmupSample;
+        unsigned int _warmupMinBatches;
+        MSER5 _warmupSeries;
+
+        void sampleWarmup();
+
+        std::vector<OutputMetric> _metrics;
+
+        long double getArea(const OutputMetric& metric, long double time);
+        bool sampleMetrics(long double nextTime); //true when every metric with a stop precision has reached it
+        void complete(unsigned long transactID, unsigned int state, const std::string& reasonOfEnding); //the end of the run, stats and logs
+
+        EventTrace* _trace; //binary trace, nullptr is off
+        unsigned int _tracedNames[4]; //names of storages, queues, links and parameters already in the trace
+        unsigned long _snapshotInterval; //chain deltas are traced when positive, with a full snapshot every _snapshotInterval records
+        unsigned long _nextSnapshot;
+
+        //time series of the entity contents, not owned, nullptr is off
+        TimeSeries* _series;
+        long double _seriesInterval; //0 is a row on every change of the contents
+        long double _nextSeriesSample;
+        std::vector<double> _seriesRow; //the last row
+        unsigned int _seriesEntities[3]; //queues, storages and user chains in the columns
+
+        void sampleSeries(long double nextTime); //before the promotion to nextTime
+        void addSeriesRow(long double time, bool onChange);
+
+        //GPSS block counts indexed by state, ENTRY since the last RESET and CURRENT
+        std::vector<unsigned long> _blockEntries;
+        std::vector<unsigned long> _blockCurrent;
+        unsigned int _prevState; //block the active transact has left at the last sysEvent
+        unsigned long _eventsNumb; //block executions of the profiled runs
+        Profiler _profiler;
+
+        void countEntry(Transact* transact, unsigned int state); //the transact moves into the block
+        bool promote(); //the transacts of the next time from the FEC to the CEC, false when batchMeans ends the run
+        unsigned int moveActive(); //the active transact enters its next block, gives the block number
+        void traceNames();
+        void traceEvent(TraceEvent type, Transact* transact, unsigned int entity = 0, double value = 0);
+        void traceChain(TraceEvent type, TraceEntity chain, unsigned int chainId, Transact* transact); //after the insertion
+        void traceSnapshot();
+
+        std::vector<Block> _program; //loaded block program, block N at N - 1
+        bool _programPrimed; //the first transacts of the GENERATE blocks are made
+
+        void saveTransact(CheckpointWriter& writer, Transact* transact);
+        Transact* restoreTransact(CheckpointReader& reader);
+        unsigned long saveChain(CheckpointWriter& writer, EventChain& chain); //gives the number of transacts
+        void restoreChain(CheckpointReader& reader, EventChain& chain); //at the end of the chain
+
+        //interpreter handlers of the block types, load sets one on every block; run calls them only while the model runs
+        static BlockHandler getHandler(BlockType type);
+        void executeGenerate(Block& block);
+        void executeTerminate(Block& block) { this->terminate(block.count); }
+        void executeAdvance(Block& block) { this->doAdvance(this->getValue(block.A)); }
+        void executeTest(Block& block) { this->test(this->getValue(block.A) != 0, block.targetBlock); }
+        void executeTransfer(Block& block) { this->transfer(block.targetBlock); }
+        void executeAssign(Block& block) { this->assign(ParamId {block.handle}, this->getValue(block.A)); }
+        void executeEnter(Block& block) { this->doEnter(StorageId {block.handle}, block.count); }
+        void executeLeave(Block& block) { this->doLeave(StorageId {block.handle}, block.count); }
+        void executeQueue(Block& block) { this->doQueue(QueueId {block.handle}); }
+        void executeDepart(Block& block) { this->doDepart(QueueId {block.handle}); }
+        void executeTabulate(Block& block) { this->doTabulate(TableId {block.handle}, this->getValue(block.A), block.count); }
+        void executeLink(Block& block) { this->doLink(LinkId {block.handle}, block.order, ParamId {block.paramHandle}); }
+        void executeUnlink(Block& block);
+        long double getValue(const Operand& operand);
+        void rebind(Expression& expression); //bound to another model with the same handles, puts the objects of this one
+        bool refersTo(const Expression& expression, const Expression* variable); //directly or through other variables
 
         //void SimCPPEnd();
     public:
-        SimCPP (std::string modelName): _modelName(modelName), _maxId(1), _modelTime(.0), _counter(0), \
-             _FEC("FEC"), _CEC("CEC"), _simLogs(nullptr) { _CECIt = _CEC.begin(); }
+        SimCPP (std::string modelName, FECType FECEngine = FECType::BINARY_HEAP): _modelName(modelName), _maxId(1), _modelTime(.0), _counter(0), \
+             _FEC(FutureEventChain::create(FECEngine)), _FECEngine(FECEngine), _CEC("CEC"), _simLogs(nullptr), _resetTime(0), _warmupQueue {0}, \
+             _warmupInterval(0), _nextWarmupSample(0), _warmupMinBatches(20), _trace(nullptr), _tracedNames {0, 0, 0, 0}, \
+             _snapshotInterval(0), _nextSnapshot(0), _series(nullptr), \
+             _seriesInterval(0), _nextSeriesSample(0), _seriesEntities {0, 0, 0}, _prevState(0), _eventsNumb(0), \
+             _programPrimed(false) { _CECIt = _CEC.begin(); _paramNames.intern("M1"); }
 
-        ~SimCPP() {if (_simLogs != nullptr) {delete _simLogs;};};
+        ~SimCPP();
 
         bool isRunning();
         unsigned int sysEvent();
         long double getModelTime();
+        unsigned long getFECSize() { return _FEC->size(); }
 
         void start(unsigned int count, std::ofstream* sysEvLog = nullptr, std::ofstream* statLog = nullptr, \
                   std::ofstream* transactLog = nullptr, std::ofstream* CFECLog = nullptr);
-        void storage(const std::string storageName, const unsigned int maxChannels);
+        StorageId storage(const std::string& storageName, const unsigned int maxChannels);
+        //GPSS TABLE and QTABLE: classesNumb frequency classes of width from upperLimit (the first one is value <= upperLimit, the last one
+        //has no limit), quantiles come from a sketch with the relative error sketchAccuracy (0 is off, then from the classes);
+        //QTABLE tabulates the queue time of every DEPART from the queue
+        TableId table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy = 0.01);
+        TableId qtable(const std::string& tableName, QueueId queueId, long double upperLimit, long double width, unsigned int classesNumb, \
+            double sketchAccuracy = 0.01);
         void initGenerate(unsigned int birthState, long double birthTime);
         void generate(long double birthDelayInterval);
         void terminate(unsigned int reduceCounter = 0);
-        void assign(const std::string paramName, const long double value);
         void test(const bool switchRoute, const unsigned int ifFalseState);
-
-        void queue(const std::string queueName);
-        void depart(const std::string queueName);
-
         void advance(long double delay);
-        void enter(const std::string name, const unsigned int numbOfChannels = 1);
-        void leave(const std::string name, const unsigned int numbOfChannels = 1);
         void transfer(const unsigned int nextState);
-        void link(const std::string linkName, const std::string discipline);
-        void unlink(const std::string linkName, const unsigned int nextState, const unsigned int numbReleasedTrans);
-        unsigned int getStorageParam(const std::string storageName, const std::string SNA);
-        unsigned int getLinkParam(const std::string linkName, const std::string SNA);
-        double exponential(double mean);
+
+        //table-driven model: load declares the storages of the program and resolves its names and labels (before start),
+        //run makes the first transacts of the GENERATE blocks and moves transacts through the blocks until the model completes
+        void load(const BlockProgram& program);
+        void run();
+        const std::vector<Block>& getProgram() { return _program; }
+
+        //compiled expressions: bind puts the handles of this model into the SNAs (once), evaluate runs the code for the active transact
+        void bind(Expression& expression);
+        long double evaluate(const Expression& expression);
+
+        //GPSS VARIABLE, FVARIABLE and BVARIABLE: the text is compiled once, V$name, FV$name and BV$name of later expressions
+        //and the calls below evaluate the code, a redefinition changes the variable for the expressions already bound to it
+        VariableId variable(const std::string& name, const std::string& text, VariableType type = VariableType::VARIABLE);
+        VariableId getVariableId(const std::string& name) { return _variableNames.find(name); }
+        long double getVariable(VariableId variableId) { return this->evaluate(*_variables[variableId.id]); }
+        void test(VariableId variableId, const unsigned int ifFalseState) { this->test(this->getVariable(variableId) != 0, ifFalseState); }
+        void assign(ParamId paramId, VariableId variableId) { this->assign(paramId, this->getVariable(variableId)); }
+
+        //checkpoint of the model between runs (not while it is running): transacts in the FEC, CEC, user chains and delay chains,
+        //entity contents and statistics, tables, random number streams, warm-up detection, batch means and block counts;
+        //restore puts it into a model that is defined by the same code (entities, variables and the loaded program) and is not
+        //started yet, then start and run go on as the saved model would, with the same draws; the storages of the model may have
+        //larger capacities (fork). Logs, the trace and the time series
+        //are not in the checkpoint, they are set again after restore. The file is written to fileName.tmp and renamed,
+        //so a crash keeps the previous checkpoint whole; a failed restore leaves the model unusable
+        void save(std::ostream& stream);
+        void save(const std::string& fileName);
+        void restore(std::istream& stream);
+        void restore(const std::string& fileName);
+        //what-if branch of a completed run: a new model with the entities, variables and block program of this one, its state
+        //(as save and restore) and the random number streams reseeded by runSeed; capacities give other capacities to the named
+        //storages, not below the channels in use, and the waiting transacts that fit get their channels at once.
+        //The branch keeps no reference to this model, so branches run on threads of their own; the cost is of the live state
+        //and the model size, not of the run history
+        std::unique_ptr<SimCPP> fork(uint64_t runSeed, const std::vector<std::pair<std::string,unsigned int>>& capacities = {});
+
+        //GPSS RESET: statistics restart from the current model time, transacts and entity contents stay
+        void reset();
+        long double getResetTime() { return _resetTime; }
+        //MSER-5 on the content of the queue sampled every sampleInterval, the first detected end of warm-up makes a reset
+        void detectWarmup(QueueId queueId, long double sampleInterval, unsigned int minBatches = 20);
+        //batch means confidence interval of the time average of a queue content, a storage utilization or a user chain size,
+        //observed every sampleInterval from the last RESET in at least batchesNumb batches (BatchMeans);
+        //with a positive relativePrecision the run ends at the first sample where the half width of every such metric is
+        //not over relativePrecision * |mean|, sysEvent gives 0 then and the final statistics are of that model time
+        unsigned int batchMeans(QueueId queueId, long double sampleInterval, double relativePrecision = 0, double confidence = 0.95, \
+            unsigned int batchesNumb = 10);
+        unsigned int batchMeans(StorageId storageId, long double sampleInterval, double relativePrecision = 0, double confidence = 0.95, \
+            unsigned int batchesNumb = 10);
+        unsigned int batchMeans(LinkId linkId, long double sampleInterval, double relativePrecision = 0, double confidence = 0.95, \
+            unsigned int batchesNumb = 10);
+        const std::vector<OutputMetric>& getMetrics() { return _metrics; }
+        std::string getMetricsString();
+
+        //GPSS block counts of a state (block number): ENTRY since the last RESET and CURRENT transacts in it
+        unsigned long getBlockEntries(unsigned int state) { return state < _blockEntries.size() ? _blockEntries[state] : 0; }
+        unsigned long getBlockCurrent(unsigned int state) { return state < _blockCurrent.size() ? _blockCurrent[state] : 0; }
+        unsigned long getEventsNumb() { return _eventsNumb; } //block executions of all the runs of the model
+        //block counts, events per second of the runs and their time by engine phase, the phases need SIMCPP_PROFILE
+        std::string getProfileString();
+        Profiler& getProfiler() { return _profiler; }
+
+        //binary event records for the offline decoder, the trace is not owned, nullptr turns it off;
+        //a positive chainSnapshotInterval adds the insertions and removals of FEC, CEC and user chains
+        //with a full snapshot of the chains every chainSnapshotInterval records, instead of the CFECLog dumps
+        void setTrace(EventTrace* trace, unsigned long chainSnapshotInterval = 0);
+        //contents of the queues, storages and user chains over model time, the series is not owned, nullptr turns it off;
+        //a row every sampleInterval (the state before the events of the sample time, as detectWarmup) or,
+        //with 0, a row at every model time where a content has changed; the columns are the entities of the first row
+        void setSeries(TimeSeries* series, long double sampleInterval = 0);
+
+        //final statistics of the completed run (the last "start"), empty before the end
+        const std::vector<QueueStat>& getQueueStats() { return _queueStats; }
+        const std::vector<StorageStat>& getStorageStats() { return _storageStats; }
+        const std::vector<LinkStat>& getLinkStats() { return _linkStats; }
+        const std::vector<TableStat>& getTableStats() { return _tableStats; }
+        //statistics at the current model time, they may be taken at any time, the accumulators are not touched, O(entities)
+        ModelStats getStats() { return ModelStats {_modelTime, _queues.getFinalStats(_modelTime), _storages.getFinalStats(_modelTime), \
+            _links.getFinalStats(_modelTime), _tables.getFinalStats()}; }
+
+        //GPSS random number streams (numbered from 1) and distributions
+        void rmult(uint64_t runSeed) { _random.rmult(runSeed); }
+        void rmult(const std::vector<uint64_t>& seeds) { _random.rmult(seeds); }
+        void setVariateBuffering(bool buffering) { _random.setBuffering(buffering); } //block generated variates, same values either way
+        void setAntithetic(bool antithetic) { _random.setAntithetic(antithetic); } //all streams draw 1 - U instead of U
+        double exponential(double mean) { return _random.exponential(1, 0, mean); } //stream 1
+        double exponential(unsigned int streamNumb, double locate, double scale) { return _random.exponential(streamNumb, locate, scale); }
+        double uniform(unsigned int streamNumb, double min, double max) { return _random.uniform(streamNumb, min, max); }
+        double normal(unsigned int streamNumb, double mean, double stdDev) { return _random.normal(streamNumb, mean, stdDev); }
+        double erlang(unsigned int streamNumb, double locate, double scale, unsigned int shape) \
+            { return _random.erlang(streamNumb, locate, scale, shape); }
+        double triangular(unsigned int streamNumb, double min, double max, double mode) { return _random.triangular(streamNumb, min, max, mode); }
+        double weibull(unsigned int streamNumb, double locate, double scale, double shape) { return _random.weibull(streamNumb, locate, scale, shape); }
+        double empirical(unsigned int streamNumb, EmpiricalFunction& function) { return _random.empirical(streamNumb, function); }
+
+        //names are resolved once into handles
+        StorageId getStorageId(const std::string& storageName) { return _storages.getId(storageName); }
+        QueueId getQueueId(const std::string& queueName) { return _queues.getId(queueName); }
+        LinkId getLinkId(const std::string& linkName) { return _links.getId(linkName); }
+        TableId getTableId(const std::string& tableName) { return _tables.getId(tableName); } //throws for undefined tables
+        ParamId getParamId(const std::string& paramName);
+
+        void assign(ParamId paramId, const long double value);
+        void queue(QueueId queueId);
+        void depart(QueueId queueId);
+        void tabulate(TableId tableId, long double value, unsigned long count = 1); //GPSS TABULATE, count is the weight
+        void enter(StorageId storageId, const unsigned int numbOfChannels = 1);
+        void leave(StorageId storageId, const unsigned int numbOfChannels = 1);
+        void link(LinkId linkId, LinkOrder order) { this->checkRunning(); this->doLink(linkId, order, ParamId {0}); }
+        void link(LinkId linkId, ParamId paramId) { this->checkRunning(); this->doLink(linkId, LinkOrder::PARAM, paramId); }
+        //GPSS UNLINK A,B,C from the head, UNLINK A,B,C,BACK and UNLINK A,B,C,paramId,value
+        void unlink(LinkId linkId, const unsigned int nextState, const unsigned int numbReleasedTrans, UnlinkFrom from = UnlinkFrom::HEAD, \
+            ParamId paramId = ParamId {0}, long double value = 0);
+        unsigned int getStorageParam(StorageId storageId, SNA attribute);
+        unsigned int getLinkParam(LinkId linkId, SNA attribute);
+
+        //compatibility layer by names, every call resolves the names
+        void assign(const std::string& paramName, const long double value) { this->assign(this->getParamId(paramName), value); }
+        void queue(const std::string& queueName) { this->queue(_queues.getId(queueName)); }
+        void depart(const std::string& queueName) { this->depart(_queues.getId(queueName)); }
+        void enter(const std::string& name, const unsigned int numbOfChannels = 1) { this->enter(_storages.getId(name), numbOfChannels); }
+        void leave(const std::string& name, const unsigned int numbOfChannels = 1) { this->leave(_storages.getId(name), numbOfChannels); }
+        void link(const std::string& linkName, const std::string& discipline);
+        void unlink(const std::string& linkName, const unsigned int nextState, const unsigned int numbReleasedTrans) \
+            { this->unlink(_links.getId(linkName), nextState, numbReleasedTrans); }
+        unsigned int getStorageParam(const std::string& storageName, const std::string& SNAName) \
+            { return this->getStorageParam(_storages.getId(storageName), parseSNA(SNAName)); }
+        unsigned int getLinkParam(const std::string& linkName, const std::string& SNAName) \
+            { return this->getLinkParam(_links.getId(linkName), parseSNA(SNAName)); }
+    private:
+        //the block methods without the check that the model is running, the public ones check it for hand-written models
+        void checkRunning();
+        void doGenerate(long double birthDelayInterval);
+        void doAdvance(long double delay);
+        void doQueue(QueueId queueId);
+        void doDepart(QueueId queueId);
+        void doTabulate(TableId tableId, long double value, unsigned long count);
+        void doEnter(StorageId storageId, const unsigned int numbOfChannels);
+        void doLeave(StorageId storageId, const unsigned int numbOfChannels);
+        void doLink(LinkId linkId, LinkOrder order, ParamId paramId);
+        void doUnlink(LinkId linkId, const unsigned int nextState, const unsigned int numbReleasedTrans, UnlinkFrom from, ParamId paramId, long double value);
 };
 
 //-----
 
-unsigned int SimCPP::getLinkParam(const std::string linkName, const std::string SNA) {
-        if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
+SimCPP::~SimCPP() {
+    delete _FEC;
+    std::for_each(_variables.begin(), _variables.end(), [](Expression* variable){ delete variable; });
+    if (_simLogs != nullptr) {
+        delete _simLogs;
     }
-    return _links.getLinkParam(linkName, SNA);
 }
 
-void SimCPP::queue(const std::string queueName) {
-    Transact* currTransact;
+ParamId SimCPP::getParamId(const std::string& paramName) {
+    if (!_paramNames.contains(paramName) && _paramNames.size() == TRANSACT_PARAMS_NUMB) {
+        throw std::logic_error("Transact cannot have more than " + std::to_string(TRANSACT_PARAMS_NUMB) + " parameters (" + paramName + ')');
+    }
+    return _paramNames.intern(paramName);
+}
 
+unsigned int SimCPP::getLinkParam(LinkId linkId, SNA attribute) {
     if (!this->isRunning()) {
         throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
     }
+    return _links.getLinkParam(linkId, attribute);
+}
+
+void SimCPP::queue(QueueId queueId) {
+    this->checkRunning();
+    this->doQueue(queueId);
+}
+
+void SimCPP::doQueue(QueueId queueId) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    Transact* currTransact;
 
     currTransact = *_CECIt;
-    _queues.queue(queueName, currTransact);
+    _queues.queue(queueId, currTransact);
+    this->traceEvent(TraceEvent::QUEUE, currTransact, queueId.id);
     (currTransact)->setNextState((currTransact)->getCurrentState()+1);
 }
 
-void SimCPP::depart(const std::string queueName) {
+void SimCPP::depart(QueueId queueId) {
+    this->checkRunning();
+    this->doDepart(queueId);
+}
+
+void SimCPP::doDepart(QueueId queueId) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
     Transact* currTransact;
 
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
-    }
+    currTransact = *_CECIt;
+    long double queueTime = _queues.depart(queueId, currTransact);
+    _tables.depart(queueId, queueTime);
+    this->traceEvent(TraceEvent::DEPART, currTransact, queueId.id);
+    (currTransact)->setNextState((currTransact)->getCurrentState()+1);
+}
+
+void SimCPP::tabulate(TableId tableId, long double value, unsigned long count) {
+    this->checkRunning();
+    this->doTabulate(tableId, value, count);
+}
+
+void SimCPP::doTabulate(TableId tableId, long double value, unsigned long count) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    Transact* currTransact;
 
     currTransact = *_CECIt;
-    _queues.depart(queueName, currTransact);
+    _tables.tabulate(tableId, value, count);
     (currTransact)->setNextState((currTransact)->getCurrentState()+1);
 }
 
@@ -107,36 +405,42 @@ void SimCPP::test(const bool switchRoute, const unsigned int ifFalseState) {
         currTransact->setNextState(currTransact->getCurrentState()+1);
     else
         currTransact->setNextState(ifFalseState);
+    this->traceEvent(TraceEvent::TEST, currTransact, 0, currTransact->getNextState());
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"test\" Xact:" + std::to_string(currTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                     + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                     + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(currTransact->getID()) + " at state: " + std::to_string(currTransact->getCurrentState()) + "; model time: " \
                                 + std::to_string(_modelTime) + ": tested and will transfered to state:" + std::to_string(currTransact->getNextState());                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
-void SimCPP::assign(const std::string paramName, const long double value) {
+void SimCPP::assign(ParamId paramId, const long double value) {
     Transact* currTransact = *_CECIt;
     std::string message;
 
-    currTransact->setParam(paramName, value);
+    currTransact->setParam(paramId, value);
     currTransact->setNextState(currTransact->getCurrentState()+1);
+    this->traceEvent(TraceEvent::ASSIGN, currTransact, paramId.id, value);
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"assign parameter\" Xact:" + std::to_string(currTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                     + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                     + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(currTransact->getID()) + " at state: " + std::to_string(currTransact->getCurrentState()) + "; model time: " \
-                                + std::to_string(_modelTime) + ": assign parameter: \"" + paramName + "\" with value:" + std::to_string(value);                 
+                                + std::to_string(_modelTime) + ": assign parameter: \"" + _paramNames.getName(paramId) + "\" with value:" + std::to_string(value);                 
         _simLogs->logMess_transactLog(message);
     }
 }
@@ -145,14 +449,17 @@ void SimCPP::transfer(const unsigned int nextState) {
     std::string message;
     Transact* currTransact = *_CECIt;
     currTransact->setNextState(nextState);
+    this->traceEvent(TraceEvent::TRANSFER, currTransact, 0, nextState);
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"transfer\" Xact:" + std::to_string(currTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                     + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                     + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(currTransact->getID()) + " at state: " + std::to_string(currTransact->getCurrentState()) + "; model time: " \
                                 + std::to_string(_modelTime) + ": transfered to pos:" + std::to_string(nextState);                 
         _simLogs->logMess_transactLog(message);
@@ -160,116 +467,235 @@ void SimCPP::transfer(const unsigned int nextState) {
 }
 
 void SimCPP::advance(long double delay) {
+    this->checkRunning();
+    this->doAdvance(delay);
+}
+
+void SimCPP::doAdvance(long double delay) {
+    SIMCPP_PROFILE_SCOPE(FEC);
     Transact* currTransact;
     std::string message;
 
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
-    }
-
     currTransact = *_CECIt;
+    if (!(delay >= 0) || std::isinf(delay)) {
+        throw std::logic_error("ADVANCE at block " + std::to_string(currTransact->getCurrentState()) + ", Xact:" + std::to_string(currTransact->getID()) \
+            + ": the delay must be a finite nonnegative number, it is " + std::to_string(delay));
+    }
     _CECIt++;
 
     currTransact->setNextState(currTransact->getCurrentState()+1); 
     currTransact->setTime(_modelTime + delay);
     _CEC.eraseTrans(currTransact);
-    _FEC.emplace(std::find_if(_FEC.begin(),_FEC.end(),[ currTransact ](Transact* transact) {return currTransact->getTime() < transact->getTime();}), currTransact);
+    _FEC->push(currTransact);
+    this->traceEvent(TraceEvent::ADVANCE, currTransact, 0, delay);
+    this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::CEC, 0, currTransact);
+    this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::FEC, 0, currTransact);
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
                 message = "\"advance\" Xact:" + std::to_string(currTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                     + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                     + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
                 _simLogs->logMess_CFECLog(message);
         }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(currTransact->getID()) + " at state: " + std::to_string(currTransact->getCurrentState()) + "; model time: " \
                                 + std::to_string(_modelTime) + ": advanced";                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
-void SimCPP::generate(long double birthDelayInterval) { 
+void SimCPP::generate(long double birthDelayInterval) {
+    this->checkRunning();
+    this->doGenerate(birthDelayInterval);
+}
+
+void SimCPP::doGenerate(long double birthDelayInterval) {
+    SIMCPP_PROFILE_SCOPE(FEC);
     Transact* currTransact = *_CECIt;
     std::string message;
 
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
+    if (!(birthDelayInterval >= 0) || std::isinf(birthDelayInterval)) {
+        throw std::logic_error("GENERATE at block " + std::to_string(currTransact->getCurrentState()) \
+            + ": the interval must be a finite nonnegative number, it is " + std::to_string(birthDelayInterval));
     }
 
     (currTransact)->setNextState((currTransact)->getCurrentState()+1); 
 
-    Transact* newTransact = new Transact(_maxId++,_modelTime + birthDelayInterval, 0, currTransact->getCurrentState());
-    _FEC.emplace(std::find_if(_FEC.begin(),_FEC.end(),[ newTransact ](Transact* transact) {return newTransact->getTime() < transact->getTime();}), newTransact);
+    Transact* newTransact = _pool.acquire(_maxId++,_modelTime + birthDelayInterval, 0, currTransact->getCurrentState());
+    _FEC->push(newTransact);
+    if (_trace != nullptr) {
+        this->traceNames();
+        _trace->record(TraceEvent::GENERATE, newTransact->getID(), currTransact->getCurrentState(), _modelTime, 0, newTransact->getTime());
+        this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::FEC, 0, newTransact);
+    }
 
     //making logs
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(currTransact->getID()) + " at state: " + std::to_string((currTransact)->getCurrentState()) + "; model time: " \
                             + std::to_string(_modelTime) + ": generated a Xact:" + std::to_string((currTransact)->getID()) + " with birth time " \
                             + std::to_string((currTransact)->getTime()) + " at birth state " + std::to_string((currTransact)->getCurrentState()); 
         _simLogs->logMess_transactLog(message);
     }
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"generation\" Xact:" + std::to_string(newTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                 + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                 + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 };
 
 void SimCPP::initGenerate(unsigned int birthState, long double birthTime) {
+    SIMCPP_PROFILE_SCOPE(FEC);
     std::string message;
 
     if (!this->isRunning()) {
         throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
     }
+    if (!(birthTime >= _modelTime) || std::isinf(birthTime)) {
+        throw std::logic_error("GENERATE at block " + std::to_string(birthState) + ": the first transact time must be finite and not before the model time, it is " \
+            + std::to_string(birthTime));
+    }
 
-    Transact* newTransact = new Transact(_maxId++,birthTime, 0, birthState);
-    _FEC.emplace(std::find_if(_FEC.begin(),_FEC.end(),[ newTransact ](Transact* transact) {return newTransact->getTime() < transact->getTime();}), newTransact);
+    Transact* newTransact = _pool.acquire(_maxId++,birthTime, 0, birthState);
+    _FEC->push(newTransact);
+    if (_trace != nullptr) {
+        this->traceNames();
+        _trace->record(TraceEvent::INIT_GENERATE, newTransact->getID(), birthState, _modelTime, 0, birthTime);
+        this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::FEC, 0, newTransact);
+    }
 
     //making logs
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string(newTransact->getID()) + " generating an initializing transact with birth time " \
                             + std::to_string(newTransact->getTime()) + " at birth state " + std::to_string(newTransact->getNextState());                 
         _simLogs->logMess_transactLog(message);
     }
     
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"init generation\" Xact:" + std::to_string(newTransact->getID()) + " model time: " + std::to_string(_modelTime) \
-                                     + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                                     + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 };
 
 unsigned int SimCPP::sysEvent() {
+    if (_CECIt == _CEC.end() && !this->promote()) {
+        return 0;
+    }
+    return this->moveActive();
+}
+
+bool SimCPP::promote() {
     std::string message;
     Transact* replTransact;
-    //if we cant move trans we skip it
-    _CECIt = _CEC.skipBlocked(_CECIt);
 
     //moving transactions from FEC to CEC if _CECIt at end
     while (_CECIt == _CEC.end()) {
-        replTransact = *(_FEC.begin());
+        SIMCPP_PROFILE_SCOPE(PROMOTION);
+        if (_FEC->empty()) {
+            throw std::logic_error("Future event chain is empty, the model has nothing to simulate");
+        }
+        replTransact = _FEC->top();
+        if (_series != nullptr) {
+            this->sampleSeries(replTransact->getTime());
+        }
+        if (!_metrics.empty() && this->sampleMetrics(replTransact->getTime())) {
+            this->complete(0, 0, "Simulation is ended, the precision of the batch means is reached!");
+            return false;
+        }
         _modelTime = replTransact->getTime();
+        if (_warmupInterval > 0) {
+            this->sampleWarmup();
+        }
         auto aaIt = std::find_if(_CEC.begin(), _CEC.end(), [ replTransact ](Transact* transact) {return replTransact->getTime() < transact->getTime();});
         _CEC.emplace(aaIt, replTransact);
         //_CEC.emplace(replTransact, [ replTransact ](Transact* transact) {return replTransact->getTime() < transact->getTime();});
         
-        _FEC.erase(_FEC.begin());
+        _FEC->pop();
+        if (_trace != nullptr) {
+            this->traceNames();
+            _trace->record(TraceEvent::PROMOTION, replTransact->getID(), replTransact->getNextState(), _modelTime);
+            this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::FEC, 0, replTransact);
+            this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::CEC, 0, replTransact);
+            if (_snapshotInterval > 0 && _trace->getRecordsNumb() >= _nextSnapshot) {
+                this->traceSnapshot();
+            }
+        }
         _CECIt = _CEC.begin();
-        _CECIt = _CEC.skipBlocked(_CECIt);
 
         if (_simLogs->isEnable_CFECLog()) {
+            SIMCPP_PROFILE_SCOPE(LOGGING);
             message = "\"promotion of model time\" Xact:" + std::to_string(replTransact->getID()) + " model time: " + std::to_string(_modelTime)\
-                             + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                             + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
             _simLogs->logMess_CFECLog(message);
         }
     }
+    return true;
+}
 
+unsigned int SimCPP::moveActive() {
     (*_CECIt)->setTime(_modelTime);
 
-    (*_CECIt)->setCurrentState((*_CECIt)->getNextState());
-    return (*_CECIt)->getCurrentState();
+    unsigned int state = (*_CECIt)->getNextState();
+    _prevState = (*_CECIt)->getCurrentState();
+    this->countEntry(*_CECIt, state);
+    _eventsNumb++;
+    return state;
 };
 
+void SimCPP::countEntry(Transact* transact, unsigned int state) {
+    if (state >= _blockEntries.size()) {
+        _blockEntries.resize(state + 1, 0);
+        _blockCurrent.resize(state + 1, 0);
+    }
+    if (transact->getCurrentState() != 0) {
+        _blockCurrent[transact->getCurrentState()]--;
+    }
+    _blockEntries[state]++;
+    _blockCurrent[state]++;
+    transact->setCurrentState(state);
+}
+
+void SimCPP::complete(unsigned long transactID, unsigned int state, const std::string& reasonOfEnding) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    std::string message;
+
+    _counter = 0;
+    _queueStats = _queues.getFinalStats(_modelTime);
+    _storageStats = _storages.getFinalStats(_modelTime);
+    _linkStats = _links.getFinalStats(_modelTime);
+    _tableStats = _tables.getFinalStats();
+    if (_series != nullptr && _seriesInterval == 0) {
+        this->addSeriesRow(_modelTime, true);
+    }
+
+    if (_simLogs->isEnable_StatLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
+        message = Queues::getFinalStatString(_queueStats);
+        message += '\n' + Storages::getFinalStatString(_storageStats);
+        message += '\n' + Links::getFinalStatString(_linkStats);
+        if (!_tableStats.empty()) {
+            message += '\n' + Tables::getFinalStatString(_tableStats);
+        }
+        if (!_metrics.empty()) {
+            message += '\n' + this->getMetricsString();
+        }
+        _simLogs->logMess_statLog(message);
+    }
+    _simLogs->modelEndMess(reasonOfEnding);
+    if (_trace != nullptr) {
+        _trace->record(TraceEvent::END, transactID, state, _modelTime);
+    }
+    delete _simLogs;
+    _simLogs = nullptr;
+    _profiler.stop();
+}
+
 void SimCPP::terminate(unsigned int reduceCounter) {
     Transact* termTrans = *_CECIt;
     unsigned int termTransID = termTrans->getID();
@@ -278,36 +704,32 @@ void SimCPP::terminate(unsigned int reduceCounter) {
     EventChain::iterator futIt = _CECIt;
     futIt++;
 
-    if (reduceCounter >= this->_counter) {
-        _counter = 0;
+    this->traceEvent(TraceEvent::TERMINATE, termTrans, 0, reduceCounter);
 
-        if (_simLogs->isEnable_StatLog()) {
-            message = _queues.getFinalStatString(_modelTime);
-            message += '\n' + _storages.getFinalStatString(_modelTime);
-            _simLogs->logMess_statLog(message);
-        }
-        _simLogs->modelEndMess("Simulation is ended!");
-        delete _simLogs;
-        _simLogs = nullptr;        
+    //the model may be started again, so the terminating transact leaves in both cases
+    if (termTransCurrState != 0 && termTransCurrState < _blockCurrent.size()) {
+        _blockCurrent[termTransCurrState]--;
+    }
+    _CEC.erase(_CECIt);
+    this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::CEC, 0, termTrans);
+    _pool.release(termTrans);
+    _CECIt = futIt;
+
+    if (reduceCounter >= this->_counter) {
+        this->complete(termTransID, termTransCurrState, "Simulation is ended!");
     }
     else {
         _counter -= reduceCounter;
-        _CEC.erase(_CECIt);
-
-        if (_CEC.needReset()) {
-            futIt = _CEC.begin();
-            _CEC.setReset(false);
-        }
-
-        _CECIt = futIt;
 
         if (_simLogs->isEnable_CFECLog()) {
+            SIMCPP_PROFILE_SCOPE(LOGGING);
             message = "\"terminating\" Xact:" + std::to_string(termTransID) + " model time: " + std::to_string(_modelTime) \
-                        + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                        + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
             _simLogs->logMess_CFECLog(message);
         }
 
         if (_simLogs->isEnable_transactLog()) {
+            SIMCPP_PROFILE_SCOPE(LOGGING);
             message = "Xact:" + std::to_string(termTransID) + " at state: " + std::to_string(termTransCurrState) + "; model time: " \
                                 + std::to_string(_modelTime) + ": terminated";                 
             _simLogs->logMess_transactLog(message);
@@ -324,157 +746,1139 @@ bool SimCPP::isRunning() {
     return this->_counter != 0;
 };
 
+void SimCPP::checkRunning() {
+    if (!this->isRunning()) {
+        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
+    }
+}
+
 void SimCPP::start(unsigned int count, std::ofstream* sysEvLog, std::ofstream* statLog,  std::ofstream* transactLog, std::ofstream* CFECLog) {
     if (this->isRunning())
         throw std::logic_error("You cannot start the model until it completes");
     _simLogs = new SimLogs(sysEvLog, statLog, transactLog, CFECLog);
     _simLogs->modelInitMess(_modelName);
     
+    //a completed model goes on from its current state
     this->_counter = count;
-    this->_maxId = 1;
+    if (_trace != nullptr) {
+        _trace->record(TraceEvent::START, 0, 0, _modelTime, 0, count);
+    }
+    _queueStats.clear();
+    _storageStats.clear();
+    _linkStats.clear();
+    _tableStats.clear();
+    _profiler.start();
 }
 
-void SimCPP::enter(const std::string storageName, const unsigned int numbOfChannels) {
-    unsigned int seizedChannels;
-    Transact* currTransact;
-    std::string message;
+void SimCPP::setTrace(EventTrace* trace, unsigned long chainSnapshotInterval) {
+    _trace = trace;
+    _snapshotInterval = chainSnapshotInterval;
+    if (_trace != nullptr) {
+        std::fill(_tracedNames, _tracedNames + 4, 0);
+        _trace->name(TraceEntity::MODEL, 0, _modelName);
+        this->traceNames();
+        if (_snapshotInterval > 0) {
+            this->traceSnapshot(); //the chains may be filled already
+        }
+    }
+}
+
+void SimCPP::setSeries(TimeSeries* series, long double sampleInterval) {
+    if (sampleInterval < 0) {
+        throw std::logic_error("Sample interval of a time series cannot be negative");
+    }
+    _series = series;
+    _seriesInterval = sampleInterval;
+    _nextSeriesSample = _modelTime;
+    _seriesRow.clear();
+}
+
+void SimCPP::sampleSeries(long double nextTime) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    //the contents are still the ones before the events at nextTime
+    if (_seriesInterval > 0) {
+        while (_nextSeriesSample <= nextTime) {
+            this->addSeriesRow(_nextSeriesSample, false);
+            _nextSeriesSample += _seriesInterval;
+        }
+    }
+    else if (nextTime > _modelTime) {
+        this->addSeriesRow(_modelTime, true);
+    }
+}
+
+void SimCPP::addSeriesRow(long double time, bool onChange) {
+    if (_seriesRow.empty()) {
+        std::vector<std::string> names {"time"};
+        for (unsigned int i = 0; i < _queues._names.size(); i++) {
+            names.push_back("Q$" + _queues._names.getName(QueueId {i}));
+        }
+        for (unsigned int i = 0; i < _storages._names.size(); i++) {
+            names.push_back("S$" + _storages._names.getName(StorageId {i}));
+            names.push_back("SU$" + _storages._names.getName(StorageId {i}));
+        }
+        for (unsigned int i = 0; i < _links._names.size(); i++) {
+            names.push_back("CH$" + _links._names.getName(LinkId {i}));
+        }
+        if (_series->getNames().empty()) {
+            _series->setColumns(names);
+        }
+        _seriesRow.assign(names.size(), -1);
+        _seriesEntities[0] = _queues._names.size();
+        _seriesEntities[1] = _storages._names.size();
+        _seriesEntities[2] = _links._names.size();
+    }
+
+    //entities created after the first row are not in the series
+    bool changed = !onChange;
+    unsigned int column = 1;
+    auto put = [this, &changed, &column](double value) { changed = changed || _seriesRow[column] != value; _seriesRow[column++] = value; };
+    for (unsigned int i = 0; i < _seriesEntities[0]; i++) {
+        put(_queues.getContent(QueueId {i}));
+    }
+    for (unsigned int i = 0; i < _seriesEntities[1]; i++) {
+        unsigned int used = _storages.getStorageParam(StorageId {i}, SNA::CH);
+        unsigned int capacity = used + _storages.getStorageParam(StorageId {i}, SNA::R);
+        put(used);
+        put(capacity == 0 ? 0 : (double)used / capacity);
+    }
+    for (unsigned int i = 0; i < _seriesEntities[2]; i++) {
+        put(_links.getLinkParam(LinkId {i}, SNA::CH));
+    }
+    if (changed) {
+        _seriesRow[0] = time;
+        _series->add(_seriesRow);
+    }
+}
+
+void SimCPP::traceNames() {
+    //entities are created on the first reference, so new names are checked before every record
+    while (_tracedNames[0] < _storages._names.size()) {
+        _trace->name(TraceEntity::STORAGE, _tracedNames[0], _storages._names.getName(StorageId {_tracedNames[0]}));
+        _tracedNames[0]++;
+    }
+    while (_tracedNames[1] < _queues._names.size()) {
+        _trace->name(TraceEntity::QUEUE, _tracedNames[1], _queues._names.getName(QueueId {_tracedNames[1]}));
+        _tracedNames[1]++;
+    }
+    while (_tracedNames[2] < _links._names.size()) {
+        _trace->name(TraceEntity::LINK, _tracedNames[2], _links._names.getName(LinkId {_tracedNames[2]}));
+        _tracedNames[2]++;
+    }
+    while (_tracedNames[3] < _paramNames.size()) {
+        _trace->name(TraceEntity::PARAM, _tracedNames[3], _paramNames.getName(ParamId {_tracedNames[3]}));
+        _tracedNames[3]++;
+    }
+}
+
+void SimCPP::traceEvent(TraceEvent type, Transact* transact, unsigned int entity, double value) {
+    if (_trace != nullptr) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
+        this->traceNames();
+        _trace->record(type, transact->getID(), transact->getCurrentState(), _modelTime, entity, value);
+    }
+}
+
+void SimCPP::traceChain(TraceEvent type, TraceEntity chain, unsigned int chainId, Transact* transact) {
+    double value = 0;
+    if (_trace == nullptr || _snapshotInterval == 0) {
+        return;
+    }
+    SIMCPP_PROFILE_SCOPE(LOGGING);
+    if (type == TraceEvent::CHAIN_INSERT) {
+        //the FEC order follows from the times, other chains are placed after their neighbour
+        value = chain == TraceEntity::FEC ? (double)transact->getTime() : (transact->_chainPrev == nullptr ? 0 : transact->_chainPrev->getID());
+    }
+    _trace->chain(type, chain, chainId, transact->getID(), _modelTime, value);
+}
+
+void SimCPP::traceSnapshot() {
+    std::vector<Transact*> ordered = _FEC->getOrdered();
+
+    this->traceNames();
+    _trace->record(TraceEvent::SNAPSHOT, 0, 0, _modelTime);
+    std::for_each(ordered.begin(), ordered.end(), [this](Transact* transact){ this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::FEC, 0, transact); });
+    std::for_each(_CEC.begin(), _CEC.end(), [this](Transact* transact){ this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::CEC, 0, transact); });
+    for (unsigned int linkId = 0; linkId < _links._links.size(); linkId++) {
+        EventChain& link = _links.getChain(LinkId {linkId});
+        std::for_each(link.begin(), link.end(), [this, linkId](Transact* transact) \
+            { this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::LINK, linkId, transact); });
+    }
+    for (unsigned int storageId = 0; storageId < _storages._storages.size(); storageId++) {
+        EventChain& delayChain = _storages.getDelayChain(StorageId {storageId});
+        std::for_each(delayChain.begin(), delayChain.end(), [this, storageId](Transact* transact) \
+            { this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::DELAY, storageId, transact); });
+    }
+    _trace->record(TraceEvent::SNAPSHOT_END, 0, 0, _modelTime);
+    _nextSnapshot = _trace->getRecordsNumb() + _snapshotInterval;
+}
+
+void SimCPP::load(const BlockProgram& program) {
+    if (this->isRunning()) {
+        throw std::logic_error("You cannot load a block program after \"start\"ing the model");
+    }
+    std::for_each(program.getStorages().begin(), program.getStorages().end(), [this](const std::pair<std::string,unsigned int>& storage) \
+        { this->storage(storage.first, storage.second); });
+    std::for_each(program.getTables().begin(), program.getTables().end(), [this](const TableDefinition& table) {
+        if (table.queueName.empty()) {
+            this->table(table.name, table.upperLimit, table.width, table.classesNumb, table.sketchAccuracy);
+        }
+        else {
+            this->qtable(table.name, _queues.getId(table.queueName), table.upperLimit, table.width, table.classesNumb, table.sketchAccuracy);
+        }
+    });
+
+    _program = program.getBlocks();
+    _programPrimed = false;
+    if (_blockEntries.size() < _program.size() + 1) {
+        //the block counts have their size before the run, a block first entered late does not resize them
+        _blockEntries.resize(_program.size() + 1, 0);
+        _blockCurrent.resize(_program.size() + 1, 0);
+    }
+    std::for_each(_program.begin(), _program.end(), [this, &program](Block& block) {
+        if (block.type == BlockType::TABULATE) {
+            //the value is the argument of the table
+            block.handle = _tables.getId(block.entity).id;
+            if (_tables.isQueueTable(TableId {block.handle})) {
+                throw std::logic_error("QTABLE \"" + block.entity + "\" is tabulated by DEPART, not by TABULATE");
+            }
+            block.A = program.getTable(block.entity).argument;
+        }
+        this->bind(block.A._expression);
+        this->bind(block.B._expression);
+        switch (block.type) {
+            case BlockType::ENTER: case BlockType::LEAVE: block.handle = _storages.getId(block.entity).id; break;
+            case BlockType::QUEUE: case BlockType::DEPART: block.handle = _queues.getId(block.entity).id; break;
+            case BlockType::ASSIGN: block.handle = this->getParamId(block.entity).id; break;
+            case BlockType::LINK:
+                block.handle = _links.getId(block.entity).id;
+                block.order = block.discipline == "FIFO" ? LinkOrder::FIFO : (block.discipline == "LIFO" ? LinkOrder::LIFO : LinkOrder::PARAM);
+                block.paramHandle = block.order == LinkOrder::PARAM ? this->getParamId(block.discipline).id : 0;
+                break;
+            case BlockType::UNLINK:
+                block.handle = _links.getId(block.entity).id;
+                block.unlinkFrom = block.discipline.empty() ? UnlinkFrom::HEAD : (block.discipline == "BACK" ? UnlinkFrom::BACK : UnlinkFrom::PARAM);
+                block.paramHandle = block.unlinkFrom == UnlinkFrom::PARAM ? this->getParamId(block.discipline).id : 0;
+                break;
+            default: break;
+        }
+        if (!block.target.empty()) {
+            block.targetBlock = program.getBlockNumb(block.target);
+        }
+        block.handler = getHandler(block.type);
+    });
+}
 
+void SimCPP::run() {
+    if (_program.empty()) {
+        throw std::logic_error("There is no block program to run, \"load\" one first");
+    }
     if (!this->isRunning()) {
         throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
     }
 
+    //GENERATE blocks keep going after a restart, their first transacts are made once
+    if (!_programPrimed) {
+        for (unsigned int blockNumb = 1; blockNumb <= _program.size(); blockNumb++) {
+            Block& block = _program[blockNumb - 1];
+            if (block.type == BlockType::GENERATE) {
+                this->initGenerate(blockNumb, _modelTime + this->getValue(block.hasOffset ? block.B : block.A));
+                block.generatedNumb = 1;
+            }
+        }
+        _programPrimed = true;
+    }
+
+    //the model runs until the loop ends, so the blocks are executed by their handlers without the checks of the public methods
+    while (this->isRunning()) {
+        if (_CECIt == _CEC.end() && !this->promote()) {
+            break; //stopped by batchMeans
+        }
+        unsigned int blockNumb = this->moveActive();
+        if (blockNumb == 0 || blockNumb > _program.size()) {
+            throw std::logic_error("Xact:" + std::to_string((*_CECIt)->getID()) + " is moved to the nonexistent block " + std::to_string(blockNumb));
+        }
+        Block& block = _program[blockNumb - 1];
+        (this->*block.handler)(block);
+    }
+}
+
+BlockHandler SimCPP::getHandler(BlockType type) {
+    switch (type) {
+        case BlockType::GENERATE: return &SimCPP::executeGenerate;
+        case BlockType::TERMINATE: return &SimCPP::executeTerminate;
+        case BlockType::ADVANCE: return &SimCPP::executeAdvance;
+        case BlockType::TEST: return &SimCPP::executeTest;
+        case BlockType::TRANSFER: return &SimCPP::executeTransfer;
+        case BlockType::ASSIGN: return &SimCPP::executeAssign;
+        case BlockType::ENTER: return &SimCPP::executeEnter;
+        case BlockType::LEAVE: return &SimCPP::executeLeave;
+        case BlockType::QUEUE: return &SimCPP::executeQueue;
+        case BlockType::DEPART: return &SimCPP::executeDepart;
+        case BlockType::TABULATE: return &SimCPP::executeTabulate;
+        case BlockType::LINK: return &SimCPP::executeLink;
+        case BlockType::UNLINK: return &SimCPP::executeUnlink;
+    }
+    throw std::logic_error("Unknown block type");
+}
+
+void SimCPP::executeGenerate(Block& block) {
+    //over the limit the transact only passes the block
+    if (block.count == 0 || block.generatedNumb < block.count) {
+        this->doGenerate(this->getValue(block.A));
+        block.generatedNumb++;
+    }
+    else {
+        (*_CECIt)->setNextState((*_CECIt)->getCurrentState() + 1);
+    }
+}
+
+void SimCPP::executeUnlink(Block& block) {
+    this->doUnlink(LinkId {block.handle}, block.targetBlock, block.count, block.unlinkFrom, ParamId {block.paramHandle}, \
+        block.unlinkFrom == UnlinkFrom::PARAM ? this->getValue(block.A) : 0);
+}
+
+long double SimCPP::getValue(const Operand& operand) {
+    if (!operand._expression.empty()) {
+        return this->evaluate(operand._expression);
+    }
+    return operand._compute ? operand._compute(*this) : operand._value;
+}
+
+void SimCPP::bind(Expression& expression) {
+    if (expression._bound) {
+        return;
+    }
+    //SNAs read the entity objects directly, they live as long as the model
+    std::for_each(expression._code.begin(), expression._code.end(), [this, &expression](Expression::Instruction& instruction) {
+        switch (instruction.op) {
+            case ExprOp::STORAGE_R:
+                instruction.handle = _storages.getId(expression._names[instruction.handle]).id;
+                instruction.entity = _storages._storages[instruction.handle];
+                break;
+            case ExprOp::LINK_CH:
+                instruction.handle = _links.getId(expression._names[instruction.handle]).id;
+                instruction.entity = &_links.getChain(LinkId {instruction.handle});
+                break;
+            case ExprOp::QUEUE_Q:
+                instruction.handle = _queues.getId(expression._names[instruction.handle]).id;
+                instruction.entity = _queues._queues[instruction.handle];
+                break;
+            case ExprOp::PARAM: instruction.handle = this->getParamId(expression._names[instruction.handle]).id; break;
+            case ExprOp::VARIABLE:
+                instruction.handle = _variableNames.find(expression._names[instruction.handle]).id;
+                instruction.entity = _variables[instruction.handle];
+                break;
+            default: break;
+        }
+    });
+    expression._bound = true;
+}
+
+void SimCPP::rebind(Expression& expression) {
+    if (!expression._bound) {
+        this->bind(expression);
+        return;
+    }
+    std::for_each(expression._code.begin(), expression._code.end(), [this](Expression::Instruction& instruction) {
+        switch (instruction.op) {
+            case ExprOp::STORAGE_R: instruction.entity = _storages._storages[instruction.handle]; break;
+            case ExprOp::LINK_CH: instruction.entity = &_links.getChain(LinkId {instruction.handle}); break;
+            case ExprOp::QUEUE_Q: instruction.entity = _queues._queues[instruction.handle]; break;
+            case ExprOp::VARIABLE: instruction.entity = _variables[instruction.handle]; break;
+            default: break;
+        }
+    });
+}
+
+long double SimCPP::evaluate(const Expression& expression) {
+    long double stack[Expression::MAX_DEPTH];
+    unsigned int size = 0;
+
+    if (!expression._bound || expression._code.empty()) {
+        throw std::logic_error("Expression must be nonempty and bound to the model before the evaluation");
+    }
+    for (const Expression::Instruction& instruction : expression._code) {
+        switch (instruction.op) {
+            case ExprOp::CONST: stack[size++] = instruction.value; break;
+            case ExprOp::AC1: stack[size++] = _modelTime; break;
+            case ExprOp::C1: stack[size++] = _modelTime - _resetTime; break;
+            case ExprOp::STORAGE_R: stack[size++] = ((Storages::Storage*)instruction.entity)->getStorageParam(SNA::R); break;
+            case ExprOp::LINK_CH: stack[size++] = ((EventChain*)instruction.entity)->size(); break;
+            case ExprOp::QUEUE_Q: stack[size++] = ((Queues::Queue*)instruction.entity)->getContent(); break;
+            case ExprOp::VARIABLE: stack[size++] = this->evaluate(*(const Expression*)instruction.entity); break;
+            case ExprOp::PARAM:
+                if (_CECIt == _CEC.end()) {
+                    throw std::logic_error("Transact parameters are referred to without an active transact");
+                }
+                stack[size++] = (*_CECIt)->getParam(ParamId {instruction.handle});
+                break;
+            case ExprOp::NEG: stack[size - 1] = -stack[size - 1]; break;
+            case ExprOp::TRUNC: stack[size - 1] = std::trunc(stack[size - 1]); break;
+            case ExprOp::EXPONENTIAL:
+                size -= 2;
+                stack[size - 1] = _random.exponential((unsigned int)stack[size - 1], stack[size], stack[size + 1]);
+                break;
+            case ExprOp::UNIFORM:
+                size -= 2;
+                stack[size - 1] = _random.uniform((unsigned int)stack[size - 1], stack[size], stack[size + 1]);
+                break;
+            case ExprOp::NORMAL:
+                size -= 2;
+                stack[size - 1] = _random.normal((unsigned int)stack[size - 1], stack[size], stack[size + 1]);
+                break;
+            case ExprOp::TRIANGULAR:
+                size -= 3;
+                stack[size - 1] = _random.triangular((unsigned int)stack[size - 1], stack[size], stack[size + 1], stack[size + 2]);
+                break;
+            case ExprOp::WEIBULL:
+                size -= 3;
+                stack[size - 1] = _random.weibull((unsigned int)stack[size - 1], stack[size], stack[size + 1], stack[size + 2]);
+                break;
+            default:
+                size--;
+                stack[size - 1] = Expression::calculate(instruction.op, stack[size - 1], stack[size]);
+        }
+    }
+    return stack[0];
+}
+
+VariableId SimCPP::variable(const std::string& name, const std::string& text, VariableType type) {
+    Expression expression = Expression::parseVariable(text, type);
+    //a new variable is not announced yet, so it cannot refer to itself
+    this->bind(expression);
+    if (!_variableNames.contains(name)) {
+        _variables.push_back(new Expression(expression));
+        return _variableNames.intern(name);
+    }
+    VariableId variableId = _variableNames.find(name);
+    if (this->refersTo(expression, _variables[variableId.id])) {
+        throw std::logic_error("Variable \"" + name + "\" refers to itself");
+    }
+    *_variables[variableId.id] = expression;
+    return variableId;
+}
+
+bool SimCPP::refersTo(const Expression& expression, const Expression* variable) {
+    return std::any_of(expression._code.begin(), expression._code.end(), [this, variable](const Expression::Instruction& instruction) {
+        return instruction.op == ExprOp::VARIABLE && (instruction.entity == variable || this->refersTo(*(const Expression*)instruction.entity, variable));
+    });
+}
+
+void SimCPP::reset() {
+    _resetTime = _modelTime;
+    _queues.reset(_modelTime);
+    _links.reset(_modelTime);
+    _storages.reset(_modelTime);
+    _tables.reset();
+    std::fill(_blockEntries.begin(), _blockEntries.end(), 0);
+    std::for_each(_metrics.begin(), _metrics.end(), [this](OutputMetric& metric) {
+        metric.batchMeans = BatchMeans(metric.batchMeans.getMinBatchesNumb());
+        metric.nextSample = _modelTime + metric.sampleInterval;
+        metric.prevArea = 0;
+    });
+    if (_trace != nullptr) {
+        _trace->record(TraceEvent::RESET, 0, 0, _modelTime);
+    }
+
+    if (_simLogs != nullptr && _simLogs->isEnable_SysEvLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
+        _simLogs->logMess_sysEvLog("Statistics are reset at model time: " + std::to_string(_modelTime));
+    }
+}
+
+void SimCPP::save(std::ostream& stream) {
+    if (this->isRunning()) {
+        throw std::logic_error("You cannot save the model while it is running, save it after the run completes");
+    }
+    CheckpointWriter writer(stream);
+    unsigned long transactsNumb = 0;
+
+    stream.write(CHECKPOINT_MAGIC, 8);
+    writer.write((uint32_t)CHECKPOINT_VERSION);
+    writer.write(_maxId);
+    writer.write(_modelTime);
+    writer.write(_resetTime);
+    _random.save(writer);
+
+    writer.write((uint64_t)_paramNames.size());
+    for (unsigned int i = 0; i < _paramNames.size(); i++) {
+        writer.write(_paramNames.getName(ParamId {i}));
+    }
+    _queues.save(writer);
+    _tables.save(writer);
+    writer.write((uint64_t)_storages._storages.size());
+    for (unsigned int i = 0; i < _storages._storages.size(); i++) {
+        writer.write(_storages.getName(StorageId {i}));
+        writer.write(_storages._storages[i]->getCapacity());
+        _storages.save(StorageId {i}, writer);
+        transactsNumb += this->saveChain(writer, _storages.getDelayChain(StorageId {i}));
+    }
+    writer.write((uint64_t)_links._links.size());
+    for (unsigned int i = 0; i < _links._links.size(); i++) {
+        writer.write(_links.getName(LinkId {i}));
+        _links.save(LinkId {i}, writer);
+        transactsNumb += this->saveChain(writer, _links.getChain(LinkId {i}));
+    }
+
+    //the FEC in its order, the pushes of restore give the same order of equal times
+    std::vector<Transact*> FECTransacts = _FEC->getOrdered();
+    writer.write((uint64_t)FECTransacts.size());
+    std::for_each(FECTransacts.begin(), FECTransacts.end(), [this, &writer](Transact* transact){ this->saveTransact(writer, transact); });
+    transactsNumb += FECTransacts.size();
+    transactsNumb += this->saveChain(writer, _CEC);
+    writer.write((uint64_t)std::distance(_CEC.begin(), _CECIt));
+    if (transactsNumb != _pool.getLiveNumb()) {
+        throw std::logic_error("Checkpoint has " + std::to_string(transactsNumb) + " transacts of " + std::to_string(_pool.getLiveNumb()) \
+            + ", the others are in no chain");
+    }
+
+    writer.write(_blockEntries);
+    writer.write(_blockCurrent);
+    writer.write(_eventsNumb);
+    writer.write((uint64_t)_program.size());
+    std::for_each(_program.begin(), _program.end(), [&writer](const Block& block) {
+        writer.write(block.type);
+        writer.write(block.generatedNumb);
+    });
+    writer.write(_programPrimed);
+
+    writer.write(_warmupQueue);
+    writer.write(_warmupInterval);
+    writer.write(_nextWarmupSample);
+    writer.write(_warmupMinBatches);
+    _warmupSeries.save(writer);
+    writer.write((uint64_t)_metrics.size());
+    std::for_each(_metrics.begin(), _metrics.end(), [&writer](const OutputMetric& metric) {
+        writer.write(metric.name);
+        writer.write(metric.type);
+        writer.write(metric.entity);
+        writer.write(metric.sampleInterval);
+        writer.write(metric.relativePrecision);
+        writer.write(metric.confidence);
+        metric.batchMeans.save(writer);
+        writer.write(metric.nextSample);
+        writer.write(metric.prevArea);
+    });
+    if (!stream) {
+        throw std::logic_error("Checkpoint of the model \"" + _modelName + "\" cannot be written");
+    }
+}
+
+void SimCPP::save(const std::string& fileName) {
+    {
+        std::ofstream file(fileName + ".tmp", std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::logic_error("Cannot open the checkpoint file \"" + fileName + ".tmp\"");
+        }
+        this->save(file);
+        file.close();
+        if (!file) {
+            throw std::logic_error("Checkpoint file \"" + fileName + ".tmp\" cannot be written");
+        }
+    }
+    if (std::rename((fileName + ".tmp").c_str(), fileName.c_str()) != 0) {
+        throw std::logic_error("Cannot rename the checkpoint file \"" + fileName + ".tmp\"");
+    }
+}
+
+void SimCPP::restore(std::istream& stream) {
+    if (this->isRunning() || _maxId != 1) {
+        throw std::logic_error("You can restore a checkpoint only into a model that has not been started");
+    }
+    CheckpointReader reader(stream);
+    char magic[8];
+    stream.read(magic, 8);
+    if (!stream || std::string(magic, 8) != CHECKPOINT_MAGIC || reader.get<uint32_t>() != CHECKPOINT_VERSION) {
+        throw std::logic_error("It is not a SimCPP checkpoint of this version");
+    }
+    reader.read(_maxId);
+    reader.read(_modelTime);
+    reader.read(_resetTime);
+    _random.restore(reader);
+
+    uint64_t namesNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < namesNumb; i++) {
+        //parameter handles are the slots of the transact parameters
+        std::string name = reader.get<std::string>();
+        if (_paramNames.intern(name).id != i) {
+            throw std::logic_error("Parameter \"" + name + "\" of the checkpoint has another slot in the model");
+        }
+    }
+    _queues.restore(reader);
+    _tables.restore(reader);
+    namesNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < namesNumb; i++) {
+        std::string name = reader.get<std::string>();
+        unsigned int capacity = reader.get<unsigned int>();
+        if (i == _storages._storages.size()) {
+            _storages.storageAppend(name, capacity);
+        }
+        else if (_storages.getName(StorageId {(unsigned int)i}) != name) {
+            throw std::logic_error("Storage \"" + name + "\" of the checkpoint is not the storage " + std::to_string(i) + " of the model");
+        }
+        _storages.restore(StorageId {(unsigned int)i}, reader);
+        if (_storages.getStorageParam(StorageId {(unsigned int)i}, SNA::CH) > _storages._storages[i]->getCapacity()) {
+            throw std::logic_error("Storage \"" + name + "\" of the checkpoint has more channels in use than its capacity in the model");
+        }
+        this->restoreChain(reader, _storages.getDelayChain(StorageId {(unsigned int)i}));
+        _storages.restoreIndex(StorageId {(unsigned int)i});
+    }
+    namesNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < namesNumb; i++) {
+        std::string name = reader.get<std::string>();
+        if (i < _links._links.size() && _links.getName(LinkId {(unsigned int)i}) != name) {
+            throw std::logic_error("User chain \"" + name + "\" of the checkpoint is not the user chain " + std::to_string(i) + " of the model");
+        }
+        LinkId linkId = _links.getId(name);
+        _links.restore(linkId, reader);
+        this->restoreChain(reader, _links.getChain(linkId));
+        _links.restoreIndex(linkId);
+    }
+
+    uint64_t FECSize = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < FECSize; i++) {
+        _FEC->push(this->restoreTransact(reader));
+    }
+    this->restoreChain(reader, _CEC);
+    _CECIt = _CEC.begin();
+    std::advance(_CECIt, reader.get<uint64_t>());
+
+    reader.read(_blockEntries);
+    reader.read(_blockCurrent);
+    reader.read(_eventsNumb);
+    if (reader.get<uint64_t>() != _program.size()) {
+        throw std::logic_error("Block program of the checkpoint has another number of blocks");
+    }
+    std::for_each(_program.begin(), _program.end(), [&reader](Block& block) {
+        if (reader.get<BlockType>() != block.type) {
+            throw std::logic_error("Block program of the checkpoint has other blocks");
+        }
+        reader.read(block.generatedNumb);
+    });
+    reader.read(_programPrimed);
+
+    reader.read(_warmupQueue);
+    reader.read(_warmupInterval);
+    reader.read(_nextWarmupSample);
+    reader.read(_warmupMinBatches);
+    _warmupSeries.restore(reader);
+    _metrics.clear();
+    uint64_t metricsNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < metricsNumb; i++) {
+        OutputMetric metric;
+        reader.read(metric.name);
+        reader.read(metric.type);
+        reader.read(metric.entity);
+        reader.read(metric.sampleInterval);
+        reader.read(metric.relativePrecision);
+        reader.read(metric.confidence);
+        metric.batchMeans.restore(reader);
+        reader.read(metric.nextSample);
+        reader.read(metric.prevArea);
+        _metrics.push_back(metric);
+    }
+
+    //free channels of larger capacities go to the waiting transacts, they are the next ones to move as after LEAVE,
+    //they enter their ENTER blocks, so the block counts are restored first
+    EventChain::iterator firstGrantedIt = _CECIt;
+    for (unsigned int i = 0; i < _storages._storages.size(); i++) {
+        const std::vector<Transact*>& grantedTrans = _storages.grant(StorageId {i}, _modelTime);
+        std::for_each(grantedTrans.begin(), grantedTrans.end(), [this, &firstGrantedIt](Transact* grantedTransact) {
+            grantedTransact->setTime(_modelTime);
+            this->countEntry(grantedTransact, grantedTransact->getNextState());
+            grantedTransact->setNextState(grantedTransact->getCurrentState() + 1);
+            EventChain::iterator grantedIt = _CEC.emplace(_CECIt, grantedTransact);
+            if (firstGrantedIt == _CECIt) {
+                firstGrantedIt = grantedIt;
+            }
+        });
+    }
+    _CECIt = firstGrantedIt;
+}
+
+void SimCPP::restore(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+        throw std::logic_error("Cannot open the checkpoint file \"" + fileName + '\"');
+    }
+    this->restore(file);
+}
+
+std::unique_ptr<SimCPP> SimCPP::fork(uint64_t runSeed, const std::vector<std::pair<std::string,unsigned int>>& capacities) {
+    if (this->isRunning()) {
+        throw std::logic_error("You cannot fork the model while it is running, fork it after the run completes");
+    }
+    std::unique_ptr<SimCPP> branch(new SimCPP(_modelName, _FECEngine));
+
+    //entities in the order of this model, so the handles of the program are the same
+    std::for_each(capacities.begin(), capacities.end(), [this](const std::pair<std::string,unsigned int>& capacity) \
+        { _storages.getId(capacity.first); });
+    for (unsigned int i = 0; i < _storages._storages.size(); i++) {
+        const std::string& name = _storages.getName(StorageId {i});
+        std::vector<std::pair<std::string,unsigned int>>::const_iterator capacityIt = std::find_if(capacities.begin(), capacities.end(), \
+            [&name](const std::pair<std::string,unsigned int>& capacity){ return capacity.first == name; });
+        branch->_storages.storageAppend(name, capacityIt != capacities.end() ? capacityIt->second : _storages._storages[i]->getCapacity());
+    }
+    for (unsigned int i = 0; i < _queues._queues.size(); i++) {
+        branch->_queues.getId(_queues.getName(QueueId {i}));
+    }
+    for (unsigned int i = 0; i < _links._links.size(); i++) {
+        branch->_links.getId(_links.getName(LinkId {i}));
+    }
+    for (unsigned int i = 0; i < _paramNames.size(); i++) {
+        branch->_paramNames.intern(_paramNames.getName(ParamId {i}));
+    }
+    for (unsigned int i = 0; i < _tables._tables.size(); i++) {
+        const TableStat& table = _tables._tables[i]->getFinalStat();
+        double sketchAccuracy = table.sketched ? table.sketch.getAccuracy() : 0;
+        std::vector<std::pair<QueueId,TableId>>::iterator queueTableIt = std::find_if(_tables._queueTables.begin(), _tables._queueTables.end(), \
+            [i](const std::pair<QueueId,TableId>& queueTable){ return queueTable.second.id == i; });
+        if (queueTableIt == _tables._queueTables.end()) {
+            branch->_tables.table(table.name, table.upperLimit, table.width, table.frequencies.size(), sketchAccuracy);
+        }
+        else {
+            branch->_tables.qtable(table.name, queueTableIt->first, table.upperLimit, table.width, table.frequencies.size(), sketchAccuracy);
+        }
+    }
+    for (unsigned int i = 0; i < _variables.size(); i++) {
+        branch->_variableNames.intern(_variableNames.getName(VariableId {i}));
+        branch->_variables.push_back(new Expression(*_variables[i]));
+    }
+    std::for_each(branch->_variables.begin(), branch->_variables.end(), [&branch](Expression* variable){ branch->rebind(*variable); });
+    branch->_program = _program;
+    std::for_each(branch->_program.begin(), branch->_program.end(), [&branch](Block& block) {
+        branch->rebind(block.A._expression);
+        branch->rebind(block.B._expression);
+    });
+    branch->setVariateBuffering(_random.isBuffering());
+
+    std::stringstream snapshot;
+    this->save(snapshot);
+    branch->restore(snapshot);
+    branch->rmult(runSeed);
+    return branch;
+}
+
+void SimCPP::saveTransact(CheckpointWriter& writer, Transact* transact) {
+    writer.write(transact->_ID);
+    writer.write(transact->_timeNextEvent);
+    writer.write(transact->_currentState);
+    writer.write(transact->_nextState);
+    writer.write(transact->_blocked);
+    writer.write(transact->_demand);
+    writer.write(transact->_paramsSet);
+    for (unsigned int i = 0; i < TRANSACT_PARAMS_NUMB; i++) {
+        if ((transact->_paramsSet & (1u << i)) != 0) {
+            writer.write(transact->_params[i]);
+        }
+    }
+    writer.write(transact->_linkKey);
+    writer.write(transact->_linkSeq);
+    writer.write(transact->_queuesNumb);
+    for (unsigned int i = 0; i < transact->_queuesNumb; i++) {
+        writer.write(transact->getQueueEntry(i));
+    }
+}
+
+Transact* SimCPP::restoreTransact(CheckpointReader& reader) {
+    unsigned long ID = reader.get<unsigned long>();
+    long double time = reader.get<long double>();
+    unsigned int currentState = reader.get<unsigned int>();
+    Transact* transact = _pool.acquire(ID, time, currentState, reader.get<unsigned int>());
+
+    reader.read(transact->_blocked);
+    reader.read(transact->_demand);
+    reader.read(transact->_paramsSet);
+    for (unsigned int i = 0; i < TRANSACT_PARAMS_NUMB; i++) {
+        if ((transact->_paramsSet & (1u << i)) != 0) {
+            reader.read(transact->_params[i]);
+        }
+    }
+    reader.read(transact->_linkKey);
+    reader.read(transact->_linkSeq);
+    reader.read(transact->_queuesNumb);
+    if (transact->_queuesNumb > TRANSACT_QUEUES_NUMB) {
+        transact->_moreQueueEntries.resize(transact->_queuesNumb - TRANSACT_QUEUES_NUMB);
+    }
+    for (unsigned int i = 0; i < transact->_queuesNumb; i++) {
+        reader.read(transact->getQueueEntry(i));
+    }
+    return transact;
+}
+
+unsigned long SimCPP::saveChain(CheckpointWriter& writer, EventChain& chain) {
+    writer.write((uint64_t)chain.size());
+    std::for_each(chain.begin(), chain.end(), [this, &writer](Transact* transact){ this->saveTransact(writer, transact); });
+    return chain.size();
+}
+
+void SimCPP::restoreChain(CheckpointReader& reader, EventChain& chain) {
+    uint64_t size = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < size; i++) {
+        chain.emplace(chain.end(), this->restoreTransact(reader));
+    }
+}
+
+void SimCPP::detectWarmup(QueueId queueId, long double sampleInterval, unsigned int minBatches) {
+    if (sampleInterval <= 0) {
+        throw std::logic_error("Warm-up detection needs a positive sample interval");
+    }
+    _warmupQueue = queueId;
+    _warmupInterval = sampleInterval;
+    _nextWarmupSample = _modelTime;
+    _warmupMinBatches = minBatches;
+    _warmupSeries = MSER5();
+}
+
+unsigned int SimCPP::batchMeans(QueueId queueId, long double sampleInterval, double relativePrecision, double confidence, \
+    unsigned int batchesNumb) {
+    if (sampleInterval <= 0 || relativePrecision < 0) {
+        throw std::logic_error("Batch means need a positive sample interval and a nonnegative precision");
+    }
+    _metrics.push_back(OutputMetric {"Q$" + _queues.getName(queueId), MetricType::QUEUE, queueId.id, sampleInterval, relativePrecision, confidence, \
+        BatchMeans(batchesNumb), _modelTime + sampleInterval, 0});
+    _metrics.back().prevArea = this->getArea(_metrics.back(), _modelTime);
+    return _metrics.size() - 1;
+}
+
+unsigned int SimCPP::batchMeans(StorageId storageId, long double sampleInterval, double relativePrecision, double confidence, \
+    unsigned int batchesNumb) {
+    if (sampleInterval <= 0 || relativePrecision < 0) {
+        throw std::logic_error("Batch means need a positive sample interval and a nonnegative precision");
+    }
+    _metrics.push_back(OutputMetric {"SU$" + _storages.getName(storageId), MetricType::STORAGE, storageId.id, sampleInterval, relativePrecision, \
+        confidence, BatchMeans(batchesNumb), _modelTime + sampleInterval, 0});
+    _metrics.back().prevArea = this->getArea(_metrics.back(), _modelTime);
+    return _metrics.size() - 1;
+}
+
+unsigned int SimCPP::batchMeans(LinkId linkId, long double sampleInterval, double relativePrecision, double confidence, \
+    unsigned int batchesNumb) {
+    if (sampleInterval <= 0 || relativePrecision < 0) {
+        throw std::logic_error("Batch means need a positive sample interval and a nonnegative precision");
+    }
+    _metrics.push_back(OutputMetric {"CH$" + _links.getName(linkId), MetricType::LINK, linkId.id, sampleInterval, relativePrecision, confidence, \
+        BatchMeans(batchesNumb), _modelTime + sampleInterval, 0});
+    _metrics.back().prevArea = this->getArea(_metrics.back(), _modelTime);
+    return _metrics.size() - 1;
+}
+
+long double SimCPP::getArea(const OutputMetric& metric, long double time) {
+    switch (metric.type) {
+        case MetricType::QUEUE: return _queues.getArea(QueueId {metric.entity}, time);
+        case MetricType::LINK: return _links.getArea(LinkId {metric.entity}, time);
+        default: {
+            StorageId storageId {metric.entity};
+            unsigned int capacity = _storages.getStorageParam(storageId, SNA::CH) + _storages.getStorageParam(storageId, SNA::R);
+            return capacity == 0 ? 0 : _storages.getArea(storageId, time) / capacity;
+        }
+    }
+}
+
+bool SimCPP::sampleMetrics(long double nextTime) {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    //the contents are still the ones before the events at nextTime, so the areas hold up to it
+    bool precise = false, sampled = false;
+    long double stopTime = _modelTime;
+    for (OutputMetric& metric : _metrics) {
+        while (metric.nextSample <= nextTime) {
+            long double area = this->getArea(metric, metric.nextSample);
+            metric.batchMeans.add((area - metric.prevArea) / metric.sampleInterval);
+            metric.prevArea = area;
+            stopTime = std::max(stopTime, metric.nextSample);
+            metric.nextSample += metric.sampleInterval;
+            sampled = true;
+        }
+    }
+    if (!sampled) {
+        return false;
+    }
+    for (const OutputMetric& metric : _metrics) {
+        if (metric.relativePrecision > 0) {
+            if (!(metric.batchMeans.getRelativeHalfWidth(metric.confidence) <= metric.relativePrecision)) {
+                return false;
+            }
+            precise = true;
+        }
+    }
+    if (precise) {
+        _modelTime = stopTime;
+    }
+    return precise;
+}
+
+std::string SimCPP::getMetricsString() {
+    std::string message = "\nBATCH MEANS\tBATCHES\tSIZE\tMEAN +- HALF WIDTH\t\tREL.\tLAG1 CORR.";
+    std::for_each(_metrics.begin(), _metrics.end(), [&message](const OutputMetric& metric) {
+        message += '\n' + metric.name + '\t' + std::to_string(metric.batchMeans.getBatchesNumb()) + '\t' \
+            + std::to_string(metric.batchMeans.getBatchSize()) + '\t' + metric.batchMeans.getString(metric.confidence) + '\t' \
+            + std::to_string(metric.batchMeans.getRelativeHalfWidth(metric.confidence)) + '\t' + std::to_string(metric.batchMeans.getLag1Correlation());
+    });
+    return message;
+}
+
+std::string SimCPP::getProfileString() {
+    std::string message = "BLOCK\tLABEL\tTYPE\t\tENTRY\t\tCURRENT\tSHARE,%";
+    unsigned long entriesNumb = 0;
+    char line[160];
+    std::for_each(_blockEntries.begin(), _blockEntries.end(), [&entriesNumb](unsigned long entries){ entriesNumb += entries; });
+    for (unsigned int state = 1; state < std::max((unsigned int)_blockEntries.size(), (unsigned int)_program.size() + 1); state++) {
+        //states of a model without a block program are listed when they are used
+        if (_program.empty() && this->getBlockEntries(state) == 0 && this->getBlockCurrent(state) == 0) {
+            continue;
+        }
+        const Block* block = state <= _program.size() ? &_program[state - 1] : nullptr;
+        std::snprintf(line, sizeof(line), "\n%u\t%s\t%-8s\t%-12lu\t%lu\t%.2f", state, block != nullptr ? block->label.c_str() : "", \
+            block != nullptr ? BlockProgram::getBlockName(block->type).c_str() : "", this->getBlockEntries(state), this->getBlockCurrent(state), \
+            entriesNumb > 0 ? 100. * this->getBlockEntries(state) / entriesNumb : 0.);
+        message += line;
+    }
+
+    double seconds = _profiler.getTotalSeconds();
+    std::snprintf(line, sizeof(line), "\n\nevents: %lu, run time: %.6f s, events/s: %.0f\n", _eventsNumb, seconds, seconds > 0 ? _eventsNumb / seconds : 0.);
+    message += line;
+#ifdef SIMCPP_PROFILE
+    message += '\n' + _profiler.getString();
+#else
+    message += "engine phases are not measured, build with -DSIMCPP_PROFILE";
+#endif
+    return message;
+}
+
+void SimCPP::sampleWarmup() {
+    SIMCPP_PROFILE_SCOPE(STATISTICS);
+    //the content is still the one before the events at _modelTime
+    unsigned long content = _queues.getContent(_warmupQueue);
+    bool newBatch = false;
+    while (_nextWarmupSample <= _modelTime) {
+        _warmupSeries.add(content);
+        _nextWarmupSample += _warmupInterval;
+        newBatch = newBatch || _warmupSeries.getNumb() % 5 == 0;
+    }
+
+    if (newBatch && _warmupSeries.getTruncation(_warmupMinBatches) >= 0) {
+        //the series is of no use once the truncation is found, a fork would copy it to every replication
+        _warmupInterval = 0;
+        _warmupSeries = MSER5();
+        this->reset();
+    }
+}
+
+void SimCPP::enter(StorageId storageId, const unsigned int numbOfChannels) {
+    this->checkRunning();
+    this->doEnter(storageId, numbOfChannels);
+}
+
+void SimCPP::doEnter(StorageId storageId, const unsigned int numbOfChannels) {
+    SIMCPP_PROFILE_SCOPE(STORAGES);
+    unsigned int seizedChannels;
+    Transact* currTransact;
+    std::string message;
+
     currTransact = *_CECIt;
-    seizedChannels = _storages.enter(currTransact, storageName, numbOfChannels);
+    seizedChannels = _storages.enter(currTransact, storageId, numbOfChannels);
+    this->traceEvent(TraceEvent::ENTER, currTransact, storageId.id, seizedChannels);
     if (numbOfChannels == seizedChannels) {
         (currTransact)->setNextState((currTransact)->getCurrentState()+1); 
     }
+    else {
+        //the transact waits off the CEC, LEAVE moves it back with the channels seized; as in GPSS it stays
+        //in the previous block until then, so the entry counted by sysEvent is taken back
+        unsigned int state = currTransact->getCurrentState();
+        _blockEntries[state]--;
+        _blockCurrent[state]--;
+        if (_prevState != 0) {
+            _blockCurrent[_prevState]++;
+        }
+        currTransact->setCurrentState(_prevState);
+        _CEC.erase(_CECIt++);
+        _storages.delay(currTransact, storageId, numbOfChannels);
+        this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::CEC, 0, currTransact);
+        this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::DELAY, storageId.id, currTransact);
+    }
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"seizing\" Xact:" + std::to_string((currTransact)->getID()) + " model time: " + std::to_string(_modelTime) \
-                   + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                   + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
                 _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string((currTransact)->getID()) + " at state: " + std::to_string((currTransact)->getCurrentState()) + "; model time: " \
-                                + std::to_string(_modelTime) + ": seized " + std::to_string(seizedChannels) + " channel(s) at \"" + storageName + "\" storage";                 
+                                + std::to_string(_modelTime) + ": seized " + std::to_string(seizedChannels) + " channel(s) at \"" + _storages.getName(storageId) + "\" storage";                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
 
-void SimCPP::leave(const std::string storageName, const unsigned int numbOfChannels) {
-    unsigned int releasedChannels;
+void SimCPP::leave(StorageId storageId, const unsigned int numbOfChannels) {
+    this->checkRunning();
+    this->doLeave(storageId, numbOfChannels);
+}
+
+void SimCPP::doLeave(StorageId storageId, const unsigned int numbOfChannels) {
+    SIMCPP_PROFILE_SCOPE(STORAGES);
     Transact* currTransact;
     std::string message;
-
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
-    }
+    EventChain::iterator emplaceIt = _CECIt;
 
     currTransact = *_CECIt;
     (currTransact)->setNextState((currTransact)->getCurrentState()+1);
 
-    releasedChannels = _storages.leave(currTransact, storageName, numbOfChannels);
-    _CEC.setReset(true); //will used while TERMINATE transact
-     
+    const std::vector<Transact*>& grantedTrans = _storages.leave(currTransact, storageId, numbOfChannels);
+    this->traceEvent(TraceEvent::LEAVE, currTransact, storageId.id, numbOfChannels);
+
+    //the transacts with seized channels go on right after the current one, in the delay chain order
+    std::for_each(grantedTrans.begin(), grantedTrans.end(), [this, storageId, &emplaceIt](Transact* grantedTransact) {
+        grantedTransact->setTime(_modelTime);
+        this->countEntry(grantedTransact, grantedTransact->getNextState()); //the ENTER block it waited for
+        grantedTransact->setNextState(grantedTransact->getCurrentState()+1);
+        emplaceIt++;
+        emplaceIt = _CEC.emplace(emplaceIt, grantedTransact);
+        this->traceEvent(TraceEvent::ENTER, grantedTransact, storageId.id, grantedTransact->getDemand());
+        this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::DELAY, storageId.id, grantedTransact);
+        this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::CEC, 0, grantedTransact);
+        if (_simLogs->isEnable_transactLog()) {
+            SIMCPP_PROFILE_SCOPE(LOGGING);
+            _simLogs->logMess_transactLog("Xact:" + std::to_string(grantedTransact->getID()) + " at state: " + std::to_string(grantedTransact->getCurrentState()) \
+                + "; model time: " + std::to_string(_modelTime) + ": seized " + std::to_string(grantedTransact->getDemand()) + " channel(s) at \"" \
+                + _storages.getName(storageId) + "\" storage after the delay");
+        }
+    });
 
     if (_simLogs->isEnable_CFECLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "\"releazing\" Xact:" + std::to_string((currTransact)->getID()) + " model time: " + std::to_string(_modelTime) \
-                   + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+                   + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
                 _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string((currTransact)->getID()) + " at state: " + std::to_string((currTransact)->getCurrentState()) + "; model time: " \
-                                + std::to_string(_modelTime) + ": released " + std::to_string(releasedChannels) + " channel(s) at \"" + storageName + "\" storage";                 
+                                + std::to_string(_modelTime) + ": released " + std::to_string(numbOfChannels) + " channel(s) at \"" + _storages.getName(storageId) + "\" storage";                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
 
-void SimCPP::link(const std::string linkName, const std::string discipline) {
+void SimCPP::link(const std::string& linkName, const std::string& discipline) {
+    if (discipline == "FIFO") {
+        this->link(_links.getId(linkName), LinkOrder::FIFO);
+    }
+    else if (discipline == "LIFO") {
+        this->link(_links.getId(linkName), LinkOrder::LIFO);
+    }
+    else {
+        this->link(_links.getId(linkName), this->getParamId(discipline));
+    }
+}
+
+void SimCPP::doLink(LinkId linkId, LinkOrder order, ParamId paramId) {
+    SIMCPP_PROFILE_SCOPE(USER_CHAINS);
     std::string message;
     Transact* currTransact;
 
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
-    }
-
     currTransact = *_CECIt;
     currTransact->setNextState(currTransact->getCurrentState());
 
-    _links.link(currTransact,linkName,discipline);
     _CEC.erase(_CECIt++);
+    _links.link(currTransact,linkId,order,paramId);
+    this->traceEvent(TraceEvent::LINK, currTransact, linkId.id, order == LinkOrder::PARAM ? 2 + paramId.id : (double)order); //FIFO 0, LIFO 1
+    this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::CEC, 0, currTransact);
+    this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::LINK, linkId.id, currTransact);
 
     if (_simLogs->isEnable_CFECLog()) {
-        message = "\"linking\" Xact:" + std::to_string((currTransact)->getID()) + " to \"" + linkName + "\" model time: " + std::to_string(_modelTime) \
-                   + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+        SIMCPP_PROFILE_SCOPE(LOGGING);
+        message = "\"linking\" Xact:" + std::to_string((currTransact)->getID()) + " to \"" + _links.getName(linkId) + "\" model time: " + std::to_string(_modelTime) \
+                   + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + std::to_string((currTransact)->getID()) + " at state: " + std::to_string((currTransact)->getCurrentState()) + "; model time: " \
-                                + std::to_string(_modelTime) + ": linking to \"" + linkName + "\" with \"" + discipline + "\" discipline";                 
+                                + std::to_string(_modelTime) + ": linking to \"" + _links.getName(linkId) + "\" with \"" \
+                                + (order == LinkOrder::FIFO ? "FIFO" : (order == LinkOrder::LIFO ? "LIFO" : _paramNames.getName(paramId))) + "\" discipline";                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
-void SimCPP::unlink(const std::string linkName, const unsigned int nextState, const unsigned int numbReleasedTrans) {
+void SimCPP::unlink(LinkId linkId, const unsigned int nextState, const unsigned int numbReleasedTrans, UnlinkFrom from, ParamId paramId, long double value) {
+    this->checkRunning();
+    this->doUnlink(linkId, nextState, numbReleasedTrans, from, paramId, value);
+}
+
+void SimCPP::doUnlink(LinkId linkId, const unsigned int nextState, const unsigned int numbReleasedTrans, UnlinkFrom from, ParamId paramId, long double value) {
+    SIMCPP_PROFILE_SCOPE(USER_CHAINS);
     std::string message;
     std::string transIDString;
-    std::vector<Transact*> releasedTrans;
-    std::list<Transact*>::iterator emplaceIt = _CECIt;
+    EventChain::iterator emplaceIt = _CECIt;
     Transact* currTransact;
 
-    if (!this->isRunning()) {
-        throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
-    }
-
     currTransact = *_CECIt;
     currTransact->setNextState(currTransact->getCurrentState()+1);
 
-    releasedTrans = _links.unlink(linkName,numbReleasedTrans);
+    const std::vector<Transact*>& releasedTrans = _links.unlink(linkId, numbReleasedTrans, _modelTime, from, paramId, value);
+    this->traceEvent(TraceEvent::UNLINK, currTransact, linkId.id, releasedTrans.size());
+    if (_trace != nullptr) {
+        std::for_each(releasedTrans.begin(), releasedTrans.end(), [this, nextState, linkId](Transact* transact) \
+            { _trace->record(TraceEvent::UNLINKED, transact->getID(), transact->getCurrentState(), _modelTime, linkId.id, nextState);
+                this->traceChain(TraceEvent::CHAIN_REMOVE, TraceEntity::LINK, linkId.id, transact); });
+    }
 
     //emplasing to _CEC each transact after currTransact, setting current model time and setting unlink state 
     std::for_each(releasedTrans.begin(), releasedTrans.end(), [ this,nextState,&emplaceIt ] (Transact* emplTransact) \
         { emplTransact->setTime(this->getModelTime()); emplTransact->setNextState(nextState); emplaceIt++;
-            emplaceIt = (this->_CEC.emplace(emplaceIt, emplTransact));});
+            emplaceIt = (this->_CEC.emplace(emplaceIt, emplTransact));
+            this->traceChain(TraceEvent::CHAIN_INSERT, TraceEntity::CEC, 0, emplTransact); });
 
     //making transact ID string
     std::for_each(releasedTrans.begin(),releasedTrans.end(),[ &transIDString ](Transact* transact){ transIDString += std::to_string(transact->getID()) + ';';});   
 
     if (_simLogs->isEnable_CFECLog()) {
-        message = "\"unlinking\" Xact:" + transIDString + " from \"" + linkName + "\" to state:" + std::to_string(nextState) + " model time: " + std::to_string(_modelTime) \
-                   + '\n' + _FEC.getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
+        SIMCPP_PROFILE_SCOPE(LOGGING);
+        message = "\"unlinking\" Xact:" + transIDString + " from \"" + _links.getName(linkId) + "\" to state:" + std::to_string(nextState) + " model time: " + std::to_string(_modelTime) \
+                   + '\n' + _FEC->getAsString() + '\n' + _CEC.getAsString() + '\n' + _links.getAsString() + '\n'; 
         _simLogs->logMess_CFECLog(message);
     }
 
     if (_simLogs->isEnable_transactLog()) {
+        SIMCPP_PROFILE_SCOPE(LOGGING);
         message = "Xact:" + transIDString + " at state: " + std::to_string((currTransact)->getCurrentState()) + "; model time: " \
-                                + std::to_string(_modelTime) + ": unlinking from \"" + linkName;                 
+                                + std::to_string(_modelTime) + ": unlinking from \"" + _links.getName(linkId);                 
         _simLogs->logMess_transactLog(message);
     }
 }
 
-void SimCPP::storage(const std::string storageName, const unsigned int _maxChannels) {
+StorageId SimCPP::storage(const std::string& storageName, const unsigned int _maxChannels) {
     if (this->isRunning()) {
         throw std::logic_error("You cannot interact with the model storages after \"start\"ing the model");
     }
-    _storages.storageAppend(storageName, _maxChannels);
+    return _storages.storageAppend(storageName, _maxChannels);
+}
+
+TableId SimCPP::table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy) {
+    if (this->isRunning()) {
+        throw std::logic_error("You cannot interact with the model tables after \"start\"ing the model");
+    }
+    return _tables.table(tableName, upperLimit, width, classesNumb, sketchAccuracy);
 }
 
-unsigned int SimCPP::getStorageParam(const std::string storageName, const std::string SNA) {
+TableId SimCPP::qtable(const std::string& tableName, QueueId queueId, long double upperLimit, long double width, unsigned int classesNumb, \
+    double sketchAccuracy) {
+    if (this->isRunning()) {
+        throw std::logic_error("You cannot interact with the model tables after \"start\"ing the model");
+    }
+    return _tables.qtable(tableName, queueId, upperLimit, width, classesNumb, sketchAccuracy);
+}
+
+unsigned int SimCPP::getStorageParam(StorageId storageId, SNA attribute) {
     if (!this->isRunning()) {
         throw std::logic_error("You cannot interact with the model until you initialize it with \"start\"");
     }
-    return _storages.getStorageParam(storageName, SNA);
+    return _storages.getStorageParam(storageId, attribute);
 }
-
-double SimCPP::exponential(double mean) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::exponential_distribution<> dist(1. / mean);
-    double randomValue = dist(gen);
-    return randomValue;
-}
\ No newline at end of file
@@ -62,7 +62,7 @@ void SimLogs::Logs::logMess (std::string message, bool framing) {
             std::string frame = {"==--+"}; 
             out = frame + '\n' + out + '\n' + frame;
         }
-        *_fLog <<out<<std::endl;
+        *_fLog <<out<<'\n'; //no flush per message, the stream is flushed when it is closed
         if (_fLog->bad()) {
             std::cout<<"Error when trying to write to the logging file. Logging mode will be disabled, but the execution of the model will continue."<<std::endl;
             _fLog = nullptr;
@@ -1,31 +1,75 @@
 #pragma once
 
 #include "Transact.h"
+#include "EventChain.h"
+#include "SymbolTable.h"
+#include "Checkpoint.h"
 #include <algorithm>
 #include <stdexcept>
 #include <vector>
+#include <cmath>
+
+//final statistics of a storage as GPSS prints them, NaN where the report shows "------"
+struct StorageStat {
+    std::string name;
+    unsigned int capacity; //CAP.
+    unsigned int available; //MIN.
+    unsigned int cont; //channels in use
+    unsigned long delay; //transacts in the delay chain
+    unsigned long maxCont; //MAX.
+    unsigned long entries; //ENTRIES
+    long double aveCont; //AVE.C.
+    long double util; //UTIL.
+};
 
 class Storages {
     friend class SimCPP;
 
     private:
         class Storage;
-        std::vector<Storage*> _storages;
+        std::vector<Storage*> _storages; //indexed by StorageId
+        SymbolTable<StorageId> _names;
+        std::vector<Transact*> _grantedTrans; //reused by every leave
 
         Storages(){};
-        std::vector<Storage*>::iterator chooseStorage(const std::string storageName);
-        void storageAppend(const std::string storageName, const unsigned int maxChannels);
-        bool contains(const std::string storageName);
+        StorageId storageAppend(const std::string& storageName, const unsigned int maxChannels);
+        bool contains(const std::string& storageName) { return _names.contains(storageName); }
+        EventChain& getDelayChain(StorageId storageId);
+        void restoreIndex(StorageId storageId); //after the delay chain is restored
     public:
-        unsigned int enter(Transact* transact, const std::string storageName, const unsigned int numbOfChannels);
-        unsigned int leave(Transact* transact, const std::string storageName, const unsigned int numbOfChannels);
-        unsigned int getStorageParam(const std::string storageName, const std::string SNA);
-        std::string getFinalStatString(long double endModelTime);
+        ~Storages();
+
+        StorageId getId(const std::string& storageName);
+        const std::string& getName(StorageId storageId) { return _names.getName(storageId); }
+        unsigned int enter(Transact* transact, StorageId storageId, const unsigned int numbOfChannels); //0 if the channels are busy
+        void delay(Transact* transact, StorageId storageId, const unsigned int numbOfChannels); //off the CEC until the channels are granted
+        //transacts of the delay chain that got their channels, in the delay chain order
+        const std::vector<Transact*>& leave(Transact* transact, StorageId storageId, const unsigned int numbOfChannels);
+        //transacts of the delay chain that fit the free channels at time, for a storage restored with a larger capacity
+        const std::vector<Transact*>& grant(StorageId storageId, long double time);
+        unsigned int getStorageParam(StorageId storageId, SNA attribute);
+        long double getArea(StorageId storageId, long double time); //integral of the seized channels from the last reset to time
+        void reset(long double resetTime); //GPSS RESET, seized channels stay
+        std::vector<StorageStat> getFinalStats(long double endModelTime); //the model can go on
+        static std::string getFinalStatString(const std::vector<StorageStat>& storageStats);
+        //of one storage, the delay chain is saved with the transacts by SimCPP
+        void save(StorageId storageId, CheckpointWriter& writer);
+        void restore(StorageId storageId, CheckpointReader& reader);
 };
 
+//the delay chain is also split by demand: a chain per demand through Transact::_skipNext[0] (free outside user chains),
+//ordered by the delay number in _linkSeq, so LEAVE looks at the heads of the demands that fit and nothing else
 class Storages::Storage {
     private:
-        std::vector<Transact*> _blockList;
+        struct DemandChain {
+            unsigned int demand;
+            Transact* head;
+            Transact* tail;
+        };
+
+        EventChain _delayChain; //transacts waiting for channels, FIFO
+        std::vector<DemandChain> _demandChains; //nonempty ones in the order of demand
+        unsigned long _delaySeq;
         const unsigned int _maxChannels;
         unsigned int _currChannels; //count of seized! channels
         const std::string _storageName;
@@ -34,57 +78,108 @@ class Storages::Storage {
         unsigned long _maxProcessLength; //MAX.
         long double _cumSumCont; //AVE.CONT. = _cumSumCont / endModelTime
         long double _prevStorageTime; //_cumSumCont = (currTransTime - prevStorageTime) * currChannels
+        long double _resetTime; //statistics are measured from here
 
         void enterStat(unsigned long numbOfChannels, long double currTransTime);
         void leaveStat(unsigned long numbOfChannels, long double currTransTime);
     public:
-        Storage(const std::string name, const unsigned int maxChannels): _storageName(name), _maxChannels(maxChannels), _currChannels(0), \
-            _numbEnterTrans(0), _maxProcessLength(0), _cumSumCont(.0), _prevStorageTime(0) {};
+        Storage(const std::string& name, const unsigned int maxChannels): _delayChain(EventChain (name)), _delaySeq(0), _maxChannels(maxChannels), _currChannels(0), \
+            _storageName(name), _numbEnterTrans(0), _maxProcessLength(0), _cumSumCont(.0), _prevStorageTime(0), _resetTime(0) {};
         unsigned int enter(Transact* transact, const unsigned int numbOfChannels);
-        unsigned int leave(Transact* transact, const unsigned int numbOfChannels);
-        unsigned int getStorageParam(const std::string storageName, const std::string SNA);
-        const std::string getName() { return _storageName; }
+        void delay(Transact* transact, const unsigned int numbOfChannels);
+        void leave(Transact* transact, const unsigned int numbOfChannels, std::vector<Transact*>& grantedTrans);
+        void grant(long double time, std::vector<Transact*>& grantedTrans);
+        void restoreIndex();
+        unsigned int getStorageParam(SNA attribute);
+        long double getArea(long double time) { return _cumSumCont + (time - _prevStorageTime) * _currChannels; }
+        EventChain& getDelayChain() { return _delayChain; }
+        const std::string& getName() { return _storageName; }
+        unsigned int getCapacity() { return _maxChannels; }
         static std::string getFinalStatMeaningString() { return "STORAGE\t\tCAP.\tMIN.\tMAX.\tENTRIES\t\tAVE.C.\t\tUTIL."; }
-        std::string getFinalStatString(long double endModelTime);
+        void reset(long double resetTime);
+        StorageStat getFinalStat(long double endModelTime);
+        static std::string getFinalStatString(const StorageStat& storageStat);
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
 };
 
 //-----
 
-std::string Storages::getFinalStatString(long double endModelTime) {
+Storages::~Storages() {
+    std::for_each(_storages.begin(), _storages.end(), [](Storages::Storage* storage){ delete storage; });
+}
+
+long double Storages::getArea(StorageId storageId, long double time) {
+    return _storages[storageId.id]->getArea(time);
+}
+
+void Storages::reset(long double resetTime) {
+    std::for_each(_storages.begin(),_storages.end(),[resetTime](Storages::Storage* storage){ storage->reset(resetTime); });
+}
+
+std::vector<StorageStat> Storages::getFinalStats(long double endModelTime) {
+    std::vector<StorageStat> storageStats;
+    std::for_each(_storages.begin(),_storages.end(),[&storageStats, endModelTime](Storages::Storage* storage) \
+        { storageStats.push_back(storage->getFinalStat(endModelTime)); });
+    return storageStats;
+}
+
+std::string Storages::getFinalStatString(const std::vector<StorageStat>& storageStats) {
     std::string message = '\n' + Storages::Storage::getFinalStatMeaningString();
-    std::for_each(_storages.begin(),_storages.end(),[&message, endModelTime](Storages::Storage* storage) \
-        { message += '\n' + storage->getFinalStatString(endModelTime); });
+    std::for_each(storageStats.begin(),storageStats.end(),[&message](const StorageStat& storageStat) \
+        { message += '\n' + Storages::Storage::getFinalStatString(storageStat); });
     return message;
 }
 
-std::vector<Storages::Storage*>::iterator Storages::chooseStorage(const std::string storageName) {
-    std::vector<Storage*>::iterator storagesIt = std::find_if(_storages.begin(), _storages.end(), \
-        [ storageName ](Storages::Storage* storage){return storageName == storage->getName();});
-    if (storagesIt == _storages.end())
-        throw std::logic_error("You cannot enter/leave unannounced storage ()" + storageName + ')');
-    return storagesIt;
+StorageId Storages::getId(const std::string& storageName) {
+    if (!this->contains(storageName))
+        throw std::logic_error("You cannot enter/leave unannounced storage (" + storageName + ')');
+    return _names.find(storageName);
 }
 
-unsigned int Storages::enter(Transact* transact, const std::string storageName, const unsigned int numbOfChannels) {
-    unsigned int seizedChannels = (*chooseStorage(storageName))->enter(transact, numbOfChannels);
+unsigned int Storages::enter(Transact* transact, StorageId storageId, const unsigned int numbOfChannels) {
+    unsigned int seizedChannels = _storages[storageId.id]->enter(transact, numbOfChannels);
     return seizedChannels;
 }
+
+void Storages::delay(Transact* transact, StorageId storageId, const unsigned int numbOfChannels) {
+    _storages[storageId.id]->delay(transact, numbOfChannels);
+}
         
-unsigned int Storages::leave(Transact* transact, const std::string storageName, const unsigned int numbOfChannels) {
-    unsigned int releasedChannels = (*chooseStorage(storageName))->leave(transact, numbOfChannels);
-    return releasedChannels;
+const std::vector<Transact*>& Storages::leave(Transact* transact, StorageId storageId, const unsigned int numbOfChannels) {
+    _grantedTrans.clear();
+    _storages[storageId.id]->leave(transact, numbOfChannels, _grantedTrans);
+    return _grantedTrans;
+}
+
+void Storages::save(StorageId storageId, CheckpointWriter& writer) {
+    _storages[storageId.id]->save(writer);
+}
+
+void Storages::restore(StorageId storageId, CheckpointReader& reader) {
+    _storages[storageId.id]->restore(reader);
 }
 
-bool Storages::contains(const std::string storageName) {
-    return (std::find_if(_storages.begin(),_storages.end(),[ storageName ]( Storages::Storage* storage) \
-            {return storageName == storage->getName();}) != _storages.end());
+const std::vector<Transact*>& Storages::grant(StorageId storageId, long double time) {
+    _grantedTrans.clear();
+    _storages[storageId.id]->grant(time, _grantedTrans);
+    return _grantedTrans;
 }
 
-void Storages::storageAppend(const std::string storageName, const unsigned int maxChannels) {
+EventChain& Storages::getDelayChain(StorageId storageId) {
+    return _storages[storageId.id]->getDelayChain();
+}
+
+void Storages::restoreIndex(StorageId storageId) {
+    _storages[storageId.id]->restoreIndex();
+}
+
+StorageId Storages::storageAppend(const std::string& storageName, const unsigned int maxChannels) {
     if (this->contains(storageName))
         throw std::logic_error("You cannot create storages with the same names (" + storageName + ')');
     
     _storages.emplace_back(new Storages::Storage (storageName, maxChannels));
+    return _names.intern(storageName);
 }
 
 //-----
@@ -103,22 +198,57 @@ void Storages::Storage::leaveStat(unsigned long numbOfChannels, long double curr
     _prevStorageTime = currTransTime;
 }
 
-std::string Storages::Storage::getFinalStatString(long double endModelTime) {
-    std::string statString = _storageName + '\t';
-    std::string avCountStr, UTILStr; //AVE.C. UTIL.
-    this->leaveStat(0, endModelTime);
+void Storages::Storage::reset(long double resetTime) {
+    //GPSS RESET: entry count and maximum are the current content
+    _numbEnterTrans = _currChannels;
+    _maxProcessLength = _currChannels;
+    _cumSumCont = 0;
+    _prevStorageTime = resetTime;
+    _resetTime = resetTime;
+}
+
+void Storages::Storage::save(CheckpointWriter& writer) {
+    writer.write(_currChannels);
+    writer.write(_numbEnterTrans);
+    writer.write(_maxProcessLength);
+    writer.write(_cumSumCont);
+    writer.write(_prevStorageTime);
+    writer.write(_resetTime);
+}
 
-    if (endModelTime > 0) {
-        avCountStr = std::to_string(_cumSumCont / endModelTime);
-        UTILStr = std::to_string(_cumSumCont / endModelTime / _maxChannels);
-    }
-    else {
-        avCountStr = "------";
-        UTILStr = "------";
-    }
+void Storages::Storage::restore(CheckpointReader& reader) {
+    reader.read(_currChannels);
+    reader.read(_numbEnterTrans);
+    reader.read(_maxProcessLength);
+    reader.read(_cumSumCont);
+    reader.read(_prevStorageTime);
+    reader.read(_resetTime);
+}
 
-    statString += std::to_string(_maxChannels) + '\t' + std::to_string(_maxChannels - _currChannels) + '\t' + \
-        std::to_string(_maxProcessLength) + "\t" + std::to_string(_numbEnterTrans) + "\t\t" + avCountStr + '\t' + UTILStr;
+StorageStat Storages::Storage::getFinalStat(long double endModelTime) {
+    StorageStat storageStat;
+    long double cumSumCont = _cumSumCont + (endModelTime - _prevStorageTime) * _currChannels;
+    long double measuredTime = endModelTime - _resetTime;
+
+    storageStat.name = _storageName;
+    storageStat.capacity = _maxChannels;
+    storageStat.available = _maxChannels - _currChannels;
+    storageStat.cont = _currChannels;
+    storageStat.delay = _delayChain.size();
+    storageStat.maxCont = _maxProcessLength;
+    storageStat.entries = _numbEnterTrans;
+    storageStat.aveCont = measuredTime > 0 ? cumSumCont / measuredTime : NAN;
+    storageStat.util = measuredTime > 0 ? cumSumCont / measuredTime / _maxChannels : NAN;
+    return storageStat;
+}
+
+std::string Storages::Storage::getFinalStatString(const StorageStat& storageStat) {
+    std::string statString = storageStat.name + '\t';
+    std::string avCountStr = std::isnan(storageStat.aveCont) ? "------" : std::to_string(storageStat.aveCont); //AVE.C.
+    std::string UTILStr = std::isnan(storageStat.util) ? "------" : std::to_string(storageStat.util); //UTIL.
+
+    statString += std::to_string(storageStat.capacity) + '\t' + std::to_string(storageStat.available) + '\t' + \
+        std::to_string(storageStat.maxCont) + "\t" + std::to_string(storageStat.entries) + "\t\t" + avCountStr + '\t' + UTILStr;
     
     return statString;
 }
@@ -128,8 +258,6 @@ unsigned int Storages::Storage::enter(Transact* transact, const unsigned int num
         throw std::logic_error("Storage request exceeds total capacity (" + _storageName + ')');
 
     if (numbOfChannels > (_maxChannels - _currChannels)) {
-        transact->block();
-        _blockList.emplace_back(transact);
         return 0;
     }
     else {
@@ -139,30 +267,72 @@ unsigned int Storages::Storage::enter(Transact* transact, const unsigned int num
     return numbOfChannels;
 }
 
-unsigned int Storages::Storage::leave(Transact* transact, const unsigned int numbOfChannels) {
+void Storages::Storage::leave(Transact* transact, const unsigned int numbOfChannels, std::vector<Transact*>& grantedTrans) {
     if (numbOfChannels > _currChannels) {
             throw std::logic_error("Attempt to release more storage than existed (" + _storageName + ')');
     }
 
     _currChannels -= numbOfChannels;
-    std::for_each(_blockList.begin(), _blockList.end(), [](Transact* transactUnbl){ transactUnbl->unBlock(); });
-    _blockList.clear();
-
     this->leaveStat(numbOfChannels, transact->getTime());
-    return numbOfChannels;
+    this->grant(transact->getTime(), grantedTrans);
 }
 
-unsigned int Storages::getStorageParam(const std::string storageName, const std::string SNA) {
-    return (*chooseStorage(storageName))->getStorageParam(storageName, SNA);
+void Storages::Storage::grant(long double time, std::vector<Transact*>& grantedTrans) {
+    //GPSS first fit: every waiting transact whose demand fits now gets its channels, smaller demands may pass a larger one;
+    //the free channels only decrease, so the earliest waiting transact that fits is always the next one of the delay chain scan
+    while (!_demandChains.empty() && _demandChains.front().demand <= _maxChannels - _currChannels) {
+        std::vector<DemandChain>::iterator firstIt = _demandChains.begin();
+        for (std::vector<DemandChain>::iterator chainIt = firstIt + 1; chainIt != _demandChains.end() \
+            && chainIt->demand <= _maxChannels - _currChannels; chainIt++) {
+            if (chainIt->head->_linkSeq < firstIt->head->_linkSeq) {
+                firstIt = chainIt;
+            }
+        }
+        Transact* waiting = firstIt->head;
+        firstIt->head = waiting->_skipNext[0];
+        if (firstIt->head == nullptr) {
+            _demandChains.erase(firstIt);
+        }
+        _delayChain.eraseTrans(waiting);
+        _currChannels += waiting->getDemand();
+        this->enterStat(waiting->getDemand(), time);
+        waiting->unBlock();
+        grantedTrans.push_back(waiting);
+    }
 }
 
-unsigned int Storages::Storage::getStorageParam(const std::string storageName, const std::string SNA) {
-    if (SNA == "CH") {
-        return (_currChannels);
+void Storages::Storage::delay(Transact* transact, const unsigned int numbOfChannels) {
+    transact->block(numbOfChannels);
+    _delayChain.emplace(_delayChain.end(), transact);
+    transact->_linkSeq = _delaySeq++;
+    transact->_skipNext[0] = nullptr;
+    std::vector<DemandChain>::iterator chainIt = std::lower_bound(_demandChains.begin(), _demandChains.end(), numbOfChannels, \
+        [](const DemandChain& chain, unsigned int demand){ return chain.demand < demand; });
+    if (chainIt == _demandChains.end() || chainIt->demand != numbOfChannels) {
+        _demandChains.insert(chainIt, DemandChain {numbOfChannels, transact, transact});
+    }
+    else {
+        chainIt->tail->_skipNext[0] = transact;
+        chainIt->tail = transact;
     }
-    else if (SNA == "R")
-    {
-        return (_maxChannels - _currChannels);
+}
+
+void Storages::Storage::restoreIndex() {
+    std::vector<Transact*> waiting(_delayChain.begin(), _delayChain.end());
+    _demandChains.clear();
+    std::for_each(waiting.begin(), waiting.end(), [this](Transact* transact) {
+        _delayChain.eraseTrans(transact);
+        this->delay(transact, transact->getDemand());
+    });
+}
+
+unsigned int Storages::getStorageParam(StorageId storageId, SNA attribute) {
+    return _storages[storageId.id]->getStorageParam(attribute);
+}
+
+unsigned int Storages::Storage::getStorageParam(SNA attribute) {
+    if (attribute == SNA::CH) {
+        return (_currChannels);
     }
-    throw std::logic_error("Unknown system numeric attribute \"" + SNA + '\"');
+    return (_maxChannels - _currChannels); //SNA::R
 }
\ No newline at end of file
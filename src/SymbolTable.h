@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//integer handles of named model entities, names are resolved once and blocks work with handles
+struct StorageId { unsigned int id; };
+struct QueueId { unsigned int id; };
+struct LinkId { unsigned int id; };
+struct ParamId { unsigned int id; };
+struct VariableId { unsigned int id; };
+struct TableId { unsigned int id; };
+
+//system numeric attributes of storages and links
+enum class SNA { CH, R };
+
+//order of transacts in a user chain, PARAM is ascending by a transact parameter
+enum class LinkOrder { FIFO, LIFO, PARAM };
+
+//transacts released by UNLINK: from the head, from the tail (BACK) or the ones with a parameter equal to a value
+enum class UnlinkFrom { HEAD, BACK, PARAM };
+
+template <class Id>
+class SymbolTable {
+    private:
+        std::unordered_map<std::string, unsigned int> _ids;
+        std::vector<std::string> _names;
+    public:
+        bool contains(const std::string& name) { return _ids.find(name) != _ids.end(); }
+        unsigned int size() { return _names.size(); }
+        const std::string& getName(Id handle) { return _names[handle.id]; }
+
+        Id intern(const std::string& name); //the name gets the next handle if it is new
+        Id find(const std::string& name); //throws for unknown names
+};
+
+SNA parseSNA(const std::string& SNAName);
+
+//-----
+
+template <class Id>
+Id SymbolTable<Id>::intern(const std::string& name) {
+    std::unordered_map<std::string, unsigned int>::iterator idIt = _ids.find(name);
+    if (idIt != _ids.end()) {
+        return Id {idIt->second};
+    }
+    _ids.emplace(name, _names.size());
+    _names.push_back(name);
+    return Id {(unsigned int)_names.size() - 1};
+}
+
+template <class Id>
+Id SymbolTable<Id>::find(const std::string& name) {
+    std::unordered_map<std::string, unsigned int>::iterator idIt = _ids.find(name);
+    if (idIt == _ids.end()) {
+        throw std::logic_error("Reference to an unannounced entity (" + name + ')');
+    }
+    return Id {idIt->second};
+}
+
+SNA parseSNA(const std::string& SNAName) {
+    if (SNAName == "CH") {
+        return SNA::CH;
+    }
+    else if (SNAName == "R") {
+        return SNA::R;
+    }
+    throw std::logic_error("Unknown system numeric attribute \"" + SNAName + '\"');
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include "SymbolTable.h"
+#include "Estimators.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//quantiles of a stream in fixed memory with a relative error (DDSketch): a value v > 0 is counted in the bucket
+//ceil(log(v) / log(gamma)), gamma = (1 + accuracy) / (1 - accuracy), negative values in a mirrored store, zeros apart;
+//a store keeps at most maxBuckets consecutive buckets, beyond it the lowest ones are collapsed into one,
+//sketches of the same accuracy are merged without any loss (parallel replications)
+class QuantileSketch {
+    private:
+        //counts of consecutive buckets from the offset one
+        struct Store {
+            std::vector<unsigned long> counts;
+            int offset;
+            unsigned long numb;
+        };
+
+        double _accuracy;
+        double _gamma;
+        double _logGamma;
+        unsigned int _maxBuckets;
+        Store _positive;
+        Store _negative; //of -v
+        unsigned long _zeroNumb;
+        double _min;
+        double _max;
+
+        int getIndex(double value) const { return (int)std::ceil(std::log(value) / _logGamma); }
+        double getValue(int index) const { return 2 * std::exp(index * _logGamma) / (_gamma + 1); } //within the accuracy of the bucket values
+        void add(Store& store, int index, unsigned long count);
+    public:
+        QuantileSketch(double accuracy = 0.01, unsigned int maxBuckets = 2048);
+
+        void add(double value, unsigned long count = 1);
+        void merge(const QuantileSketch& sketch);
+        void clear();
+        unsigned long getNumb() const { return _negative.numb + _zeroNumb + _positive.numb; }
+        double getAccuracy() const { return _accuracy; }
+        double getQuantile(double probability) const; //NaN for an empty sketch
+
+        void save(CheckpointWriter& writer) const;
+        void restore(CheckpointReader& reader); //of a sketch of the same accuracy
+};
+
+//GPSS TABLE and QTABLE statistics, NaN where the report shows "------":
+//frequency class 0 is value <= upperLimit, class i is upperLimit + (i-1) * width < value <= upperLimit + i * width,
+//the last class has no upper limit
+struct TableStat {
+    std::string name;
+    Estimator values; //ENTRIES, MEAN, STD.DEV.
+    long double upperLimit;
+    long double width;
+    std::vector<unsigned long> frequencies;
+    bool sketched; //quantiles come from the sketch, otherwise they are interpolated in the frequency classes
+    QuantileSketch sketch;
+};
+
+class Tables {
+    friend class SimCPP;
+    private:
+        class Table;
+        std::vector<Table*> _tables; //indexed by TableId
+        SymbolTable<TableId> _names;
+        std::vector<std::pair<QueueId,TableId>> _queueTables; //QTABLEs of the queues
+
+        Tables(){}
+    public:
+        ~Tables();
+
+        //sketchAccuracy is the relative error of the quantiles, 0 is no sketch
+        TableId table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy);
+        //the queue times of the transacts departing the queue are tabulated
+        TableId qtable(const std::string& tableName, QueueId queueId, long double upperLimit, long double width, unsigned int classesNumb, \
+            double sketchAccuracy);
+        TableId getId(const std::string& tableName) { return _names.find(tableName); } //throws for undefined tables
+        const std::string& getName(TableId tableId) { return _names.getName(tableId); }
+        bool isQueueTable(TableId tableId);
+        void tabulate(TableId tableId, long double value, unsigned long count = 1);
+        void depart(QueueId queueId, long double queueTime);
+        void reset(); //GPSS RESET
+        std::vector<TableStat> getFinalStats();
+
+        static void merge(TableStat& tableStat, const TableStat& addedStat); //of the same table, replications of a model
+        static double getQuantile(const TableStat& tableStat, double probability);
+        static std::string getFinalStatString(const std::vector<TableStat>& tableStats);
+        //collected values of the tables, the tables of a restored model are defined by it as they were
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
+};
+
+class Tables::Table {
+    private:
+        TableStat _stat;
+    public:
+        Table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy);
+
+        void tabulate(long double value, unsigned long count);
+        void reset();
+        const TableStat& getFinalStat() { return _stat; }
+        static std::string getFinalStatString(const TableStat& tableStat);
+        static std::string getFinalStatMeaningString() { return "TABLE\t\tENTRIES\tMEAN\t\tSTD.DEV.\tP50\t\tP95\t\tP99"; }
+        void save(CheckpointWriter& writer);
+        void restore(CheckpointReader& reader);
+};
+
+//-----
+
+QuantileSketch::QuantileSketch(double accuracy, unsigned int maxBuckets): _accuracy(accuracy), _maxBuckets(maxBuckets), \
+    _positive {{}, 0, 0}, _negative {{}, 0, 0}, _zeroNumb(0), _min(INFINITY), _max(-INFINITY) {
+    if (accuracy <= 0 || accuracy >= 1 || maxBuckets == 0) {
+        throw std::logic_error("Quantile sketch needs 0 < accuracy < 1 and at least one bucket");
+    }
+    _gamma = (1 + accuracy) / (1 - accuracy);
+    _logGamma = std::log(_gamma);
+}
+
+void QuantileSketch::add(double value, unsigned long count) {
+    if (count == 0 || std::isnan(value)) {
+        return;
+    }
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    if (value > 0) {
+        this->add(_positive, this->getIndex(value), count);
+    }
+    else if (value < 0) {
+        this->add(_negative, this->getIndex(-value), count);
+    }
+    else {
+        _zeroNumb += count;
+    }
+}
+
+void QuantileSketch::add(Store& store, int index, unsigned long count) {
+    if (store.counts.empty()) {
+        //the store never holds more than _maxBuckets, a new extreme value does not reallocate it
+        store.counts.reserve(_maxBuckets);
+        store.counts.push_back(0);
+        store.offset = index;
+    }
+    else if (index < store.offset) {
+        //the buckets below the lowest kept one are collapsed into it
+        int lowest = std::max(index, store.offset + (int)store.counts.size() - (int)_maxBuckets);
+        store.counts.insert(store.counts.begin(), store.offset - lowest, 0);
+        store.offset = lowest;
+        index = lowest;
+    }
+    else if (index >= store.offset + (int)store.counts.size()) {
+        if (index - store.offset + 1 > (int)_maxBuckets) {
+            //the buckets below the new lowest one are collapsed into it before the store grows
+            unsigned int collapsed = index - store.offset + 1 - _maxBuckets;
+            unsigned int kept = std::min(collapsed + 1, (unsigned int)store.counts.size());
+            unsigned long lowCount = std::accumulate(store.counts.begin(), store.counts.begin() + kept, 0ul);
+            store.counts[kept - 1] = lowCount;
+            store.counts.erase(store.counts.begin(), store.counts.begin() + kept - 1);
+            store.offset += collapsed;
+        }
+        store.counts.resize(index - store.offset + 1, 0);
+    }
+    store.counts[index - store.offset] += count;
+    store.numb += count;
+}
+
+void QuantileSketch::merge(const QuantileSketch& sketch) {
+    if (sketch._accuracy != _accuracy) {
+        throw std::logic_error("Quantile sketches of different accuracies cannot be merged");
+    }
+    for (unsigned int i = 0; i < sketch._positive.counts.size(); i++) {
+        if (sketch._positive.counts[i] != 0) {
+            this->add(_positive, sketch._positive.offset + i, sketch._positive.counts[i]);
+        }
+    }
+    for (unsigned int i = 0; i < sketch._negative.counts.size(); i++) {
+        if (sketch._negative.counts[i] != 0) {
+            this->add(_negative, sketch._negative.offset + i, sketch._negative.counts[i]);
+        }
+    }
+    _zeroNumb += sketch._zeroNumb;
+    _min = std::min(_min, sketch._min);
+    _max = std::max(_max, sketch._max);
+}
+
+void QuantileSketch::clear() {
+    //the stores keep their capacity
+    _positive.counts.clear();
+    _positive.offset = 0;
+    _positive.numb = 0;
+    _negative.counts.clear();
+    _negative.offset = 0;
+    _negative.numb = 0;
+    _zeroNumb = 0;
+    _min = INFINITY;
+    _max = -INFINITY;
+}
+
+double QuantileSketch::getQuantile(double probability) const {
+    unsigned long numb = this->getNumb();
+    if (numb == 0) {
+        return NAN;
+    }
+    //rank of the lower one of the order statistics around the quantile, from the most negative value
+    unsigned long rank = (unsigned long)(std::min(std::max(probability, 0.), 1.) * (numb - 1));
+    double value;
+    if (rank < _negative.numb) {
+        unsigned long below = 0;
+        int i = _negative.counts.size() - 1;
+        while ((below += _negative.counts[i]) <= rank) {
+            i--;
+        }
+        value = -this->getValue(_negative.offset + i);
+    }
+    else if (rank < _negative.numb + _zeroNumb) {
+        value = 0;
+    }
+    else {
+        unsigned long below = _negative.numb + _zeroNumb;
+        unsigned int i = 0;
+        while ((below += _positive.counts[i]) <= rank) {
+            i++;
+        }
+        value = this->getValue(_positive.offset + i);
+    }
+    return std::min(std::max(value, _min), _max);
+}
+
+void QuantileSketch::save(CheckpointWriter& writer) const {
+    writer.write(_accuracy);
+    writer.write(_positive.counts);
+    writer.write(_positive.offset);
+    writer.write(_positive.numb);
+    writer.write(_negative.counts);
+    writer.write(_negative.offset);
+    writer.write(_negative.numb);
+    writer.write(_zeroNumb);
+    writer.write(_min);
+    writer.write(_max);
+}
+
+void QuantileSketch::restore(CheckpointReader& reader) {
+    if (reader.get<double>() != _accuracy) {
+        throw std::logic_error("Quantile sketch of the checkpoint has another accuracy");
+    }
+    reader.read(_positive.counts);
+    reader.read(_positive.offset);
+    reader.read(_positive.numb);
+    reader.read(_negative.counts);
+    reader.read(_negative.offset);
+    reader.read(_negative.numb);
+    reader.read(_zeroNumb);
+    reader.read(_min);
+    reader.read(_max);
+}
+
+//-----
+
+Tables::~Tables() {
+    std::for_each(_tables.begin(), _tables.end(), [](Tables::Table* table){ delete table; });
+}
+
+TableId Tables::table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy) {
+    if (_names.contains(tableName)) {
+        throw std::logic_error("You cannot create tables with the same names (" + tableName + ')');
+    }
+    if (width <= 0 || classesNumb < 2) {
+        throw std::logic_error("Table \"" + tableName + "\" needs a positive class width and at least two frequency classes");
+    }
+    _tables.push_back(new Table(tableName, upperLimit, width, classesNumb, sketchAccuracy));
+    return _names.intern(tableName);
+}
+
+TableId Tables::qtable(const std::string& tableName, QueueId queueId, long double upperLimit, long double width, unsigned int classesNumb, \
+    double sketchAccuracy) {
+    TableId tableId = this->table(tableName, upperLimit, width, classesNumb, sketchAccuracy);
+    _queueTables.emplace_back(queueId, tableId);
+    return tableId;
+}
+
+bool Tables::isQueueTable(TableId tableId) {
+    return std::find_if(_queueTables.begin(), _queueTables.end(), [tableId](const std::pair<QueueId,TableId>& queueTable) \
+        { return queueTable.second.id == tableId.id; }) != _queueTables.end();
+}
+
+void Tables::tabulate(TableId tableId, long double value, unsigned long count) {
+    _tables[tableId.id]->tabulate(value, count);
+}
+
+void Tables::depart(QueueId queueId, long double queueTime) {
+    std::for_each(_queueTables.begin(), _queueTables.end(), [this, queueId, queueTime](const std::pair<QueueId,TableId>& queueTable) {
+        if (queueTable.first.id == queueId.id) {
+            _tables[queueTable.second.id]->tabulate(queueTime, 1);
+        }
+    });
+}
+
+void Tables::save(CheckpointWriter& writer) {
+    writer.write((uint64_t)_tables.size());
+    for (unsigned int i = 0; i < _tables.size(); i++) {
+        writer.write(_names.getName(TableId {i}));
+        _tables[i]->save(writer);
+    }
+}
+
+void Tables::restore(CheckpointReader& reader) {
+    uint64_t tablesNumb = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < tablesNumb; i++) {
+        std::string name = reader.get<std::string>();
+        if (i >= _tables.size() || _names.getName(TableId {(unsigned int)i}) != name) {
+            throw std::logic_error("Table \"" + name + "\" of the checkpoint is not defined by the model at the same place");
+        }
+        _tables[i]->restore(reader);
+    }
+}
+
+void Tables::reset() {
+    std::for_each(_tables.begin(), _tables.end(), [](Tables::Table* table){ table->reset(); });
+}
+
+std::vector<TableStat> Tables::getFinalStats() {
+    std::vector<TableStat> tableStats;
+    std::for_each(_tables.begin(), _tables.end(), [&tableStats](Tables::Table* table){ tableStats.push_back(table->getFinalStat()); });
+    return tableStats;
+}
+
+void Tables::merge(TableStat& tableStat, const TableStat& addedStat) {
+    if (tableStat.upperLimit != addedStat.upperLimit || tableStat.width != addedStat.width \
+        || tableStat.frequencies.size() != addedStat.frequencies.size() || tableStat.sketched != addedStat.sketched) {
+        throw std::logic_error("Table \"" + tableStat.name + "\" cannot be merged with a table of other classes");
+    }
+    tableStat.values.merge(addedStat.values);
+    for (unsigned int i = 0; i < tableStat.frequencies.size(); i++) {
+        tableStat.frequencies[i] += addedStat.frequencies[i];
+    }
+    if (tableStat.sketched) {
+        tableStat.sketch.merge(addedStat.sketch);
+    }
+}
+
+double Tables::getQuantile(const TableStat& tableStat, double probability) {
+    if (tableStat.sketched) {
+        return tableStat.sketch.getQuantile(probability);
+    }
+    unsigned long numb = tableStat.values.getNumb();
+    if (numb == 0) {
+        return NAN;
+    }
+    //linear inside the class, the open classes give their finite limit
+    double rank = std::min(std::max(probability, 0.), 1.) * numb;
+    unsigned long below = 0;
+    unsigned int i = 0;
+    while (i + 1 < tableStat.frequencies.size() && (below + tableStat.frequencies[i] < rank || tableStat.frequencies[i] == 0)) {
+        below += tableStat.frequencies[i++];
+    }
+    if (i == 0 || i + 1 == tableStat.frequencies.size()) {
+        return tableStat.upperLimit + (i == 0 ? 0 : (i - 1) * tableStat.width);
+    }
+    return tableStat.upperLimit + (i - 1 + (rank - below) / tableStat.frequencies[i]) * tableStat.width;
+}
+
+std::string Tables::getFinalStatString(const std::vector<TableStat>& tableStats) {
+    std::string message = '\n' + Table::getFinalStatMeaningString();
+    std::for_each(tableStats.begin(), tableStats.end(), [&message](const TableStat& tableStat) \
+        { message += '\n' + Table::getFinalStatString(tableStat); });
+    return message;
+}
+
+//-----
+
+Tables::Table::Table(const std::string& tableName, long double upperLimit, long double width, unsigned int classesNumb, double sketchAccuracy): \
+    _stat {tableName, Estimator(), upperLimit, width, std::vector<unsigned long>(classesNumb, 0), sketchAccuracy > 0, \
+    QuantileSketch(sketchAccuracy > 0 ? sketchAccuracy : 0.01)} {}
+
+void Tables::Table::tabulate(long double value, unsigned long count) {
+    long double place = std::ceil((value - _stat.upperLimit) / _stat.width);
+    unsigned int frequencyClass = place <= 0 ? 0 : (unsigned int)std::min(place, (long double)(_stat.frequencies.size() - 1));
+
+    _stat.frequencies[frequencyClass] += count;
+    _stat.values.add(value, count);
+    if (_stat.sketched) {
+        _stat.sketch.add(value, count);
+    }
+}
+
+void Tables::Table::reset() {
+    _stat.values = Estimator();
+    std::fill(_stat.frequencies.begin(), _stat.frequencies.end(), 0);
+    _stat.sketch.clear();
+}
+
+void Tables::Table::save(CheckpointWriter& writer) {
+    writer.write(_stat.values);
+    writer.write(_stat.frequencies);
+    _stat.sketch.save(writer);
+}
+
+void Tables::Table::restore(CheckpointReader& reader) {
+    std::vector<unsigned long> frequencies;
+    reader.read(_stat.values);
+    reader.read(frequencies);
+    if (frequencies.size() != _stat.frequencies.size()) {
+        throw std::logic_error("Table \"" + _stat.name + "\" of the checkpoint has another number of frequency classes");
+    }
+    _stat.frequencies = frequencies;
+    _stat.sketch.restore(reader);
+}
+
+std::string Tables::Table::getFinalStatString(const TableStat& tableStat) {
+    auto toString = [](double value) { return std::isnan(value) ? std::string("------") : std::to_string(value); };
+    std::string statString = tableStat.name + "\t\t" + std::to_string(tableStat.values.getNumb()) + '\t' + toString(tableStat.values.getMean()) \
+        + '\t' + toString(tableStat.values.getStdDev()) + '\t' + toString(getQuantile(tableStat, 0.5)) + '\t' + toString(getQuantile(tableStat, 0.95)) \
+        + '\t' + toString(getQuantile(tableStat, 0.99));
+
+    //frequency classes as GPSS prints them, the empty ones are left out
+    for (unsigned int i = 0; i < tableStat.frequencies.size(); i++) {
+        if (tableStat.frequencies[i] != 0) {
+            std::string upper = i + 1 == tableStat.frequencies.size() ? "OVERFLOW" : std::to_string(tableStat.upperLimit + i * tableStat.width);
+            statString += "\n\t" + upper + '\t' + std::to_string(tableStat.frequencies[i]) + '\t' \
+                + std::to_string(100. * tableStat.frequencies[i] / tableStat.values.getNumb());
+        }
+    }
+    return statString;
+}
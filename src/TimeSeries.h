@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class SeriesFormat { CSV, BINARY };
+
+//model state sampled over model time, SimCPP::setSeries fills it, one row per sample:
+//the first column is the model time, the others are named by SimCPP (Q$queue, S$storage, SU$storage, CH$link);
+//rows are kept in columnar buffers of blockRows rows and written block by block, so the memory stays bounded.
+//BINARY layout, all little endian: magic, version, number of columns, per column the name length and characters,
+//then blocks: number of rows, per column the values of the rows as doubles
+class TimeSeries {
+    private:
+        static constexpr char MAGIC[8] = {'S','I','M','C','P','P','T','S'};
+        static const uint32_t VERSION = 1;
+
+        std::ofstream _file;
+        SeriesFormat _format;
+        std::vector<std::string> _names;
+        std::vector<std::vector<double>> _columns;
+        unsigned int _blockRows;
+        unsigned long _rowsNumb; //written and buffered
+
+        void writeHeader();
+        void flush(); //the buffered rows to the file
+    public:
+        TimeSeries(const std::string& fileName, SeriesFormat format = SeriesFormat::BINARY, unsigned int blockRows = 4096);
+        ~TimeSeries() { this->close(); }
+
+        void setColumns(const std::vector<std::string>& names); //once, before the first row
+        void add(const std::vector<double>& row);
+        void close(); //flushes the rows and closes the file, idempotent
+        const std::vector<std::string>& getNames() { return _names; }
+        unsigned long getRowsNumb() { return _rowsNumb; }
+
+        //for decoders: false if the file is not a series, readBlock gives false at the end of the file
+        static bool readHeader(std::ifstream& file, std::vector<std::string>& names);
+        static bool readBlock(std::ifstream& file, std::vector<std::vector<double>>& columns);
+};
+
+//-----
+
+constexpr char TimeSeries::MAGIC[8];
+
+TimeSeries::TimeSeries(const std::string& fileName, SeriesFormat format, unsigned int blockRows): _format(format), _blockRows(blockRows), \
+    _rowsNumb(0) {
+    if (blockRows == 0) {
+        throw std::logic_error("Time series blocks must hold at least one row");
+    }
+    _file.open(fileName, format == SeriesFormat::BINARY ? std::ios::binary | std::ios::trunc : std::ios::trunc);
+    if (!_file) {
+        throw std::logic_error("Cannot open the time series file \"" + fileName + '\"');
+    }
+}
+
+void TimeSeries::setColumns(const std::vector<std::string>& names) {
+    if (!_names.empty()) {
+        throw std::logic_error("Columns of a time series are set once");
+    }
+    _names = names;
+    _columns.assign(names.size(), std::vector<double>());
+    std::for_each(_columns.begin(), _columns.end(), [this](std::vector<double>& column){ column.reserve(_blockRows); });
+    this->writeHeader();
+}
+
+void TimeSeries::writeHeader() {
+    if (_format == SeriesFormat::CSV) {
+        for (unsigned int i = 0; i < _names.size(); i++) {
+            _file << (i == 0 ? "" : ",") << _names[i];
+        }
+        _file << '\n';
+        return;
+    }
+    uint32_t version = VERSION, columnsNumb = _names.size();
+    _file.write(MAGIC, sizeof(MAGIC));
+    _file.write((const char*)&version, sizeof(version));
+    _file.write((const char*)&columnsNumb, sizeof(columnsNumb));
+    std::for_each(_names.begin(), _names.end(), [this](const std::string& name) {
+        uint32_t length = name.size();
+        _file.write((const char*)&length, sizeof(length));
+        _file.write(name.data(), length);
+    });
+}
+
+void TimeSeries::add(const std::vector<double>& row) {
+    if (row.size() != _columns.size()) {
+        throw std::logic_error("Time series row has " + std::to_string(row.size()) + " values for " + std::to_string(_columns.size()) + " columns");
+    }
+    for (unsigned int i = 0; i < row.size(); i++) {
+        _columns[i].push_back(row[i]);
+    }
+    _rowsNumb++;
+    if (_columns[0].size() == _blockRows) {
+        this->flush();
+    }
+}
+
+void TimeSeries::flush() {
+    uint32_t rowsNumb = _columns.empty() ? 0 : _columns[0].size();
+    if (rowsNumb == 0) {
+        return;
+    }
+    if (_format == SeriesFormat::CSV) {
+        std::string line;
+        for (uint32_t row = 0; row < rowsNumb; row++) {
+            line.clear();
+            for (unsigned int i = 0; i < _columns.size(); i++) {
+                char value[32];
+                std::snprintf(value, sizeof(value), "%.17g", _columns[i][row]);
+                line += (i == 0 ? "" : ",") + std::string(value);
+            }
+            _file << line << '\n';
+        }
+    }
+    else {
+        _file.write((const char*)&rowsNumb, sizeof(rowsNumb));
+        std::for_each(_columns.begin(), _columns.end(), [this, rowsNumb](const std::vector<double>& column) \
+            { _file.write((const char*)column.data(), rowsNumb * sizeof(double)); });
+    }
+    std::for_each(_columns.begin(), _columns.end(), [](std::vector<double>& column){ column.clear(); });
+}
+
+void TimeSeries::close() {
+    if (_file.is_open()) {
+        this->flush();
+        _file.close();
+    }
+}
+
+bool TimeSeries::readHeader(std::ifstream& file, std::vector<std::string>& names) {
+    char magic[sizeof(MAGIC)];
+    uint32_t version, columnsNumb;
+    file.read(magic, sizeof(magic));
+    file.read((char*)&version, sizeof(version));
+    file.read((char*)&columnsNumb, sizeof(columnsNumb));
+    if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        return false;
+    }
+    names.clear();
+    for (uint32_t i = 0; i < columnsNumb && file; i++) {
+        uint32_t length;
+        file.read((char*)&length, sizeof(length));
+        std::string name(length, ' ');
+        file.read(&name[0], length);
+        names.push_back(name);
+    }
+    return (bool)file;
+}
+
+bool TimeSeries::readBlock(std::ifstream& file, std::vector<std::vector<double>>& columns) {
+    uint32_t rowsNumb;
+    if (!file.read((char*)&rowsNumb, sizeof(rowsNumb))) {
+        return false;
+    }
+    std::for_each(columns.begin(), columns.end(), [&file, rowsNumb](std::vector<double>& column) {
+        column.resize(rowsNumb);
+        file.read((char*)column.data(), rowsNumb * sizeof(double));
+    });
+    return (bool)file;
+}
@@ -1,53 +1,96 @@
 #pragma once
 
-#include <map>
+#include "SymbolTable.h"
 #include <string>
 #include <stdexcept>
+#include <vector>
+
+using TransactHandle = unsigned int; //place of a transact in the TransactPool
+
+#define TRANSACT_PARAMS_NUMB 8
+#define SKIP_LEVELS 8 //of the parameter ordered user chains, level 0 is the chain itself
+#define TRANSACT_QUEUES_NUMB 4 //queue entries a transact holds inline, more go to an overflow vector
 
 class Transact {
     friend class SimCPP;
+    friend class EventChain;
+    friend class TransactPool;
+    friend class Links;
+    friend class Queues;
+    friend class Storages;
 
     private:
         unsigned long _ID;
+        TransactHandle _handle;
         long double _timeNextEvent;
         unsigned int _currentState;
         unsigned int _nextState;
-        bool _blocked; //it can be locked in the seize and enter blocks
-        std::map<const std::string,long double> _params; //string value/int value at c++ 17 "std::variant"
+        bool _blocked; //waits in the delay chain of a storage
+        unsigned int _demand; //channels it waits for
+        long double _params[TRANSACT_PARAMS_NUMB]; //slot per ParamId, slot 0 is M1
+        unsigned int _paramsSet; //bit per assigned slot
+        Transact* _chainPrev; //intrusive links of the CEC, LINK or delay chain holding the transact
+        Transact* _chainNext;
+        Transact* _skipNext[SKIP_LEVELS - 1]; //upper levels of the skip list of a parameter ordered user chain, [0] is the next one
+                                              //of the same demand in a storage delay chain
+        long double _linkKey; //ordering parameter value, cached while the transact is in the user chain
+        unsigned long _linkSeq; //ties of _linkKey keep the FIFO order, the order of arrival in a storage delay chain
+        struct QueueEntry {
+            unsigned int queue; //QueueId
+            long double time; //of the entry
+        } _queueEntries[TRANSACT_QUEUES_NUMB]; //queues the transact is in, a departed entry is replaced by the last one
+        std::vector<QueueEntry> _moreQueueEntries; //entries beyond the inline ones
+        unsigned int _queuesNumb;
 
-        Transact(unsigned int ID, float timeNextEvent, unsigned int currentState, unsigned int nextState): 
-            _ID(ID), _timeNextEvent(timeNextEvent), _currentState(currentState), _nextState(nextState) 
-            {_blocked = false; _params["M1"] = _timeNextEvent;}
+        Transact(): _ID(0), _handle(0), _timeNextEvent(0), _currentState(0), _nextState(0), _blocked(false), _demand(0), _paramsSet(0), _chainPrev(nullptr), _chainNext(nullptr), \
+            _skipNext {}, _linkKey(0), _linkSeq(0), _queueEntries {}, _queuesNumb(0) {}
+        void init(unsigned long ID, long double timeNextEvent, unsigned int currentState, unsigned int nextState);
+        QueueEntry& getQueueEntry(unsigned int i) { return i < TRANSACT_QUEUES_NUMB ? _queueEntries[i] : _moreQueueEntries[i - TRANSACT_QUEUES_NUMB]; }
     public:
         unsigned long getID() { return _ID; }
+        TransactHandle getHandle() { return _handle; }
         unsigned int getCurrentState() { return _currentState; }
         void setCurrentState(unsigned int state) { _currentState = state; }
         unsigned int getNextState() { return _nextState; }
         void setNextState(unsigned int state) { _nextState = state; }
         long double getTime() { return _timeNextEvent; }
         void setTime(long double time) { _timeNextEvent = time; }
-        void block() { _blocked = true; }
+        void block(unsigned int demand) { _blocked = true; _demand = demand; }
         void unBlock() { _blocked = false; }
         bool isBlocked() { return _blocked; }
-        void setParam(const std::string paramName, long double value) { _params[paramName] = value; }
+        unsigned int getDemand() { return _demand; }
         static std::string getTransactMeaningString() { return "{ID; time next event; current state; next state; is blocked}"; }
 
-        long double getParam(const std::string paramName);
+        void setParam(ParamId paramId, long double value) { _params[paramId.id] = value; _paramsSet |= 1u << paramId.id; }
+        long double getParam(ParamId paramId);
         std::string getAsString();  
 };
 
 //-----
 
-long double Transact::getParam(const std::string paramName) {
-    std::map<const std::string,long double>::iterator paramIter = _params.find(paramName); //at c++ 20 "contains"
-    if (paramIter == _params.end()) {
-        throw std::logic_error("Reference to a non-existent Parameter(" + paramName + ") at state:" + std::to_string(_currentState));
+void Transact::init(unsigned long ID, long double timeNextEvent, unsigned int currentState, unsigned int nextState) {
+    _ID = ID;
+    _timeNextEvent = timeNextEvent;
+    _currentState = currentState;
+    _nextState = nextState;
+    _blocked = false;
+    _demand = 0;
+    _queuesNumb = 0;
+    _moreQueueEntries.clear(); //keeps the capacity for the next transact of the pool slot
+    _chainPrev = _chainNext = nullptr;
+    _params[0] = _timeNextEvent;
+    _paramsSet = 1;
+}
+
+long double Transact::getParam(ParamId paramId) {
+    if ((_paramsSet & (1u << paramId.id)) == 0) {
+        throw std::logic_error("Reference to a non-existent Parameter(#" + std::to_string(paramId.id) + ") at state:" + std::to_string(_currentState));
     }
-    return _params[paramName];
+    return _params[paramId.id];
 }
 
 std::string Transact::getAsString() {
     std::string TrStr {'{' + std::to_string(_ID) + "; " + std::to_string(_timeNextEvent) \
                         + "; " + std::to_string(_currentState) + "; " + std::to_string(_nextState) + "; " + std::to_string(_blocked) + '}'}; 
     return TrStr;
-}
\ No newline at end of file
+}
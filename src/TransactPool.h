@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Transact.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+//slab arena of transacts, terminated transacts are recycled through the free list
+class TransactPool {
+    friend class SimCPP;
+
+    private:
+        static const unsigned int SLAB_SIZE = 1024;
+
+        std::vector<Transact*> _slabs; //contiguous arrays of SLAB_SIZE transacts
+        Transact* _freeList; //linked through _chainNext
+        unsigned long _liveNumb;
+
+        TransactPool(): _freeList(nullptr), _liveNumb(0) {}
+        void addSlab();
+    public:
+        ~TransactPool() { std::for_each(_slabs.begin(), _slabs.end(), [](Transact* slab){ delete[] slab; }); }
+
+        Transact* acquire(unsigned long ID, long double timeNextEvent, unsigned int currentState, unsigned int nextState);
+        void release(Transact* transact);
+        Transact* getTransact(TransactHandle handle);
+        unsigned long getLiveNumb() { return _liveNumb; }
+        unsigned long getCapacity() { return _slabs.size() * SLAB_SIZE; }
+};
+
+//-----
+
+void TransactPool::addSlab() {
+    Transact* slab = new Transact[SLAB_SIZE];
+    TransactHandle firstHandle = _slabs.size() * SLAB_SIZE;
+    _slabs.push_back(slab);
+
+    //lower handles are given out first
+    for (unsigned int i = SLAB_SIZE; i > 0; i--) {
+        slab[i-1]._handle = firstHandle + i - 1;
+        slab[i-1]._chainNext = _freeList;
+        _freeList = &slab[i-1];
+    }
+}
+
+Transact* TransactPool::acquire(unsigned long ID, long double timeNextEvent, unsigned int currentState, unsigned int nextState) {
+    if (_freeList == nullptr) {
+        this->addSlab();
+    }
+    Transact* transact = _freeList;
+    _freeList = transact->_chainNext;
+    transact->init(ID, timeNextEvent, currentState, nextState);
+    _liveNumb++;
+    return transact;
+}
+
+void TransactPool::release(Transact* transact) {
+    transact->_chainPrev = nullptr;
+    transact->_chainNext = _freeList;
+    _freeList = transact;
+    _liveNumb--;
+}
+
+Transact* TransactPool::getTransact(TransactHandle handle) {
+    if (handle >= this->getCapacity()) {
+        throw std::logic_error("Reference to a non-existent transact handle (" + std::to_string(handle) + ')');
+    }
+    return &_slabs[handle / SLAB_SIZE][handle % SLAB_SIZE];
+}
@@ -1,20 +1,98 @@
 #include <fstream>
-#include "SimCPP.h"
-
-#define METKA1 5
-#define METKA2 8
-#define METKA3 14
-#define METKA4 20
-#define METKA5 24
-#define METKA6 27
-#define METKA7 33
-
-int main() {
-    unsigned int R1 = 6;
-    unsigned int RGB1 = 26;
-    unsigned int RGB2 = 24;
-    unsigned int RGB3G1 = 30;
-    unsigned int RGB3B1 = 27;
+#include <cstdlib>
+#include <thread>
+#include "pr5Model.h"
+#include "Replications.h"
+#include "CapacitySearch.h"
+
+//without arguments one logged run, "pr5 N" runs N independent replications and prints the estimates,
+//"pr5 compare N" ranks 3 and 4 workers_1 by paired differences of N antithetic replications each with common random numbers,
+//"pr5 search" looks for the fewest workers keeping both queues at AVE.CONT. <= 2,
+//"pr5 trace" is one run with the binary event trace and chain deltas (tools/traceDecode renders it),
+//"pr5 profile" is one run printing the block counts and the engine phases (of a build with -DSIMCPP_PROFILE),
+//"pr5 series" is one run with the contents sampled every time unit into a columnar file (tools/seriesDecode prints it),
+//"pr5 fork" warms the model up once and runs what-if branches with more workers on threads of their own
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "trace") {
+        EventTrace trace("logs\\trace.bin");
+        SimCPP mySim1("three grhoups of workers");
+        mySim1.setTrace(&trace, 10000);
+        pr5Model(mySim1);
+        trace.close();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "profile") {
+        SimCPP mySim1("three grhoups of workers");
+        pr5Model(mySim1);
+        std::cout << mySim1.getProfileString() << std::endl;
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "series") {
+        TimeSeries series("logs\\series.bin");
+        SimCPP mySim1("three grhoups of workers");
+        mySim1.setSeries(&series, 1);
+        pr5Model(mySim1);
+        series.close();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "fork") {
+        SimCPP warmup("three grhoups of workers");
+        pr5Define(warmup, 3, 3, 3, 0);
+        warmup.start(1);
+        warmup.run();
+
+        //every branch starts from the state at 3600, statistics restart there, two seeds per capacities
+        std::vector<std::vector<unsigned int>> workers;
+        std::vector<std::unique_ptr<SimCPP>> branches;
+        for (unsigned int workers1Numb = 3; workers1Numb <= 4; workers1Numb++) {
+            for (unsigned int workers2Numb = 3; workers2Numb <= 4; workers2Numb++) {
+                for (unsigned int workers3Numb = 3; workers3Numb <= 5; workers3Numb++) {
+                    for (uint64_t seed = 1; seed <= 2; seed++) {
+                        workers.push_back({workers1Numb, workers2Numb, workers3Numb});
+                        branches.push_back(warmup.fork(seed, {{"workers_1", workers1Numb}, {"workers_2", workers2Numb}, {"workers_3", workers3Numb}}));
+                        branches.back()->reset();
+                    }
+                }
+            }
+        }
+        std::vector<std::thread> threads;
+        std::for_each(branches.begin(), branches.end(), [&threads](std::unique_ptr<SimCPP>& branch) \
+            { threads.emplace_back([&branch](){ branch->start(10); branch->run(); }); });
+        std::for_each(threads.begin(), threads.end(), [](std::thread& thread){ thread.join(); });
+
+        std::cout << "WORKERS\tSEED\tW1_QUEUE AVE.CONT.\tW2_QUEUE AVE.CONT." << std::endl;
+        for (unsigned int i = 0; i < branches.size(); i++) {
+            std::cout << workers[i][0] << ' ' << workers[i][1] << ' ' << workers[i][2] << '\t' << i % 2 + 1 << '\t' \
+                << branches[i]->getQueueStats()[0].aveCont << "\t\t" << branches[i]->getQueueStats()[1].aveCont << std::endl;
+        }
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "compare") {
+        unsigned int runsNumb = 2 * ((std::strtoul(argv[2], nullptr, 10) + 1) / 2);
+        Replications threeWorkers("3 workers_1", [](SimCPP& sim){ pr5Model(sim, 3); });
+        Replications fourWorkers("4 workers_1", [](SimCPP& sim){ pr5Model(sim, 4); });
+        threeWorkers.setAntithetic(true);
+        fourWorkers.setAntithetic(true);
+        threeWorkers.run(runsNumb);
+        fourWorkers.run(runsNumb);
+        std::cout << fourWorkers.getDifferenceString(threeWorkers) << std::endl;
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "search") {
+        CapacitySearch search("three grhoups of workers", [](SimCPP& sim, const std::vector<unsigned int>& workers) \
+            { pr5Model(sim, workers[0], workers[1], workers[2]); }, {{1, 10}, {1, 10}, {1, 10}});
+        search.setConstraint(2.);
+        DesignPoint best = search.search();
+        std::cout << CapacitySearch::getDesignPointString(best) << "\nevaluated points: " << search.getEvaluatedNumb() \
+            << " of " << search.getPoints().size() << "; runs: " << search.getRunsNumb() << std::endl;
+        return 0;
+    }
+    if (argc > 1) {
+        Replications replications("three grhoups of workers", [](SimCPP& sim){ pr5Model(sim); });
+        replications.run(std::strtoul(argv[1], nullptr, 10));
+        std::cout << replications.getSummaryString() << std::endl;
+        return 0;
+    }
 
     std::ofstream trLog;
     std::ofstream CFECLog;
@@ -27,77 +105,10 @@ int main() {
     statEvLog.open("logs\\statEvLog.txt",std::ios::trunc);
 
     SimCPP mySim1("three grhoups of workers");
-    mySim1.storage("workers_1",3);
-    mySim1.storage("workers_2",3);
-    mySim1.storage("workers_3",3);
-
-    mySim1.start(1,&sysEvLog,&statEvLog,&trLog,&CFECLog);
-    //mySim1.start(1,&sysEvLog,&statEvLog,nullptr,nullptr);
-
-    mySim1.initGenerate(1,6);
-    mySim1.initGenerate(40,3600);
-
-    while(mySim1.isRunning()) {
-        switch(mySim1.sysEvent()) {
-            case 1: mySim1.generate(mySim1.exponential(R1)); break;
-
-            case 2: mySim1.queue("W1_QUEUE"); break;
-            case 3: mySim1.test(mySim1.getLinkParam("q_workers_1","CH") != 0, METKA1); break;
-            case 4: mySim1.link("q_workers_1", "M1"); break;
-
-            case 5: mySim1.test(mySim1.getStorageParam("workers_1","R") == 0, METKA2); break; //METKA1
-            case 6: mySim1.test( ((mySim1.getStorageParam("workers_3","R") != 0) && \
-                (mySim1.getLinkParam("q_workers_1","CH")) >= mySim1.getLinkParam("q_workers_2","CH")) != true, METKA3); break;
-            case 7: mySim1.link("q_workers_1", "M1"); break;
-
-            case 8: mySim1.enter("workers_1"); break; //METKA2
-            case 9: mySim1.depart("W1_QUEUE"); break;
-            case 10:mySim1.advance(mySim1.exponential(RGB1)); break;
-            case 11:mySim1.leave("workers_1"); break;
-            case 12:mySim1.unlink("q_workers_1", METKA1, 1); break;
-            case 13:mySim1.transfer(METKA4); break;
-
-            case 14:mySim1.enter("workers_3"); break; //METKA3
-            case 15:mySim1.depart("W1_QUEUE"); break;
-            case 16:mySim1.advance(mySim1.exponential(RGB3G1)); break;
-            case 17:mySim1.leave("workers_3"); break;
-            case 18:mySim1.unlink("q_workers_1", METKA1, 1); break;
-            case 19:mySim1.unlink("q_workers_2", METKA5, 1); break;
-
-            case 20:mySim1.queue("W2_QUEUE"); break; //METKA4
-            case 21:mySim1.assign("time", mySim1.getModelTime()); break;
-            case 22:mySim1.test(mySim1.getLinkParam("q_workers_2","CH") != 0, METKA5); break;
-            case 23:mySim1.link("q_workers_2", "time"); break;
-
-            case 24: mySim1.test(mySim1.getStorageParam("workers_2","R") == 0, METKA6); break; //METKA5
-            case 25: mySim1.test( ((mySim1.getStorageParam("workers_3","R") != 0) && \
-                (mySim1.getLinkParam("q_workers_2","CH")) >= mySim1.getLinkParam("q_workers_1","CH")) != true, METKA7); break;
-            case 26: mySim1.link("q_workers_2", "time"); break;
-
-            case 27: mySim1.enter("workers_2"); break; //METKA6
-            case 28: mySim1.depart("W2_QUEUE"); break;
-            case 29:mySim1.advance(mySim1.exponential(RGB2)); break;
-            case 30:mySim1.leave("workers_2"); break;
-            case 31:mySim1.unlink("q_workers_2", METKA5, 1); break;
-            case 32:mySim1.terminate(); break;
-
-            case 33:mySim1.enter("workers_3"); break; //METKA7
-            case 34:mySim1.depart("W2_QUEUE"); break;
-            case 35:mySim1.advance(mySim1.exponential(RGB3B1)); break;
-            case 36:mySim1.leave("workers_3"); break;
-            case 37:mySim1.unlink("q_workers_1", METKA1, 1); break;
-            case 38:mySim1.unlink("q_workers_2", METKA5, 1); break;
-            case 39:mySim1.terminate(); break;
-
-            case 40:mySim1.terminate(10000); break;
-            case 41:mySim1.terminate(1); break;
-
-            default: break;
-        }
-    }
+    pr5Model(mySim1, 3, 3, 3, &sysEvLog, &statEvLog, &trLog, &CFECLog);
 
     trLog.close();
     CFECLog.close();
     sysEvLog.close();
     statEvLog.close();
-}
\ No newline at end of file
+}
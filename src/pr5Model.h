@@ -0,0 +1,104 @@
+#pragma once
+
+#include <fstream>
+#include "SimCPP.h"
+
+#define RND 1 //random number streams as at gpss/345.gps
+
+//three groups of workers (gpss/345.gps): the entities and variables are defined on a fresh model, the program is returned;
+//timersNumb transacts end a run each 3600 apart (0 is no limit, START N then runs N * 3600)
+BlockProgram pr5Program(SimCPP& mySim1, unsigned int workers1Numb = 3, unsigned int workers2Numb = 3, unsigned int workers3Numb = 3, \
+              unsigned int timersNumb = 1) {
+    unsigned int R1 = 6;
+    unsigned int RGB1 = 26;
+    unsigned int RGB2 = 24;
+    unsigned int RGB3G1 = 30;
+    unsigned int RGB3B1 = 27;
+
+    mySim1.storage("workers_1",workers1Numb);
+    mySim1.storage("workers_2",workers2Numb);
+    mySim1.storage("workers_3",workers3Numb);
+    mySim1.getLinkId("q_workers_1");
+    mySim1.getLinkId("q_workers_2");
+    BlockProgram program;
+    //waiting times of both stages, p50/p95/p99 in the report
+    program.qtable("W1_TIME", "W1_QUEUE", 0, 10, 30);
+    program.qtable("W2_TIME", "W2_QUEUE", 0, 10, 30);
+
+    //R - free channels of a storage, CH - transacts in a user chain
+    mySim1.variable("br1", "(R$workers_3'NE'0)'AND'(CH$q_workers_1'GE'CH$q_workers_2)", VariableType::BVARIABLE);
+    mySim1.variable("br2", "(R$workers_3'NE'0)'AND'(CH$q_workers_2'GE'CH$q_workers_1)", VariableType::BVARIABLE);
+
+    program.generate([R1](SimCPP& sim){ return sim.exponential(RND,0,R1); }, 6);
+    program.queue("W1_QUEUE");
+    program.test(Expression::parse("CH$q_workers_1'NE'0"), "METKA1");
+    program.link("q_workers_1", "M1");
+
+    program.label("METKA1");
+    program.test(Expression::parse("R$workers_1'E'0"), "METKA2");
+    program.test(Expression::parse("BV$br1'NE'1"), "METKA3");
+    program.link("q_workers_1", "M1");
+
+    program.label("METKA2");
+    program.enter("workers_1");
+    program.depart("W1_QUEUE");
+    program.advance([RGB1](SimCPP& sim){ return sim.exponential(RND+1,0,RGB1); });
+    program.leave("workers_1");
+    program.unlink("q_workers_1", "METKA1", 1);
+    program.transfer("METKA4");
+
+    program.label("METKA3");
+    program.enter("workers_3");
+    program.depart("W1_QUEUE");
+    program.advance([RGB3G1](SimCPP& sim){ return sim.exponential(RND+3,0,RGB3G1); });
+    program.leave("workers_3");
+    program.unlink("q_workers_1", "METKA1", 1);
+    program.unlink("q_workers_2", "METKA5", 1);
+
+    program.label("METKA4");
+    program.queue("W2_QUEUE");
+    program.assign("time", Expression::parse("AC1"));
+    program.test(Expression::parse("CH$q_workers_2'NE'0"), "METKA5");
+    program.link("q_workers_2", "time");
+
+    program.label("METKA5");
+    program.test(Expression::parse("R$workers_2'E'0"), "METKA6");
+    program.test(Expression::parse("BV$br2'NE'1"), "METKA7");
+    program.link("q_workers_2", "time");
+
+    program.label("METKA6");
+    program.enter("workers_2");
+    program.depart("W2_QUEUE");
+    program.advance([RGB2](SimCPP& sim){ return sim.exponential(RND+2,0,RGB2); });
+    program.leave("workers_2");
+    program.unlink("q_workers_2", "METKA5", 1);
+    program.terminate();
+
+    program.label("METKA7");
+    program.enter("workers_3");
+    program.depart("W2_QUEUE");
+    program.advance([RGB3B1](SimCPP& sim){ return sim.exponential(RND+4,0,RGB3B1); });
+    program.leave("workers_3");
+    program.unlink("q_workers_1", "METKA1", 1);
+    program.unlink("q_workers_2", "METKA5", 1);
+    program.terminate();
+
+    //timer, the run ends at 3600
+    program.generate(3600, 3600, timersNumb);
+    program.terminate(1);
+    return program;
+}
+
+//the model with the pr5 program loaded
+void pr5Define(SimCPP& mySim1, unsigned int workers1Numb = 3, unsigned int workers2Numb = 3, unsigned int workers3Numb = 3, \
+              unsigned int timersNumb = 1) {
+    mySim1.load(pr5Program(mySim1, workers1Numb, workers2Numb, workers3Numb, timersNumb));
+}
+
+//three groups of workers, runs one replication to completion on a fresh model
+void pr5Model(SimCPP& mySim1, unsigned int workers1Numb = 3, unsigned int workers2Numb = 3, unsigned int workers3Numb = 3, \
+             std::ofstream* sysEvLog = nullptr, std::ofstream* statEvLog = nullptr, std::ofstream* trLog = nullptr, std::ofstream* CFECLog = nullptr) {
+    pr5Define(mySim1, workers1Numb, workers2Numb, workers3Numb);
+    mySim1.start(1,sysEvLog,statEvLog,trLog,CFECLog);
+    mySim1.run();
+}
@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "../src/GpssLoader.h"
+#include "../src/Replications.h"
+
+//runs a plain-text GPSS model (src/GpssLoader.h) with the block interpreter, no C++ model code is compiled
+//usage: gpssRun model.txt [replications|profile|checkpoint state.bin]
+//one run prints the final statistics, N replications print the estimates over them,
+//profile adds the block counts and the run time by engine phase (a build with -DSIMCPP_PROFILE) to one run,
+//checkpoint goes on from state.bin if it exists and saves the model there after the START count, so every call
+//continues the run by one START and a crashed call loses only its own part
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: gpssRun model.txt [replications|profile|checkpoint state.bin]" << std::endl;
+        return 1;
+    }
+    try {
+        GpssLoader loader;
+        loader.loadFile(argv[1]);
+        if (loader.getStartCount() == 0) {
+            std::cerr << "\"" << argv[1] << "\" has no START statement" << std::endl;
+            return 1;
+        }
+
+        bool profile = argc > 2 && std::string(argv[2]) == "profile";
+        bool checkpoint = argc > 3 && std::string(argv[2]) == "checkpoint";
+        if (argc > 2 && !profile && !checkpoint) {
+            Replications replications(argv[1], [&loader](SimCPP& sim) \
+                { sim.load(loader.getProgram()); sim.start(loader.getStartCount()); sim.run(); });
+            replications.run(std::strtoul(argv[2], nullptr, 10));
+            std::cout << replications.getSummaryString() << std::endl;
+            return 0;
+        }
+
+        SimCPP sim(argv[1]);
+        sim.load(loader.getProgram());
+        if (checkpoint && std::ifstream(argv[3])) {
+            sim.restore(argv[3]);
+        }
+        sim.start(loader.getStartCount());
+        sim.run();
+        if (checkpoint) {
+            sim.save(argv[3]);
+        }
+        std::cout << "model time: " << sim.getModelTime() << '\n' << Queues::getFinalStatString(sim.getQueueStats()) << '\n' \
+            << Storages::getFinalStatString(sim.getStorageStats()) << '\n' << Links::getFinalStatString(sim.getLinkStats());
+        if (!sim.getTableStats().empty()) {
+            std::cout << '\n' << Tables::getFinalStatString(sim.getTableStats());
+        }
+        if (profile) {
+            std::cout << "\n\n" << sim.getProfileString();
+        }
+        std::cout << std::endl;
+    }
+    catch (const std::logic_error& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/TimeSeries.h"
+
+//prints a binary time series of SimCPP::setSeries as CSV, block by block, so any length of the series fits
+//usage: seriesDecode series.bin [column ...]
+//the columns are printed in the given order, all of them by default
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: seriesDecode series.bin [column ...]" << std::endl;
+        return 1;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    std::vector<std::string> names;
+    if (!TimeSeries::readHeader(file, names)) {
+        std::cerr << "\"" << argv[1] << "\" is not a SimCPP time series of this version" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned int> selected;
+    for (int i = 2; i < argc; i++) {
+        unsigned int column = 0;
+        while (column < names.size() && names[column] != argv[i]) {
+            column++;
+        }
+        if (column == names.size()) {
+            std::cerr << "no column \"" << argv[i] << "\" in the series" << std::endl;
+            return 1;
+        }
+        selected.push_back(column);
+    }
+    if (selected.empty()) {
+        for (unsigned int column = 0; column < names.size(); column++) {
+            selected.push_back(column);
+        }
+    }
+
+    for (unsigned int i = 0; i < selected.size(); i++) {
+        std::cout << (i == 0 ? "" : ",") << names[selected[i]];
+    }
+    std::cout << '\n';
+    std::vector<std::vector<double>> columns(names.size());
+    char value[32];
+    while (TimeSeries::readBlock(file, columns)) {
+        for (unsigned int row = 0; row < columns[0].size(); row++) {
+            for (unsigned int i = 0; i < selected.size(); i++) {
+                std::snprintf(value, sizeof(value), "%.17g", columns[selected[i]][row]);
+                std::cout << (i == 0 ? "" : ",") << value;
+            }
+            std::cout << '\n';
+        }
+    }
+    if (!file.eof()) {
+        std::cerr << "the series ends inside a block" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,447 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "../src/EventTrace.h"
+
+//renders a binary event trace of SimCPP::setTrace as text
+//usage: traceDecode trace.bin [transact|raw|chains [model time]|cfec]
+//transact - lines of the transactLog format, raw - one line per record,
+//chains - FEC, CEC, user chains and storage delay chains at the end of the model time (of the trace by default), needs a trace with chain deltas,
+//cfec - the CFECLog of the run without the wall clock times, needs a trace with chain deltas; the transact tuples are replayed
+//from the records, so transacts made before SimCPP::setTrace show 0 states until their first record, and an UNLINK
+//releasing no transacts shows no target state (the trace does not keep it)
+
+class TraceDecoder {
+    private:
+        std::map<std::pair<uint8_t,uint16_t>, std::string> _names; //(TraceEntity, handle) -> name
+        std::string _modelName;
+
+        std::string getPrefix(const TraceRecord& record);
+    public:
+        const std::string& getName(TraceEntity kind, uint16_t entity);
+        void readName(std::ifstream& file, const TraceRecord& record);
+        std::string getTransactString(const TraceRecord& record); //empty for records without a transactLog line
+        std::string getRawString(const TraceRecord& record);
+        const std::string& getModelName() { return _modelName; }
+        bool hasName(TraceEntity kind, uint16_t entity) { return _names.find({(uint8_t)kind, entity}) != _names.end(); }
+};
+
+//chains replayed from CHAIN_INSERT and CHAIN_REMOVE records, a snapshot replaces the whole state
+class ChainReplay {
+    private:
+        struct Chain {
+            std::list<uint64_t> transacts;
+            std::unordered_map<uint64_t, std::list<uint64_t>::iterator> places; //transact ID -> place in the chain
+        };
+        //fields of the transact tuple of the CFECLog, the blocked flag is always 0
+        struct TransactState {
+            double time;
+            unsigned int currentState;
+            unsigned int nextState;
+        };
+
+        std::map<std::pair<double,uint64_t>, uint64_t> _FEC; //(event time, insertion number) -> transact ID
+        std::unordered_map<uint64_t, std::pair<double,uint64_t>> _FECPlaces;
+        uint64_t _FECSeqNumb;
+        Chain _CEC;
+        std::map<uint16_t, Chain> _links; //by link handle
+        std::map<uint16_t, Chain> _delays; //by storage handle
+        std::unordered_map<uint64_t, TransactState> _transacts; //by transact ID
+        bool _snapshotSeen;
+        double _modelTime;
+
+        Chain& getChain(const TraceRecord& record) { return (TraceEntity)record.kind == TraceEntity::CEC ? _CEC \
+            : ((TraceEntity)record.kind == TraceEntity::DELAY ? _delays[record.entity] : _links[record.entity]); }
+        static std::string getChainString(const Chain& chain);
+        void applyState(const TraceRecord& record);
+        std::string getTupleString(uint64_t ID);
+        std::string getTuplesString(const Chain& chain);
+    public:
+        ChainReplay(): _FECSeqNumb(0), _snapshotSeen(false), _modelTime(0) {}
+
+        void apply(const TraceRecord& record); //throws on records not matching the replayed state
+        bool isSnapshotSeen() { return _snapshotSeen; }
+        std::string getString(TraceDecoder& decoder);
+        std::string getCFECString(TraceDecoder& decoder); //FEC, CEC and user chains as the CFECLog lines
+};
+
+//CFECLog dumps of the replayed chains, a dump is made after the chain records of its event
+class CFECRender {
+    private:
+        ChainReplay& _replay;
+        TraceDecoder& _decoder;
+        TraceRecord _pending; //event of the next dump
+        bool _isPending;
+        std::string _unlinkedIDs; //released transacts of a pending UNLINK
+        unsigned int _unlinkState;
+
+        std::string getDump();
+    public:
+        CFECRender(ChainReplay& replay, TraceDecoder& decoder): _replay(replay), _decoder(decoder), _pending(), _isPending(false), _unlinkState(0) {}
+
+        std::string apply(const TraceRecord& record); //dumps and frames completed by the record
+        std::string close() { return _isPending ? this->getDump() : ""; }
+};
+
+//-----
+
+const std::string& TraceDecoder::getName(TraceEntity kind, uint16_t entity) {
+    std::pair<uint8_t,uint16_t> key {(uint8_t)kind, entity};
+    if (_names.find(key) == _names.end()) {
+        _names[key] = '#' + std::to_string(entity);
+    }
+    return _names[key];
+}
+
+void TraceDecoder::readName(std::ifstream& file, const TraceRecord& record) {
+    TraceRecord chars;
+    std::string name;
+    for (size_t pos = 0; pos < (size_t)record.value; pos += sizeof(TraceRecord)) {
+        file.read((char*)&chars, sizeof(chars));
+        name.append((const char*)&chars, std::min(sizeof(TraceRecord), (size_t)record.value - pos));
+    }
+    if ((TraceEntity)record.kind == TraceEntity::MODEL) {
+        _modelName = name;
+    }
+    _names[{record.kind, record.entity}] = name;
+}
+
+std::string TraceDecoder::getPrefix(const TraceRecord& record) {
+    return "Xact:" + std::to_string(record.transactID) + " at state: " + std::to_string(record.block) + "; model time: " \
+        + std::to_string(record.modelTime) + ": ";
+}
+
+std::string TraceDecoder::getTransactString(const TraceRecord& record) {
+    switch ((TraceEvent)record.type) {
+        case TraceEvent::START:
+            return "\"" + _modelName + "\" started with counter " + std::to_string((unsigned long)record.value) + " at model time: " + std::to_string(record.modelTime);
+        case TraceEvent::RESET:
+            return "Statistics are reset at model time: " + std::to_string(record.modelTime);
+        case TraceEvent::END:
+            return "Simulation is ended! model time: " + std::to_string(record.modelTime);
+        case TraceEvent::INIT_GENERATE:
+            return "Xact:" + std::to_string(record.transactID) + " generating an initializing transact with birth time " \
+                + std::to_string(record.value) + " at birth state " + std::to_string(record.block);
+        case TraceEvent::GENERATE:
+            return "Xact:" + std::to_string(record.transactID) + " generated at state: " + std::to_string(record.block) + "; model time: " \
+                + std::to_string(record.modelTime) + " with birth time " + std::to_string(record.value);
+        case TraceEvent::TERMINATE:
+            return this->getPrefix(record) + "terminated";
+        case TraceEvent::ADVANCE:
+            return this->getPrefix(record) + "advanced";
+        case TraceEvent::TEST:
+            return this->getPrefix(record) + "tested and will transfered to state:" + std::to_string((unsigned int)record.value);
+        case TraceEvent::TRANSFER:
+            return this->getPrefix(record) + "transfered to pos:" + std::to_string((unsigned int)record.value);
+        case TraceEvent::ASSIGN:
+            return this->getPrefix(record) + "assign parameter: \"" + this->getName(TraceEntity::PARAM, record.entity) + "\" with value:" \
+                + std::to_string(record.value);
+        case TraceEvent::ENTER:
+            return this->getPrefix(record) + "seized " + std::to_string((unsigned int)record.value) + " channel(s) at \"" \
+                + this->getName(TraceEntity::STORAGE, record.entity) + "\" storage";
+        case TraceEvent::LEAVE:
+            return this->getPrefix(record) + "released " + std::to_string((unsigned int)record.value) + " channel(s) at \"" \
+                + this->getName(TraceEntity::STORAGE, record.entity) + "\" storage";
+        case TraceEvent::QUEUE:
+            return this->getPrefix(record) + "queued at \"" + this->getName(TraceEntity::QUEUE, record.entity) + "\" queue";
+        case TraceEvent::DEPART:
+            return this->getPrefix(record) + "departed from \"" + this->getName(TraceEntity::QUEUE, record.entity) + "\" queue";
+        case TraceEvent::LINK:
+            return this->getPrefix(record) + "linking to \"" + this->getName(TraceEntity::LINK, record.entity) + "\" with \"" \
+                + (record.value == 0 ? "FIFO" : (record.value == 1 ? "LIFO" : this->getName(TraceEntity::PARAM, (uint16_t)record.value - 2))) + "\" discipline";
+        case TraceEvent::UNLINK:
+            return this->getPrefix(record) + "unlinking " + std::to_string((unsigned int)record.value) + " Xact(s) from \"" \
+                + this->getName(TraceEntity::LINK, record.entity) + '\"';
+        case TraceEvent::UNLINKED:
+            return "Xact:" + std::to_string(record.transactID) + " unlinked from \"" + this->getName(TraceEntity::LINK, record.entity) \
+                + "\" to state:" + std::to_string((unsigned int)record.value) + "; model time: " + std::to_string(record.modelTime);
+        default:
+            return "";
+    }
+}
+
+std::string TraceDecoder::getRawString(const TraceRecord& record) {
+    return std::to_string(record.modelTime) + '\t' + EventTrace::getEventName((TraceEvent)record.type) + '\t' + std::to_string(record.transactID) \
+        + '\t' + std::to_string(record.block) + '\t' + std::to_string(record.entity) + '\t' + std::to_string(record.value);
+}
+
+void ChainReplay::apply(const TraceRecord& record) {
+    _modelTime = record.modelTime;
+    this->applyState(record);
+    if ((TraceEvent)record.type == TraceEvent::SNAPSHOT) {
+        _FEC.clear();
+        _FECPlaces.clear();
+        _CEC = Chain();
+        _links.clear();
+        _delays.clear();
+        _snapshotSeen = true;
+        return;
+    }
+    if ((TraceEvent)record.type != TraceEvent::CHAIN_INSERT && (TraceEvent)record.type != TraceEvent::CHAIN_REMOVE) {
+        return;
+    }
+    if (!_snapshotSeen) {
+        return; //deltas are meaningless without the state they start from
+    }
+
+    if ((TraceEntity)record.kind == TraceEntity::FEC) {
+        if ((TraceEvent)record.type == TraceEvent::CHAIN_INSERT) {
+            std::pair<double,uint64_t> key {record.value, _FECSeqNumb++};
+            _FEC[key] = record.transactID;
+            _FECPlaces[record.transactID] = key;
+        }
+        else {
+            if (_FECPlaces.find(record.transactID) == _FECPlaces.end()) {
+                throw std::logic_error("Xact:" + std::to_string(record.transactID) + " is removed from FEC, but it is not there");
+            }
+            _FEC.erase(_FECPlaces[record.transactID]);
+            _FECPlaces.erase(record.transactID);
+        }
+        return;
+    }
+
+    Chain& chain = this->getChain(record);
+    if ((TraceEvent)record.type == TraceEvent::CHAIN_INSERT) {
+        std::list<uint64_t>::iterator place = chain.transacts.begin();
+        if (record.value != 0) {
+            if (chain.places.find((uint64_t)record.value) == chain.places.end()) {
+                throw std::logic_error("Xact:" + std::to_string(record.transactID) + " is inserted after Xact:" \
+                    + std::to_string((uint64_t)record.value) + ", which is not in the chain");
+            }
+            place = std::next(chain.places[(uint64_t)record.value]);
+        }
+        chain.places[record.transactID] = chain.transacts.insert(place, record.transactID);
+    }
+    else {
+        if (chain.places.find(record.transactID) == chain.places.end()) {
+            throw std::logic_error("Xact:" + std::to_string(record.transactID) + " is removed from a chain, but it is not there");
+        }
+        chain.transacts.erase(chain.places[record.transactID]);
+        chain.places.erase(record.transactID);
+    }
+}
+
+void ChainReplay::applyState(const TraceRecord& record) {
+    TraceEvent type = (TraceEvent)record.type;
+    if (type == TraceEvent::CHAIN_INSERT && (TraceEntity)record.kind == TraceEntity::FEC) {
+        _transacts[record.transactID].time = record.value;
+        return;
+    }
+    if (record.transactID == 0 || type == TraceEvent::CHAIN_INSERT || type == TraceEvent::CHAIN_REMOVE || type == TraceEvent::END) {
+        return;
+    }
+    if (type == TraceEvent::INIT_GENERATE || type == TraceEvent::GENERATE) {
+        _transacts[record.transactID] = TransactState {record.value, 0, record.block};
+        //the generating transact is the current one, at the head of CEC
+        if (type == TraceEvent::GENERATE && !_CEC.transacts.empty()) {
+            TransactState& generator = _transacts[_CEC.transacts.front()];
+            generator = TransactState {record.modelTime, record.block, record.block + 1};
+        }
+        return;
+    }
+    if (type == TraceEvent::TERMINATE) {
+        _transacts.erase(record.transactID);
+        return;
+    }
+
+    TransactState& state = _transacts[record.transactID];
+    state.time = record.modelTime;
+    if (type == TraceEvent::PROMOTION) {
+        state.nextState = record.block;
+        return;
+    }
+    state.currentState = record.block;
+    switch (type) {
+        case TraceEvent::TEST: case TraceEvent::TRANSFER: case TraceEvent::UNLINKED:
+            state.nextState = (unsigned int)record.value;
+            break;
+        case TraceEvent::LINK:
+            state.nextState = record.block;
+            break;
+        case TraceEvent::ENTER:
+            state.nextState = record.value == 0 ? record.block : record.block + 1; //a blocked transact enters the block again
+            break;
+        default:
+            state.nextState = record.block + 1;
+    }
+}
+
+std::string ChainReplay::getChainString(const Chain& chain) {
+    std::string message;
+    std::for_each(chain.transacts.begin(), chain.transacts.end(), [&message](uint64_t ID){ message += std::to_string(ID) + ' '; });
+    return message;
+}
+
+std::string ChainReplay::getString(TraceDecoder& decoder) {
+    std::string message = "model time: " + std::to_string(_modelTime) + "\nFEC:   ";
+    std::for_each(_FEC.begin(), _FEC.end(), [&message](const std::pair<const std::pair<double,uint64_t>, uint64_t>& entry) \
+        { message += std::to_string(entry.second) + '(' + std::to_string(entry.first.first) + ") "; });
+    message += "\nCEC:   " + getChainString(_CEC) + "\nLINKS: ";
+    std::for_each(_links.begin(), _links.end(), [&message, &decoder](const std::pair<const uint16_t, Chain>& link) \
+        { message += decoder.getName(TraceEntity::LINK, link.first) + ":   " + getChainString(link.second); });
+    message += "\nDELAY: ";
+    std::for_each(_delays.begin(), _delays.end(), [&message, &decoder](const std::pair<const uint16_t, Chain>& delay) \
+        { message += decoder.getName(TraceEntity::STORAGE, delay.first) + ":   " + getChainString(delay.second); });
+    return message;
+}
+
+std::string ChainReplay::getTupleString(uint64_t ID) {
+    const TransactState& state = _transacts[ID];
+    return '{' + std::to_string(ID) + "; " + std::to_string(state.time) + "; " + std::to_string(state.currentState) + "; " \
+        + std::to_string(state.nextState) + "; 0}";
+}
+
+std::string ChainReplay::getTuplesString(const Chain& chain) {
+    std::string message;
+    std::for_each(chain.transacts.begin(), chain.transacts.end(), [this, &message](uint64_t ID){ message += this->getTupleString(ID) + ' '; });
+    return message;
+}
+
+std::string ChainReplay::getCFECString(TraceDecoder& decoder) {
+    std::string message = "FEC:   ";
+    std::for_each(_FEC.begin(), _FEC.end(), [this, &message](const std::pair<const std::pair<double,uint64_t>, uint64_t>& entry) \
+        { message += this->getTupleString(entry.second) + ' '; });
+    message += "\nCEC:   " + this->getTuplesString(_CEC) + "\nLINKS: ";
+    //every link of the model is listed, the empty ones too
+    for (uint16_t linkId = 0; decoder.hasName(TraceEntity::LINK, linkId) || _links.find(linkId) != _links.end(); linkId++) {
+        message += decoder.getName(TraceEntity::LINK, linkId) + ":   " + this->getTuplesString(_links[linkId]);
+    }
+    return message;
+}
+
+std::string CFECRender::getDump() {
+    std::string message = "Xact:" + std::to_string(_pending.transactID);
+    switch ((TraceEvent)_pending.type) {
+        case TraceEvent::INIT_GENERATE: message = "\"init generation\" " + message; break;
+        case TraceEvent::GENERATE: message = "\"generation\" " + message; break;
+        case TraceEvent::PROMOTION: message = "\"promotion of model time\" " + message; break;
+        case TraceEvent::TERMINATE: message = "\"terminating\" " + message; break;
+        case TraceEvent::ADVANCE: message = "\"advance\" " + message; break;
+        case TraceEvent::TEST: message = "\"test\" " + message; break;
+        case TraceEvent::TRANSFER: message = "\"transfer\" " + message; break;
+        case TraceEvent::ASSIGN: message = "\"assign parameter\" " + message; break;
+        case TraceEvent::ENTER: message = "\"seizing\" " + message; break;
+        case TraceEvent::LEAVE: message = "\"releazing\" " + message; break;
+        case TraceEvent::LINK:
+            message = "\"linking\" " + message + " to \"" + _decoder.getName(TraceEntity::LINK, _pending.entity) + '\"';
+            break;
+        case TraceEvent::UNLINK:
+            message = "\"unlinking\" Xact:" + _unlinkedIDs + " from \"" + _decoder.getName(TraceEntity::LINK, _pending.entity) + "\" to state:" \
+                + (_unlinkedIDs.empty() ? "?" : std::to_string(_unlinkState));
+            break;
+        default: break;
+    }
+    _isPending = false;
+    return message + " model time: " + std::to_string(_pending.modelTime) + '\n' + _replay.getCFECString(_decoder) + "\n\n";
+}
+
+std::string CFECRender::apply(const TraceRecord& record) {
+    TraceEvent type = (TraceEvent)record.type;
+    std::string message;
+
+    bool isChainRecord = type == TraceEvent::CHAIN_INSERT || type == TraceEvent::CHAIN_REMOVE || type == TraceEvent::SNAPSHOT \
+        || type == TraceEvent::SNAPSHOT_END;
+    if (_isPending && !isChainRecord) {
+        TraceEvent pendingType = (TraceEvent)_pending.type;
+        if (pendingType == TraceEvent::UNLINK && type == TraceEvent::UNLINKED) {
+            _unlinkedIDs += std::to_string(record.transactID) + ';';
+            _unlinkState = (unsigned int)record.value;
+        }
+        else if (pendingType == TraceEvent::TERMINATE && type == TraceEvent::END) {
+            _isPending = false; //the last terminate of the run ends it without a dump
+        }
+        else if (pendingType != TraceEvent::LEAVE || type != TraceEvent::ENTER) {
+            //ENTER records after LEAVE are the delayed transacts seizing the released channels, a part of the "releazing" dump
+            message = this->getDump();
+        }
+    }
+    _replay.apply(record);
+
+    switch (type) {
+        case TraceEvent::START:
+            message += "==--+\n\n\"" + _decoder.getModelName() + "\" Sim model CEC and FEC logging enabled\n" \
+                "Transact tuple {ID; time next event; current state; next state; is blocked}\n==--+\n";
+            break;
+        case TraceEvent::END:
+            message += std::string("==--+\n\nSim model CEC and FEC logging disabled\n") + (record.transactID == 0 ? \
+                "Simulation is ended, the precision of the batch means is reached!" : "Simulation is ended!") + "\n==--+\n";
+            break;
+        case TraceEvent::INIT_GENERATE: case TraceEvent::GENERATE: case TraceEvent::PROMOTION: case TraceEvent::TERMINATE: case TraceEvent::ADVANCE:
+        case TraceEvent::TEST: case TraceEvent::TRANSFER: case TraceEvent::ASSIGN: case TraceEvent::ENTER: case TraceEvent::LEAVE:
+        case TraceEvent::LINK: case TraceEvent::UNLINK:
+            if (!_isPending) {
+                _pending = record;
+                _isPending = true;
+                _unlinkedIDs.clear();
+            }
+            break;
+        default: break;
+    }
+    return message;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: traceDecode trace.bin [transact|raw|chains [model time]|cfec]" << std::endl;
+        return 1;
+    }
+    std::string mode = argc > 2 ? argv[2] : "transact";
+    double untilTime = argc > 3 ? std::strtod(argv[3], nullptr) : std::numeric_limits<double>::infinity();
+    std::ifstream file(argv[1], std::ios::binary);
+    TraceDecoder decoder;
+    ChainReplay replay;
+    CFECRender render(replay, decoder);
+    TraceRecord record;
+
+    if (!EventTrace::readHeader(file)) {
+        std::cerr << "\"" << argv[1] << "\" is not a SimCPP trace of this version" << std::endl;
+        return 1;
+    }
+    while (file.read((char*)&record, sizeof(record))) {
+        if ((TraceEvent)record.type == TraceEvent::NAME) {
+            decoder.readName(file, record);
+            continue;
+        }
+        if (mode == "cfec") {
+            try {
+                std::cout << render.apply(record);
+            }
+            catch (const std::logic_error& error) {
+                std::cerr << "inconsistent chain records: " << error.what() << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        if (mode == "chains") {
+            if (record.modelTime > untilTime) {
+                break;
+            }
+            try {
+                replay.apply(record);
+            }
+            catch (const std::logic_error& error) {
+                std::cerr << "inconsistent chain records: " << error.what() << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        std::string line = mode == "raw" ? decoder.getRawString(record) : decoder.getTransactString(record);
+        if (!line.empty()) {
+            std::cout << line << '\n';
+        }
+    }
+    if (mode == "cfec" || mode == "chains") {
+        if (!replay.isSnapshotSeen()) {
+            std::cerr << "\"" << argv[1] << "\" has no chain records, see SimCPP::setTrace" << std::endl;
+            return 1;
+        }
+        std::cout << (mode == "cfec" ? render.close() : replay.getString(decoder) + '\n') << std::flush;
+    }
+}